@@ -52,13 +52,11 @@
  */
 
 #include "analyzer/abstracttask.h"
+#include "analyzer/prescan.h"
 #include "analyzer/traceanalyzer.h"
 #include "ui/taskgraph.h"
 #include "vtl/tlist.h"
 
-#define SCHED_HEIGHT ((double) 0.5)
-#define FLOOR_HEIGHT ((double) 0)
-
 #define ABSTRACT_TASK_TIME_ZERO vtl::Time(0, 6)
 
 AbstractTask::AbstractTask() :
@@ -72,15 +70,49 @@ AbstractTask::~AbstractTask()
 		delete graph;
 }
 
+/*
+ * Make room for what the counted switches and wakeups will add, so that the
+ * vectors do not need to be reallocated while the rest of the trace is being
+ * processed. nrExtra is the number of scheduling points that are added besides
+ * those of the switches, such as the first point and the tail. There can be a
+ * scheduling latency for every switch in, and a wakeup latency for nrWake of
+ * them.
+ */
+void AbstractTask::reserve(const PrescanCount &count, int nrExtra, int nrWake)
+{
+	int nrSched = count.nrIn + count.nrOut + nrExtra;
+
+	prescanReserve(schedTimev, nrSched);
+	prescanReserve(schedEventIdx, nrSched);
+	schedData.reserve(schedData.size() + nrSched);
+	prescanReserve(delayTimev, count.nrIn);
+	prescanReserve(delay, count.nrIn);
+	prescanReserve(wakeTimev, nrWake);
+	prescanReserve(wakeDelay, nrWake);
+	prescanReserve(preemptedTimev, count.nrPreempted);
+	prescanReserve(runningTimev, count.nrRunning);
+	prescanReserve(uninterruptibleTimev, count.nrUnint);
+}
+
+/*
+ * The pyramid is built from the unscaled schedData, so it only needs to be
+ * rebuilt if more scheduling points have been added.
+ */
+bool AbstractTask::doLod()
+{
+	if (!schedLod.isValid())
+		schedLod.build(schedData);
+	return false; /* No error */
+}
+
 bool AbstractTask::doScale()
 {
 	int i;
 	int s = schedData.size();
-	double schedScale = scale * SCHED_HEIGHT;
 	scaledSchedData.resize(s);
 	for (i = 0; i < s; i++)
-		scaledSchedData[i] = schedData.read(i) * schedScale + offset;
-	return false; /* No error */
+		scaledSchedData[i] = schedValue(i);
+	return doLod();
 }
 
 bool AbstractTask::doStats()
@@ -165,6 +197,19 @@ bool AbstractTask::doStats()
 }
 
 bool AbstractTask::doStatsTimeLimited()
+{
+	statsTimeLimited(lowerTimeLimit, higherTimeLimit, cursorTime,
+			 cursorPct);
+	return false;
+}
+
+/*
+ * Computes the time consumed between start and end and its percentage of the
+ * interval, without modifying the task.
+ */
+void AbstractTask::statsTimeLimited(const vtl::Time &start,
+				    const vtl::Time &end,
+				    vtl::Time &time, unsigned &pct) const
 {
 	int startidx, endidx;
 	int i;
@@ -176,16 +221,13 @@ bool AbstractTask::doStatsTimeLimited()
 	vtl::Time t;
 	unsigned int state;
 
-	cursorTime = ABSTRACT_TASK_TIME_ZERO;
-	cursorPct = 0;
+	time = ABSTRACT_TASK_TIME_ZERO;
+	pct = 0;
 
 	if (s < 1) {
-		return false;
+		return;
 	}
 
-
-	const vtl::Time &start = lowerTimeLimit;
-	const vtl::Time &end = higherTimeLimit;
 	delta = end - start;
 
 	vtl::Time firstTime = (*events)[schedEventIdx[0]].time;
@@ -193,28 +235,28 @@ bool AbstractTask::doStatsTimeLimited()
 	if (s < 2) {
 		if (firstTime < start) {
 			if (schedData.read(0) == SCHED_BIT) {
-				cursorTime = delta;
-				cursorPct = 10000;
+				time = delta;
+				pct = 10000;
 			}
-			return false;
+			return;
 		}
 		if (firstTime > end) {
-			return false;
+			return;
 		}
 		if (schedData.read(0) == SCHED_BIT) {
-			cursorTime = end - firstTime;
-			cursorPct = (unsigned)
-				(10000 * (cursorTime.toDouble()
+			time = end - firstTime;
+			pct = (unsigned)
+				(10000 * (time.toDouble()
 					  / delta.toDouble() + 0.00005));
 		}
-		return false;
+		return;
 	}
 
 	vtl::Time lastTime = (*events)[schedEventIdx[s - 1]].time;
 
 
 	if (lastTime < start)
-		return false;
+		return;
 
 	if (firstTime > start) {
 		/* Normal case, do nothing */
@@ -225,7 +267,7 @@ bool AbstractTask::doStatsTimeLimited()
 	}
 
 	if (firstTime > end)
-		return false;
+		return;
 
 	startidx = findLower(start);
 	endidx = findLower(end);
@@ -233,7 +275,7 @@ bool AbstractTask::doStatsTimeLimited()
 	startIdxTime = (*events)[schedEventIdx[startidx]].time;
 
 	if (startIdxTime >= end)
-		return false;
+		return;
 
 	if (startIdxTime < start)
 		prevTime = start;
@@ -245,18 +287,17 @@ bool AbstractTask::doStatsTimeLimited()
 		t = (*events)[schedEventIdx[i]].time;
 		state = schedData.read(i);
 		if (SCHED_BIT == prevState) {
-			cursorTime += t - prevTime;
+			time += t - prevTime;
 		}
 		prevTime = t;
 		prevState = state;
 	}
 
 	if (prevTime < end && prevState == SCHED_BIT) {
-		cursorTime += end - prevTime;
+		time += end - prevTime;
 	}
-	cursorPct = (unsigned) (10000 * (cursorTime.toDouble()
-					 / delta.toDouble() + 0.00005));
-	return false;
+	pct = (unsigned) (10000 * (time.toDouble() / delta.toDouble()
+				   + 0.00005));
 }
 
 bool AbstractTask::doScaleRunning()
@@ -283,10 +324,15 @@ bool AbstractTask::doScaleUnint()
 bool AbstractTask::doScaleDelay()
 {
 	fillDataVector(delay, delayHeight, &delayZero, DELAY_HEIGHT);
-	fillDataVector(wakeDelay, wakeHeight, &wakeZero, DELAY_HEIGHT);
 	return false; /* No error */
 }
 
+/* This is the value of the wakeup latencies */
+double AbstractTask::delayValue() const
+{
+	return DELAY_HEIGHT * scale + offset;
+}
+
 void  AbstractTask::fillDataVector(QVector<double> &timev,
 				   QVector<double> &data,
 				   QVector<double> *zerov,
@@ -315,6 +361,13 @@ void AbstractTask::setCursorTime(enum TShark::CursorIdx cursor,
 	}
 }
 
+/* Returns the interval between the cursors */
+void AbstractTask::getTimeLimits(vtl::Time &low, vtl::Time &high)
+{
+	low = lowerTimeLimit;
+	high = higherTimeLimit;
+}
+
 void AbstractTask::setStartTime(const vtl::Time &time)
 {
 	startTime = time;
@@ -331,7 +384,7 @@ void AbstractTask::setEvents(const vtl::TList<TraceEvent> *ev)
 }
 
 int AbstractTask::binarySearch_(const vtl::Time &time, int lowerIdx,
-				int higherIdx)
+				int higherIdx) const
 {
 	int pivot = (lowerIdx + higherIdx) / 2;
 	int width = higherIdx - lowerIdx;
@@ -348,7 +401,7 @@ int AbstractTask::binarySearch_(const vtl::Time &time, int lowerIdx,
 	return binarySearch_(time, lowerIdx, higherIdx);
 }
 
-int AbstractTask::binarySearch(const vtl::Time &time)
+int AbstractTask::binarySearch(const vtl::Time &time) const
 {
 	int s = schedEventIdx.size();
 
@@ -356,7 +409,7 @@ int AbstractTask::binarySearch(const vtl::Time &time)
 }
 
 
-int AbstractTask::findLower(const vtl::Time &time)
+int AbstractTask::findLower(const vtl::Time &time) const
 {
 	int idxmax = schedEventIdx.size() - 1;
 	int idx = binarySearch_(time, 0, idxmax);
@@ -376,7 +429,7 @@ int AbstractTask::findLower(const vtl::Time &time)
 	return idx;
 }
 
-int AbstractTask::findHigher(const vtl::Time &time)
+int AbstractTask::findHigher(const vtl::Time &time) const
 {
 	int idxmax = schedEventIdx.size() - 1;
 	int idx = binarySearch_(time, 0, idxmax);
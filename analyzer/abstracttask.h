@@ -57,9 +57,12 @@
 
 #include "vtl/bitvector.h"
 #include "vtl/compiler.h"
+#include "vtl/minmaxpyramid.h"
 #include "vtl/time.h"
 #include "misc/traceshark.h"
+#include "misc/types.h"
 
+class PrescanCount;
 class QCPErrorBars;
 class TaskGraph;
 class TraceEvent;
@@ -68,6 +71,9 @@ class TraceAnalyzer;
 #define SCHED_BIT 0x1
 #define FLOOR_BIT 0x0
 
+#define SCHED_HEIGHT ((double) 0.5)
+#define FLOOR_HEIGHT ((double) 0)
+
 namespace vtl {
 	template<class T> class TList;
 }
@@ -84,20 +90,25 @@ public:
 	int pid;
 
 	QVector<double> schedTimev;
-	QVector<int>    schedEventIdx;
+	QVector<eventidx_t> schedEventIdx;
 	vtl::BitVector  schedData;
-	QVector<double> scaledSchedData;
+	/* Level of detail pyramid of schedData */
+	vtl::MinMaxPyramid schedLod;
 	QVector<double> delayTimev;
 	QVector<double> delay;
-	QVector<double> delayHeight;
-	QVector<double> delayZero;
 	QVector<double> wakeTimev;
 	QVector<double> wakeDelay;
-	QVector<double> wakeHeight;
-	QVector<double> wakeZero;
 	QVector<double> preemptedTimev;
 	QVector<double> runningTimev;
 	QVector<double> uninterruptibleTimev;
+	/*
+	 * The scaled vectors are only filled by the doScale*() functions, which
+	 * are only used for the unified task graphs. The per CPU graphs apply
+	 * the scale and the offset when drawing.
+	 */
+	QVector<double> scaledSchedData;
+	QVector<double> delayHeight;
+	QVector<double> delayZero;
 	QVector<double> scaledPreemptedData;
 	QVector<double> scaledRunningData;
 	QVector<double> scaledUninterruptibleData;
@@ -114,16 +125,25 @@ public:
 	double offset;
 	double scale;
 
+	void reserve(const PrescanCount &count, int nrExtra, int nrWake);
+	bool doLod();
 	bool doScale();
 	bool doStats();
 	bool doStatsTimeLimited();
+	void statsTimeLimited(const vtl::Time &start, const vtl::Time &end,
+			      vtl::Time &time, unsigned &pct) const;
 	bool doScaleDelay();
 	bool doScaleRunning();
 	bool doScalePreempted();
 	bool doScaleUnint();
+	vtl_always_inline double schedScale() const;
+	vtl_always_inline double schedValue(int index) const;
+	vtl_always_inline double floorValue() const;
+	double delayValue() const;
 
 	static void setCursorTime(enum TShark::CursorIdx cursor,
 				  const vtl::Time &time);
+	static void getTimeLimits(vtl::Time &low, vtl::Time &high);
 	static void setStartTime(const vtl::Time &time);
 	static void setEndTime(const vtl::Time &time);
 	static void setEvents(const vtl::TList<TraceEvent> *ev);
@@ -136,10 +156,11 @@ public:
 	 */
 	QCPErrorBars *horizontalDelayBars;
 private:
-	int binarySearch_(const vtl::Time &time, int lowerIdx, int higherIdx);
-	vtl_always_inline int binarySearch(const vtl::Time &time);
-	int findLower(const vtl::Time &time);
-	int findHigher(const vtl::Time &time);
+	int binarySearch_(const vtl::Time &time, int lowerIdx,
+			  int higherIdx) const;
+	vtl_always_inline int binarySearch(const vtl::Time &time) const;
+	int findLower(const vtl::Time &time) const;
+	int findHigher(const vtl::Time &time) const;
 	void fillDataVector(QVector<double> &timev, QVector<double> &data,
 			    QVector<double> *zerov, double height);
 
@@ -152,4 +173,21 @@ protected:
 	static const vtl::TList<TraceEvent> *events;
 };
 
+vtl_always_inline double AbstractTask::schedScale() const
+{
+	return scale * SCHED_HEIGHT;
+}
+
+/* This is the value that the scheduling graph has at index */
+vtl_always_inline double AbstractTask::schedValue(int index) const
+{
+	return schedData.read(index) * schedScale() + offset;
+}
+
+/* This is the value of the preempted, running and uninterruptible markers */
+vtl_always_inline double AbstractTask::floorValue() const
+{
+	return FLOOR_HEIGHT * scale + offset;
+}
+
 #endif /* ABSTRACTTASK_H */
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "analyzer/abstracttask.h"
+#include "analyzer/analyzerjobs.h"
+
+FilterEventsJob::FilterEventsJob(TraceAnalyzer *azr):
+	BackgroundJob(JOB_FILTER), analyzer(azr)
+{}
+
+void FilterEventsJob::run()
+{
+	analyzer->filterEvents(filteredEvents, &control);
+}
+
+/* The interval is that of the cursors when the job is created */
+LimitedStatsJob::LimitedStatsJob(TraceAnalyzer *azr):
+	BackgroundJob(JOB_STATS_LIMITED), analyzer(azr)
+{
+	AbstractTask::getTimeLimits(start, end);
+}
+
+void LimitedStatsJob::run()
+{
+	analyzer->computeLimitedStats(stats, start, end, &control);
+}
+
+LatencySortJob::LatencySortJob(TraceAnalyzer *azr):
+	BackgroundJob(JOB_LATENCY_SORT), analyzer(azr)
+{}
+
+void LatencySortJob::run()
+{
+	analyzer->doLatencyStats();
+}
+
+ExportEventsJob::ExportEventsJob(TraceAnalyzer *azr, const QByteArray &name,
+				 TraceAnalyzer::exporttype_t type):
+	BackgroundJob(JOB_EXPORT_EVENTS), analyzer(azr), fileName(name),
+	exportType(type), filtered(azr->isFiltered()), ok(false), ts_errno(0)
+{
+	if (filtered)
+		selection = azr->filteredEvents;
+}
+
+void ExportEventsJob::run()
+{
+	ok = analyzer->exportTraceFile(fileName.constData(), &ts_errno,
+				       exportType,
+				       filtered ? &selection : nullptr,
+				       &control);
+}
+
+/* Every export that the user has asked for is done */
+bool ExportEventsJob::supersedes() const
+{
+	return false;
+}
+
+ExportLatenciesJob::ExportLatenciesJob(TraceAnalyzer *azr,
+				       const QByteArray &name,
+				       TraceAnalyzer::exportformat_t fmt,
+				       TraceAnalyzer::latencytype_t type):
+	BackgroundJob(JOB_EXPORT_LATENCIES), analyzer(azr), fileName(name),
+	format(fmt), latencyType(type), ok(false), ts_errno(0)
+{}
+
+void ExportLatenciesJob::run()
+{
+	ok = analyzer->exportLatencies(format, latencyType,
+				       fileName.constData(), &ts_errno,
+				       &control);
+}
+
+bool ExportLatenciesJob::supersedes() const
+{
+	return false;
+}
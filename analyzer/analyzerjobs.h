@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ANALYZERJOBS_H
+#define ANALYZERJOBS_H
+
+#include <QByteArray>
+#include <QVector>
+
+#include "analyzer/traceanalyzer.h"
+#include "threads/backgroundjob.h"
+#include "vtl/rankbitmap.h"
+
+/*
+ * The BackgroundJobs of the TraceAnalyzer. The results are stored in the jobs
+ * and the receiver of JobRunner::jobFinished() is responsible for committing
+ * them to the analyzer.
+ */
+
+class FilterEventsJob : public BackgroundJob {
+public:
+	FilterEventsJob(TraceAnalyzer *azr);
+	void run();
+	TraceAnalyzer *analyzer;
+	vtl::RankBitmap filteredEvents;
+};
+
+class LimitedStatsJob : public BackgroundJob {
+public:
+	LimitedStatsJob(TraceAnalyzer *azr);
+	void run();
+	TraceAnalyzer *analyzer;
+	vtl::Time start;
+	vtl::Time end;
+	QVector<TaskStatsLimited> stats;
+};
+
+class LatencySortJob : public BackgroundJob {
+public:
+	LatencySortJob(TraceAnalyzer *azr);
+	void run();
+	TraceAnalyzer *analyzer;
+};
+
+class ExportEventsJob : public BackgroundJob {
+public:
+	ExportEventsJob(TraceAnalyzer *azr, const QByteArray &name,
+			TraceAnalyzer::exporttype_t type);
+	void run();
+	bool supersedes() const;
+	TraceAnalyzer *analyzer;
+	QByteArray fileName;
+	TraceAnalyzer::exporttype_t exportType;
+	/* A copy, so that the filters can change while the export runs */
+	bool filtered;
+	vtl::RankBitmap selection;
+	bool ok;
+	int ts_errno;
+};
+
+class ExportLatenciesJob : public BackgroundJob {
+public:
+	ExportLatenciesJob(TraceAnalyzer *azr, const QByteArray &name,
+			   TraceAnalyzer::exportformat_t fmt,
+			   TraceAnalyzer::latencytype_t type);
+	void run();
+	bool supersedes() const;
+	TraceAnalyzer *analyzer;
+	QByteArray fileName;
+	TraceAnalyzer::exportformat_t format;
+	TraceAnalyzer::latencytype_t latencyType;
+	bool ok;
+	int ts_errno;
+};
+
+#endif /* ANALYZERJOBS_H */
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "analyzer/compiledfilter.h"
+
+FilterBitmap::FilterBitmap():
+	base(0), nrBits(0)
+{}
+
+void FilterBitmap::clear()
+{
+	base = 0;
+	nrBits = 0;
+	words.clear();
+}
+
+CompiledFilterSet::CompiledFilterSet():
+	cpuEnabled(false), pidEnabled(false), eventEnabled(false),
+	timeEnabled(false), pidInclusive(false)
+{}
+
+void CompiledFilterSet::clear()
+{
+	cpuEnabled = false;
+	pidEnabled = false;
+	eventEnabled = false;
+	timeEnabled = false;
+	pidInclusive = false;
+	cpus.clear();
+	pids.clear();
+	types.clear();
+}
+
+CompiledFilter::CompiledFilter():
+	orEnabled(false)
+{}
+
+void CompiledFilter::clear()
+{
+	andSet.clear();
+	orSet.clear();
+	orEnabled = false;
+}
+
+/*
+ * Evaluates the nr events from begin and sets bit k of the words if event
+ * begin + k passes any of the OR filters and all of the AND filters,
+ * respectively. begin must be a multiple of 64 and nr <= 64, so that all the
+ * events are in the same map of the TList and can be accessed as an array.
+ */
+void CompiledFilter::evaluate(const vtl::TList<TraceEvent> *events,
+			      const vtl::TList<SchedRecord> *records,
+			      eventidx_t begin, int nr, uint64_t *orWord,
+			      uint64_t *andWord) const
+{
+	const TraceEvent *ev = &events->at(begin);
+	const SchedRecord *rec = &records->at(begin);
+	uint64_t o = 0;
+	uint64_t a = 0;
+	int k;
+
+	for (k = 0; k < nr; k++)
+		a |= (uint64_t) andSet.allMatch(ev[k], rec[k]) << k;
+
+	if (orEnabled) {
+		for (k = 0; k < nr; k++)
+			o |= (uint64_t) orSet.anyMatch(ev[k], rec[k]) << k;
+	}
+
+	*orWord = o;
+	*andWord = a;
+}
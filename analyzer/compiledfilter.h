@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef COMPILEDFILTER_H
+#define COMPILEDFILTER_H
+
+#include <QMap>
+#include <QVector>
+#include <cstdint>
+
+#include "misc/traceshark.h"
+#include "misc/types.h"
+#include "parser/schedrecord.h"
+#include "parser/traceevent.h"
+#include "vtl/compiler.h"
+#include "vtl/time.h"
+#include "vtl/tlist.h"
+
+/*
+ * A dense bitmap of the integer keys of a QMap. The bitmap only covers the
+ * range between the smallest and the largest key, so that it stays small for
+ * the pids, which may be negative.
+ */
+class FilterBitmap {
+public:
+	FilterBitmap();
+	template<typename K, typename V>
+	void setKeys(const QMap<K, V> &map);
+	void clear();
+	vtl_always_inline bool test(int64_t v) const;
+private:
+	int64_t base;
+	uint64_t nrBits;
+	QVector<uint64_t> words;
+};
+
+template<typename K, typename V>
+void FilterBitmap::setKeys(const QMap<K, V> &map)
+{
+	typename QMap<K, V>::const_iterator iter;
+	uint64_t b;
+
+	clear();
+	if (map.isEmpty())
+		return;
+
+	/* The keys of a QMap are sorted */
+	base = (int64_t) map.firstKey();
+	nrBits = (uint64_t) ((int64_t) map.lastKey() - base) + 1;
+	words.fill(0, (int) ((nrBits + 63) / 64));
+	for (iter = map.begin(); iter != map.end(); iter++) {
+		b = (uint64_t) ((int64_t) iter.key() - base);
+		words[(int) (b / 64)] |= UINT64_C(1) << (b % 64);
+	}
+}
+
+vtl_always_inline bool FilterBitmap::test(int64_t v) const
+{
+	uint64_t b = (uint64_t) (v - base);
+
+	if (b >= nrBits)
+		return false;
+	return (words[(int) (b / 64)] >> (b % 64)) & 1;
+}
+
+/*
+ * One set of filters, either the AND or the OR filters, translated from the
+ * QMaps of the TraceAnalyzer to bitmaps. The regex filter is not part of it,
+ * because it cannot be evaluated in the same way as the others.
+ */
+class CompiledFilterSet {
+public:
+	CompiledFilterSet();
+	void clear();
+	vtl_always_inline bool pidMatch(const TraceEvent &event,
+					const SchedRecord &rec) const;
+	vtl_always_inline bool allMatch(const TraceEvent &event,
+					const SchedRecord &rec) const;
+	vtl_always_inline bool anyMatch(const TraceEvent &event,
+					const SchedRecord &rec) const;
+	bool cpuEnabled;
+	bool pidEnabled;
+	bool eventEnabled;
+	bool timeEnabled;
+	bool pidInclusive;
+	FilterBitmap cpus;
+	FilterBitmap pids;
+	FilterBitmap types;
+	vtl::CompactTime timeLow;
+	vtl::CompactTime timeHigh;
+};
+
+/*
+ * An inclusive pid filter also accepts the events where the task is the
+ * subject of the SchedRecord, for example when it's woken up or switched in.
+ */
+vtl_always_inline
+bool CompiledFilterSet::pidMatch(const TraceEvent &event,
+				 const SchedRecord &rec) const
+{
+	if (pids.test(event.pid))
+		return true;
+	if (!pidInclusive || !rec.isValid())
+		return false;
+	switch (event.type) {
+	case SCHED_WAKEUP:
+	case SCHED_WAKEUP_NEW:
+	case SCHED_WAKING:
+	case SCHED_PROCESS_FORK:
+		return pids.test(rec.pid);
+	case SCHED_SWITCH:
+		return rec.pid2 != 0 && pids.test(rec.pid2);
+	default:
+		return false;
+	}
+}
+
+/*
+ * The filters are evaluated without short circuiting, so that the compiler
+ * can make the loops of CompiledFilter::evaluate() branch free.
+ */
+vtl_always_inline
+bool CompiledFilterSet::allMatch(const TraceEvent &event,
+				 const SchedRecord &rec) const
+{
+	bool m = true;
+
+	if (cpuEnabled)
+		m &= cpus.test(event.cpu);
+	if (eventEnabled)
+		m &= types.test((int) event.type);
+	if (timeEnabled)
+		m &= (event.time >= timeLow) & (event.time <= timeHigh);
+	if (pidEnabled && m)
+		m = pidMatch(event, rec);
+	return m;
+}
+
+vtl_always_inline
+bool CompiledFilterSet::anyMatch(const TraceEvent &event,
+				 const SchedRecord &rec) const
+{
+	bool m = false;
+
+	if (cpuEnabled)
+		m |= cpus.test(event.cpu);
+	if (eventEnabled)
+		m |= types.test((int) event.type);
+	if (timeEnabled)
+		m |= (event.time >= timeLow) & (event.time <= timeHigh);
+	if (pidEnabled && !m)
+		m = pidMatch(event, rec);
+	return m;
+}
+
+/*
+ * The active filters of the TraceAnalyzer compiled to bitmaps. evaluate()
+ * produces selection bitmaps with one bit per event, the regex filters must be
+ * applied by the caller because they are left out here.
+ */
+class CompiledFilter {
+public:
+	CompiledFilter();
+	void clear();
+	void evaluate(const vtl::TList<TraceEvent> *events,
+		      const vtl::TList<SchedRecord> *records,
+		      eventidx_t begin, int nr, uint64_t *orWord,
+		      uint64_t *andWord) const;
+	CompiledFilterSet andSet;
+	CompiledFilterSet orSet;
+	bool orEnabled;
+};
+
+#endif /* COMPILEDFILTER_H */
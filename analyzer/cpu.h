@@ -53,6 +53,7 @@
 #ifndef CPU_H
 #define CPU_H
 
+#include "misc/types.h"
 #include "vtl/time.h"
 
 class CPU {
@@ -63,11 +64,11 @@ public:
 	bool hasBeenScheduled;
 
 	/* Time when pidOnCPU was scheduled */
-	vtl::Time lastSched;
-	int lastSchedIdx;
+	vtl::CompactTime lastSched;
+	eventidx_t lastSchedIdx;
 
-	vtl::Time lastEnterIdle;
-	vtl::Time lastExitIdle;
+	vtl::CompactTime lastEnterIdle;
+	vtl::CompactTime lastExitIdle;
 };
 
 #endif /* CPU_H */
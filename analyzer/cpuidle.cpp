@@ -52,12 +52,10 @@
 
 #include "analyzer/cpuidle.h"
 
-bool CpuIdle::doScale()
+/* The data is scaled when drawing, so this is only needed if data has grown */
+bool CpuIdle::doLod()
 {
-	int i;
-	int s = data.size();
-	scaledData.resize(s);
-	for (i = 0; i < s; i++)
-		scaledData[i] = data[i] * scale + offset;
-	return false; /* No error */	
+	if (!lod.isValid())
+		lod.build(data);
+	return false; /* No error */
 }
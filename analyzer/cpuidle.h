@@ -55,14 +55,18 @@
 
 #include <QVector>
 
+#include "vtl/minmaxpyramid.h"
+
 class CpuIdle {
 public:
 	QVector<double> timev;
 	QVector<double> data;
-	QVector<double> scaledData;
+	/* Level of detail pyramid of data */
+	vtl::MinMaxPyramid lod;
+	/* The graph draws data * scale + offset */
 	double offset;
 	double scale;
-	bool doScale();
+	bool doLod();
 };
 
 #endif /* CPUIDLE_H */
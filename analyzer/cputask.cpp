@@ -58,17 +58,18 @@ CPUTask::CPUTask() :
 	AbstractTask(), verticalDelayBars(nullptr)
 {}
 
-bool CPUTask::doScaleDelay() {
-	int s = delay.size();
-	int i;
-	/* Compute a scaled delay vector needed for vertical display */
-	verticalDelay.resize(s);
-	double maxsize = DELAY_SIZE * scale;
-	double factor = maxsize / delay_max;
-	for (i = 0; i < s; i++)
-		verticalDelay[i] = TSMIN(factor * delay[i], maxsize);
+/*
+ * The vertical display of a delay is TSMIN(delay * verticalDelayFactor(),
+ * verticalDelaySize()).
+ */
+double CPUTask::verticalDelaySize() const
+{
+	return DELAY_SIZE * scale;
+}
 
-	return AbstractTask::doScaleDelay();
+double CPUTask::verticalDelayFactor() const
+{
+	return verticalDelaySize() / delay_max;
 }
 
 void CPUTask::setVerticalDelayMAX(int w)
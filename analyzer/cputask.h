@@ -62,8 +62,8 @@ class QCPErrorBars;
 class CPUTask: public AbstractTask {
 public:
 	CPUTask();
-	QVector<double> verticalDelay;
-	bool doScaleDelay();
+	double verticalDelaySize() const;
+	double verticalDelayFactor() const;
 	static void setVerticalDelayMAX(int w);
 
 	/*
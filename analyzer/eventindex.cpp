@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "analyzer/eventindex.h"
+#include "misc/traceshark.h"
+#include "parser/schedrecord.h"
+#include "parser/traceevent.h"
+#include "vtl/tlist.h"
+
+EventIndex::EventIndex():
+	events(nullptr), records(nullptr), beginIdx(0), endIdx(0),
+	cpusFull(false), typesFull(false), tasksFull(false)
+{}
+
+void EventIndex::setRange(const vtl::TList<TraceEvent> *ev,
+			  const vtl::TList<SchedRecord> *rec,
+			  eventidx_t begin, eventidx_t end)
+{
+	events = ev;
+	records = rec;
+	beginIdx = begin;
+	endIdx = end;
+}
+
+void EventIndex::clear()
+{
+	cpus.clear();
+	types.clear();
+	tasks.clear();
+	invalidWaking.clear();
+	cpusFull = false;
+	typesFull = false;
+	tasksFull = false;
+}
+
+/* Returns false if the list is full */
+vtl_always_inline bool EventIndex::append(QVector<EventIndexList> &lists,
+					  int i, eventidx_t idx)
+{
+	if (i >= lists.size())
+		lists.resize(i + 1);
+	EventIndexList &list = lists[i];
+	if (list.size() >= EVENTINDEX_MAX_LIST_SIZE)
+		return false;
+	list.append(idx);
+	return true;
+}
+
+/* Returns false if the list is full */
+vtl_always_inline bool EventIndex::appendTask(int pid,
+					      TaskEventIndex::role_t role,
+					      eventidx_t idx)
+{
+	EventIndexList &list = tasks[pid].roles[role];
+
+	if (list.size() >= EVENTINDEX_MAX_LIST_SIZE)
+		return false;
+	list.append(idx);
+	return true;
+}
+
+bool EventIndex::buildCPUIndex()
+{
+	eventidx_t i;
+
+	if (cpusFull)
+		return false;
+
+	for (i = beginIdx; i < endIdx; i++) {
+		const TraceEvent &event = events->at(i);
+		if (!isValidCPU(event.cpu))
+			continue;
+		if (!append(cpus, (int) event.cpu, i)) {
+			cpusFull = true;
+			cpus.clear();
+			break;
+		}
+	}
+	return false; /* No error */
+}
+
+bool EventIndex::buildTypeIndex()
+{
+	eventidx_t i;
+
+	if (typesFull)
+		return false;
+
+	for (i = beginIdx; i < endIdx; i++) {
+		const TraceEvent &event = events->at(i);
+		if ((int) event.type < 0)
+			continue;
+		if (!append(types, (int) event.type, i)) {
+			typesFull = true;
+			types.clear();
+			break;
+		}
+	}
+	return false; /* No error */
+}
+
+/*
+ * The roles should match the conditions of the TraceAnalyzer::find*Event()
+ * functions that use them.
+ */
+bool EventIndex::buildTaskIndex()
+{
+	eventidx_t i;
+	bool ok = true;
+
+	if (tasksFull)
+		return false;
+
+	for (i = beginIdx; i < endIdx && ok; i++) {
+		const TraceEvent &event = events->at(i);
+		switch (event.type) {
+		case SCHED_SWITCH: {
+			const SchedRecord &rec = records->at(i);
+			if (!rec.isValid())
+				break;
+			ok = appendTask(rec.pid, TaskEventIndex::ROLE_SWITCH_OUT,
+					i) &&
+				appendTask(rec.pid2,
+					   TaskEventIndex::ROLE_SWITCH_IN, i);
+			break;
+		}
+		case SCHED_WAKEUP:
+		case SCHED_WAKEUP_NEW: {
+			const SchedRecord &rec = records->at(i);
+			if (rec.isValid())
+				ok = appendTask(rec.pid,
+						TaskEventIndex::ROLE_WAKEUP, i);
+			break;
+		}
+		case SCHED_WAKING: {
+			const SchedRecord &rec = records->at(i);
+			if (rec.isValid()) {
+				ok = appendTask(rec.pid,
+						TaskEventIndex::ROLE_WAKING, i);
+			} else if (invalidWaking.size() <
+				   EVENTINDEX_MAX_LIST_SIZE) {
+				invalidWaking.append(i);
+			} else {
+				ok = false;
+			}
+			break;
+		}
+		default:
+			break;
+		}
+	}
+	if (!ok) {
+		tasksFull = true;
+		tasks.clear();
+		invalidWaking.clear();
+	}
+	return false; /* No error */
+}
+
+/*
+ * Returns the position of the last element in list that is <= idx, or -1 if
+ * there is no such element.
+ */
+int EventIndex::findLastBefore(const EventIndexList &list, eventidx_t idx)
+{
+	int low = 0;
+	int high = list.size();
+	int mid;
+
+	/* Find the first element that is > idx */
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (list[mid] <= idx)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low - 1;
+}
+
+/*
+ * Returns the position of the first element in list that is >= idx, or
+ * list.size() if there is no such element.
+ */
+int EventIndex::findFirstAfter(const EventIndexList &list, eventidx_t idx)
+{
+	int low = 0;
+	int high = list.size();
+	int mid;
+
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (list[mid] < idx)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
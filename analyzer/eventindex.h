@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVENTINDEX_H
+#define EVENTINDEX_H
+
+#include <QVector>
+#include <climits>
+
+#include "misc/types.h"
+#include "vtl/compiler.h"
+#include "vtl/pidmap.h"
+
+class SchedRecord;
+class TraceEvent;
+
+namespace vtl {
+	template<class T> class TList;
+}
+
+typedef QVector<eventidx_t> EventIndexList;
+
+/*
+ * A QVector can hold at most about INT_MAX bytes with Qt 5, so the lists are
+ * capped at half of that, in order to leave room for the growth of the
+ * capacity. A trace that has more events than this on a single CPU, of a
+ * single type, or for a single task and role, is not indexed and the users
+ * of the index have to scan the events instead.
+ */
+#define EVENTINDEX_MAX_LIST_SIZE (INT_MAX / (int) sizeof(eventidx_t) / 2)
+
+class TaskEventIndex {
+public:
+	/* The roles that a task can have in a scheduling event */
+	typedef enum : int {
+		ROLE_SWITCH_IN = 0, /* The new task of a sched_switch */
+		ROLE_SWITCH_OUT,    /* The old task of a sched_switch */
+		ROLE_WAKEUP,        /* sched_wakeup and sched_wakeup_new */
+		ROLE_WAKING,        /* sched_waking */
+		NR_ROLES
+	} role_t;
+	EventIndexList roles[NR_ROLES];
+};
+
+/*
+ * The EventIndex keeps sorted lists of event indices per CPU, per event type
+ * and per task and role, so that the analyzer can find events by doing binary
+ * searches in short lists instead of scanning the whole trace.
+ *
+ * The lists are built one range at a time by the build functions below, which
+ * are meant to be run in parallel, since they don't share any data. The
+ * ranges must be added in increasing order, so that the lists stay sorted.
+ *
+ * If a list would grow beyond EVENTINDEX_MAX_LIST_SIZE, then the lists of
+ * that build function are freed and hasCPUIndex(), hasTypeIndex() or
+ * hasTaskIndex() returns false until the index is cleared.
+ */
+class EventIndex {
+public:
+	EventIndex();
+	void setRange(const vtl::TList<TraceEvent> *ev,
+		      const vtl::TList<SchedRecord> *rec,
+		      eventidx_t begin, eventidx_t end);
+	bool buildCPUIndex();
+	bool buildTypeIndex();
+	bool buildTaskIndex();
+	void clear();
+	vtl_always_inline bool hasCPUIndex() const;
+	vtl_always_inline bool hasTypeIndex() const;
+	vtl_always_inline bool hasTaskIndex() const;
+	vtl_always_inline const EventIndexList *cpuEvents(unsigned int cpu)
+		const;
+	vtl_always_inline const EventIndexList *typeEvents(event_t type)
+		const;
+	vtl_always_inline const EventIndexList *taskEvents(
+		int pid, TaskEventIndex::role_t role) const;
+	vtl_always_inline const EventIndexList *invalidWakingEvents() const;
+	static int findLastBefore(const EventIndexList &list, eventidx_t idx);
+	static int findFirstAfter(const EventIndexList &list, eventidx_t idx);
+private:
+	vtl_always_inline static bool append(QVector<EventIndexList> &lists,
+					     int i, eventidx_t idx);
+	vtl_always_inline bool appendTask(int pid, TaskEventIndex::role_t role,
+					  eventidx_t idx);
+	const vtl::TList<TraceEvent> *events;
+	const vtl::TList<SchedRecord> *records;
+	eventidx_t beginIdx;
+	eventidx_t endIdx;
+	QVector<EventIndexList> cpus;
+	QVector<EventIndexList> types;
+	vtl::PidMap<TaskEventIndex> tasks;
+	/* sched_waking events whose arguments could not be parsed */
+	EventIndexList invalidWaking;
+	bool cpusFull;
+	bool typesFull;
+	bool tasksFull;
+};
+
+vtl_always_inline bool EventIndex::hasCPUIndex() const
+{
+	return !cpusFull;
+}
+
+vtl_always_inline bool EventIndex::hasTypeIndex() const
+{
+	return !typesFull;
+}
+
+vtl_always_inline bool EventIndex::hasTaskIndex() const
+{
+	return !tasksFull;
+}
+
+vtl_always_inline
+const EventIndexList *EventIndex::cpuEvents(unsigned int cpu) const
+{
+	if (cpu >= (unsigned int) cpus.size())
+		return nullptr;
+	return &cpus[cpu];
+}
+
+vtl_always_inline
+const EventIndexList *EventIndex::typeEvents(event_t type) const
+{
+	if ((int) type < 0 || (int) type >= types.size())
+		return nullptr;
+	return &types[type];
+}
+
+vtl_always_inline
+const EventIndexList *EventIndex::taskEvents(int pid,
+					     TaskEventIndex::role_t role) const
+{
+	vtl::PidMap<TaskEventIndex>::iterator iter = tasks.find(pid);
+
+	if (iter == tasks.end())
+		return nullptr;
+	return &iter.value().roles[role];
+}
+
+vtl_always_inline const EventIndexList *EventIndex::invalidWakingEvents() const
+{
+	return &invalidWaking;
+}
+
+#endif /* EVENTINDEX_H */
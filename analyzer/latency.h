@@ -53,6 +53,7 @@
 #ifndef LATENCY_H
 #define LATENCY_H
 
+#include "misc/types.h"
 #include "vtl/compiler.h"
 #include "vtl/time.h"
 
@@ -82,12 +83,12 @@ public:
 		ORDER_REVERSE
 	} order_t;
 
-	vtl::Time time;
-	vtl::Time delay;
+	vtl::CompactTime time;
+	vtl::CompactTime delay;
 	int pid;
-	unsigned int place;
-	int sched_idx;
-	int runnable_idx;
+	int64_t place;
+	eventidx_t sched_idx;
+	eventidx_t runnable_idx;
 };
 
 #endif
@@ -64,26 +64,31 @@ public:
 			Latency::order_t ord,
 			TraceAnalyzer *azr) :
 		compare(cmp), order(ord), analyzer(azr) {}
+	/* The places are 64-bit, so their difference may not fit in an int */
+	static vtl_always_inline int comparePlace(const Latency &ll,
+						  const Latency &rl) {
+		return (ll.place > rl.place) - (ll.place < rl.place);
+	}
 	int operator() (const Latency &ll, const Latency &rl) {
 		int r;
 
 		if (compare == Latency::CMP_NAME) {
 			r = pidToName(ll.pid).compare(pidToName(rl.pid));
 			if (r == 0)
-				r = ll.place - rl.place;
+				r = comparePlace(ll, rl);
 		} else if (compare == Latency::CMP_TIME) {
 			r = ll.time.compare(rl.time);
 			if (r == 0)
-				r = ll.place - rl.place;
+				r = comparePlace(ll, rl);
 		} else if (compare == Latency::CMP_DELAY) {
 			/*
 			 * Here we should really compare the delay first but
 			 * since that since place has been generated with the
 			 * Latency::CMP_CREATE_PLACE below, it is not necessary.
 			 */
-			r = ll.place - rl.place;
+			r = comparePlace(ll, rl);
 		} else if (compare == Latency::CMP_PLACE) {
-			r = ll.place - rl.place;
+			r = comparePlace(ll, rl);
 		} else if (compare == Latency::CMP_CREATE_PLACE) {
 			/*
 			 * This is only needed for the purpose of sorting the
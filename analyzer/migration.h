@@ -53,6 +53,7 @@
 #ifndef MIGRATION_H
 #define MIGRATION_H
 
+#include <QColor>
 #include "vtl/time.h"
 
 class Migration {
@@ -60,7 +61,19 @@ public:
 	int pid;
 	int oldcpu;
 	int newcpu;
-	vtl::Time time;
+	vtl::CompactTime time;
+};
+
+/*
+ * A migration, fork or exit as it is drawn by the MigrationGraph. The CPU is -1
+ * for the fork/exit line.
+ */
+class MigrationArrow {
+public:
+	double time;
+	QRgb color;
+	qint16 oldcpu;
+	qint16 newcpu;
 };
 
 #endif /* MIGRATION */
@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "analyzer/prescan.h"
+#include "misc/traceshark.h"
+#include "parser/schedrecord.h"
+#include "parser/traceevent.h"
+#include "vtl/tlist.h"
+
+Prescan::Prescan():
+	events(nullptr), records(nullptr), beginIdx(0), endIdx(0),
+	cpuIndex(0), nrCPUGroups(1)
+{}
+
+Prescan::~Prescan()
+{
+	clear();
+}
+
+void Prescan::setRange(const vtl::TList<TraceEvent> *ev,
+		       const vtl::TList<SchedRecord> *rec,
+		       eventidx_t begin, eventidx_t end, unsigned int index,
+		       unsigned int nr)
+{
+	events = ev;
+	records = rec;
+	beginIdx = begin;
+	endIdx = end;
+	cpuIndex = index;
+	nrCPUGroups = nr;
+}
+
+void Prescan::clear()
+{
+	int i;
+	int s = cpuTasks.size();
+
+	for (i = 0; i < s; i++)
+		delete cpuTasks[i];
+	cpuTasks.clear();
+	tasks.clear();
+	nrFreq.clear();
+	nrIdle.clear();
+}
+
+vtl_always_inline bool Prescan::ownsCPU(unsigned int cpu) const
+{
+	return cpu % nrCPUGroups == cpuIndex;
+}
+
+vtl_always_inline PrescanCount &Prescan::cpuTask(unsigned int cpu, int pid)
+{
+	if (cpu >= (unsigned int) cpuTasks.size())
+		cpuTasks.resize(cpu + 1);
+	if (cpuTasks[cpu] == nullptr)
+		cpuTasks[cpu] = new vtl::PidMap<PrescanCount>;
+	return (*cpuTasks[cpu])[pid];
+}
+
+vtl_always_inline void Prescan::increase(QVector<int> &vec, unsigned int cpu)
+{
+	if (cpu >= (unsigned int) vec.size())
+		vec.resize(cpu + 1);
+	vec[cpu]++;
+}
+
+/*
+ * The conditions here should match those of TraceAnalyzer::processGeneric()
+ * and the functions that it calls, so that we only count the events that
+ * will actually be appended to the vectors.
+ */
+bool Prescan::count()
+{
+	eventidx_t i;
+	taskstate_t state;
+
+	for (i = beginIdx; i < endIdx; i++) {
+		const TraceEvent &event = events->at(i);
+		if (!isValidCPU(event.cpu))
+			continue;
+		switch (event.type) {
+		case SCHED_SWITCH: {
+			if (!ownsCPU(event.cpu))
+				break;
+			const SchedRecord &rec = records->at(i);
+			if (!rec.isValid())
+				break;
+			if (rec.pid > 0) {
+				PrescanCount &c = cpuTask(event.cpu, rec.pid);
+				c.nrOut++;
+				state = rec.state();
+				if (!task_state_is_runnable(state)) {
+					if (task_state_is_flag_set(
+						    state,
+						    TASK_FLAG_UNINTERRUPTIBLE))
+						c.nrUnint++;
+				} else if (task_state_is_flag_set(
+						   state, TASK_FLAG_PREEMPT)) {
+					c.nrPreempted++;
+				} else {
+					c.nrRunning++;
+				}
+			}
+			if (rec.pid2 > 0)
+				cpuTask(event.cpu, rec.pid2).nrIn++;
+			break;
+		}
+		case SCHED_WAKEUP:
+		case SCHED_WAKEUP_NEW: {
+			if (!ownsCPU(event.cpu))
+				break;
+			const SchedRecord &rec = records->at(i);
+			if (rec.isValid() && rec.isSuccess())
+				tasks[rec.pid].nrWakeup++;
+			break;
+		}
+		case CPU_FREQUENCY: {
+			const SchedRecord &rec = records->at(i);
+			if (rec.isValid() && isValidCPU(rec.cpu) &&
+			    ownsCPU(rec.cpu))
+				increase(nrFreq, rec.cpu);
+			break;
+		}
+		case CPU_IDLE: {
+			const SchedRecord &rec = records->at(i);
+			if (rec.isValid() && isValidCPU(rec.cpu) &&
+			    ownsCPU(rec.cpu))
+				increase(nrIdle, rec.cpu);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+	return false; /* No error */
+}
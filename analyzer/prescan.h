@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef PRESCAN_H
+#define PRESCAN_H
+
+#include <QVector>
+
+#include "misc/types.h"
+#include "vtl/compiler.h"
+#include "vtl/pidmap.h"
+
+class SchedRecord;
+class TraceEvent;
+
+namespace vtl {
+	template<class T> class TList;
+}
+
+class PrescanCount {
+public:
+	PrescanCount(): nrIn(0), nrOut(0), nrPreempted(0), nrRunning(0),
+			nrUnint(0), nrWakeup(0) {}
+	int nrIn;        /* Number of times that the task was switched in    */
+	int nrOut;       /* Number of times that the task was switched out   */
+	int nrPreempted; /* Switched out while runnable and preempted        */
+	int nrRunning;   /* Switched out while runnable but not preempted    */
+	int nrUnint;     /* Switched out in uninterruptible sleep            */
+	int nrWakeup;    /* Number of successful wakeups of the task         */
+};
+
+/*
+ * Makes room for exactly n more elements in v. This is only done once per
+ * trace, when the number of remaining events is known, so the vector gets its
+ * final size at once.
+ */
+template<class V>
+vtl_always_inline void prescanReserve(V &v, int n)
+{
+	v.reserve(v.size() + n);
+}
+
+/*
+ * A Prescan counts the events in a range of the trace, so that the analyzer
+ * can reserve the vectors of the tasks and CPUs before it processes the range.
+ * The CPUs are divided between nr Prescans, so that the Prescan with index i
+ * only counts events for CPUs where cpu % nr == i. This way the Prescans can
+ * run in parallel over the same range without sharing any data. The wakeups
+ * are counted by the Prescan of the CPU of the wakeup event.
+ */
+class Prescan {
+public:
+	Prescan();
+	~Prescan();
+	void setRange(const vtl::TList<TraceEvent> *ev,
+		      const vtl::TList<SchedRecord> *rec,
+		      eventidx_t begin, eventidx_t end, unsigned int index,
+		      unsigned int nr);
+	bool count();
+	void clear();
+	/* Only the nrWakeup of these are used */
+	vtl::PidMap<PrescanCount> tasks;
+	/* These are indexed by CPU */
+	QVector<vtl::PidMap<PrescanCount>*> cpuTasks;
+	QVector<int> nrFreq;
+	QVector<int> nrIdle;
+private:
+	vtl_always_inline bool ownsCPU(unsigned int cpu) const;
+	vtl_always_inline PrescanCount &cpuTask(unsigned int cpu, int pid);
+	vtl_always_inline static void increase(QVector<int> &vec,
+					       unsigned int cpu);
+	const vtl::TList<TraceEvent> *events;
+	const vtl::TList<SchedRecord> *records;
+	eventidx_t beginIdx;
+	eventidx_t endIdx;
+	unsigned int cpuIndex;
+	unsigned int nrCPUGroups;
+};
+
+#endif /* PRESCAN_H */
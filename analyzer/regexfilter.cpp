@@ -60,3 +60,200 @@ const char * const Regex::posNames[] = {
 };
 
 #undef REGEXFILTER_POS_ITEM_
+
+Regex::Regex():
+	logic(TShark::LOGIC_AND), inverted(false), caseSensitive(true),
+	isExtended(false), posType(POS_NONE), pos(0), regex_valid(false),
+	literalAtStart(false), literalAtEnd(false), literalOnly(false),
+	cache(nullptr)
+{}
+
+/*
+ * Finds the longest sequence of ordinary characters in the pattern that must
+ * be present in every string that matches. The analysis is conservative, if
+ * in doubt, the literal is discarded or cut short. Patterns with alternation
+ * have no single required literal, so they are not analyzed at all. The
+ * literal only has ASCII characters.
+ */
+void Regex::analyzeLiteral()
+{
+	QByteArray pattern = text.toLocal8Bit();
+	const char *p = pattern.constData();
+	const int len = pattern.size();
+	QByteArray run;
+	bool pure = true;
+	bool first = true;
+	bool quant;
+	bool special;
+	char c;
+	int i = 0;
+
+	literal.clear();
+	literalAtStart = false;
+	literalAtEnd = false;
+	literalOnly = false;
+
+	/*
+	 * REG_ICASE folds the case according to the locale, which may map
+	 * some non-ASCII characters to ASCII letters, so we leave those
+	 * patterns to regexec() and the cache.
+	 */
+	if (!caseSensitive)
+		return;
+
+	if (isExtended ? strchr(p, '|') != nullptr :
+	    strstr(p, "\\|") != nullptr)
+		return;
+
+	if (len > 0 && p[0] == '^') {
+		literalAtStart = true;
+		i++;
+	}
+
+	while (i < len) {
+		c = p[i];
+		quant = false;
+		special = false;
+
+		if (c == '\\') {
+			if (i + 1 >= len)
+				goto giveup;
+			c = p[i + 1];
+			i += 2;
+			if (!isExtended && (c == '(' || c == ')'))
+				break;
+			if (!isExtended && (c == '?' || c == '+')) {
+				quant = true;
+			} else if (!isExtended && c == '{') {
+				const char *e = strstr(p + i, "\\}");
+				if (e == nullptr)
+					goto giveup;
+				i = e - p + 2;
+				quant = true;
+			} else if ((c >= '0' && c <= '9') ||
+				   (c >= 'a' && c <= 'z') ||
+				   (c >= 'A' && c <= 'Z') ||
+				   c == '<' || c == '>' || c == '`' ||
+				   c == '\'' || (unsigned char) c >= 0x80) {
+				special = true;
+			}
+		} else if (c == '$' && i == len - 1) {
+			literalAtEnd = true;
+			i++;
+			break;
+		} else if (isExtended && (c == '(' || c == ')')) {
+			break;
+		} else if (c == '*' || (isExtended && (c == '?' || c == '+'))) {
+			i++;
+			quant = true;
+		} else if (isExtended && c == '{') {
+			const char *e = strchr(p + i, '}');
+			if (e == nullptr)
+				goto giveup;
+			i = e - p + 1;
+			quant = true;
+		} else if (c == '[') {
+			/* Skip the bracket expression */
+			i++;
+			if (i < len && p[i] == '^')
+				i++;
+			if (i < len && p[i] == ']')
+				i++;
+			while (i < len && p[i] != ']') {
+				if (p[i] == '[' && i + 1 < len &&
+				    (p[i + 1] == ':' || p[i + 1] == '.' ||
+				     p[i + 1] == '=')) {
+					const char d[3] = { p[i + 1], ']', 0 };
+					const char *e = strstr(p + i + 2, d);
+					if (e == nullptr)
+						goto giveup;
+					i = e - p + 2;
+				} else {
+					i++;
+				}
+			}
+			if (i >= len)
+				goto giveup;
+			i++;
+			special = true;
+		} else if (c == '.' || (isExtended && (c == '^' || c == '$'))) {
+			i++;
+			special = true;
+		} else if ((unsigned char) c >= 0x80) {
+			/*
+			 * A quantifier after a multibyte character applies to
+			 * the whole character, so the run must not end with
+			 * only some of its bytes. Keep it simple and end the
+			 * run at every non-ASCII byte.
+			 */
+			i++;
+			special = true;
+		} else {
+			i++;
+		}
+
+		if (quant) {
+			/*
+			 * A leading '*' is an ordinary character in a basic
+			 * regex, don't bother with that case. Otherwise, the
+			 * quantifier applies to the last character of the run
+			 * or to something that isn't part of it.
+			 */
+			if (first)
+				goto giveup;
+			if (!run.isEmpty())
+				run.chop(1);
+		}
+		first = false;
+		if (quant || special) {
+			pure = false;
+			if (run.size() > literal.size())
+				literal = run;
+			run.clear();
+			continue;
+		}
+		run.append(c);
+	}
+
+	if (i < len)
+		pure = false;
+	if (run.size() > literal.size())
+		literal = run;
+	literalOnly = pure && literal.size() > 0;
+	return;
+giveup:
+	literal.clear();
+	literalAtStart = false;
+	literalAtEnd = false;
+}
+
+RegexMatchCache::RegexMatchCache(uint64_t nr):
+	nrStrings(nr)
+{
+	uint64_t size = 16;
+
+	/* Keep the load factor at or below 0.5 */
+	while (size < 2 * nr)
+		size *= 2;
+	table = new Slot[size];
+	mask = size - 1;
+	memset(table, 0, sizeof(Slot) * size);
+}
+
+RegexMatchCache::~RegexMatchCache()
+{
+	delete[] table;
+}
+
+void RegexMatchCache::add(const TString *str, bool match)
+{
+	uint64_t i = hash(str) & mask;
+
+	while (table[i].str != nullptr) {
+		if (table[i].str == str)
+			return;
+		i = (i + 1) & mask;
+	}
+	table[i].str = str;
+	table[i].match = match;
+}
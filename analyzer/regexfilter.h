@@ -58,10 +58,16 @@ extern "C" {
 #include <regex.h>
 }
 
+#include <cstdint>
+#include <cstring>
+
+#include <QByteArray>
 #include <QString>
 #include <QVector>
 
 #include "misc/traceshark.h"
+#include "misc/tstring.h"
+#include "vtl/compiler.h"
 
 #define REGEXFILTER_POS_DEFS_						\
 	REGEXFILTER_POS_ITEM_(NONE, "None"),				\
@@ -69,8 +75,33 @@ extern "C" {
 	REGEXFILTER_POS_ITEM_(RELATIVE, "Previous match"),		\
 	REGEXFILTER_POS_ITEM_(NR, nullptr)
 
+/*
+ * Caches the result of a regex for every string in the argument pool of the
+ * parser. Since the parser interns all arguments, the cache can be keyed by
+ * the pointer of the string.
+ */
+class RegexMatchCache {
+public:
+	RegexMatchCache(uint64_t nr);
+	~RegexMatchCache();
+	void add(const TString *str, bool match);
+	vtl_always_inline int lookup(const TString *str) const;
+	/* The size of the string pool when the cache was built */
+	uint64_t nrStrings;
+private:
+	class Slot {
+	public:
+		const TString *str;
+		bool match;
+	};
+	static vtl_always_inline unsigned int hash(const TString *str);
+	Slot *table;
+	uint64_t mask;
+};
+
 class Regex {
 public:
+	Regex();
 
 #undef REGEXFILTER_POS_ITEM_
 #define REGEXFILTER_POS_ITEM_(a, b) POS_##a
@@ -89,6 +120,23 @@ public:
 	QString text;
 	regex_t regex;
 	bool regex_valid;
+	/*
+	 * A string that every match must contain, extracted from the pattern
+	 * by analyzeLiteral(). If literalOnly is true, then the pattern
+	 * consists of nothing but the literal and the anchors, so that the
+	 * literal alone decides whether a string matches.
+	 */
+	QByteArray literal;
+	bool literalAtStart;
+	bool literalAtEnd;
+	bool literalOnly;
+	RegexMatchCache *cache;
+	void analyzeLiteral();
+	vtl_always_inline bool matchString(const TString *str) const;
+	vtl_always_inline bool match(const TString *str) const;
+private:
+	vtl_always_inline bool matchLiteral(const TString *str,
+					    bool &decided) const;
 };
 
 class RegexFilter {
@@ -97,4 +145,88 @@ public:
 	bool valid;
 };
 
+vtl_always_inline unsigned int RegexMatchCache::hash(const TString *str)
+{
+	uint64_t h = (uint64_t) (uintptr_t) str;
+
+	h *= 0x9E3779B97F4A7C15ULL;
+	return (unsigned int) (h >> 32);
+}
+
+/* Returns 1 for a match, 0 for no match, and -1 if str is not in the cache */
+vtl_always_inline int RegexMatchCache::lookup(const TString *str) const
+{
+	uint64_t i = hash(str) & mask;
+
+	while (table[i].str != nullptr) {
+		if (table[i].str == str)
+			return table[i].match ? 1 : 0;
+		i = (i + 1) & mask;
+	}
+	return -1;
+}
+
+/*
+ * Checks the literal of the regex against str. Sets decided to true if the
+ * result is final, otherwise the caller needs to run the regex.
+ */
+vtl_always_inline bool Regex::matchLiteral(const TString *str,
+					   bool &decided) const
+{
+	const int llen = literal.size();
+	const char *lptr = literal.constData();
+	bool found;
+
+	decided = false;
+	if (llen > str->len) {
+		decided = true;
+		return false;
+	}
+
+	/*
+	 * With REG_NEWLINE, the anchors also match around newlines, so we
+	 * cannot take a decision about anchored patterns in that case.
+	 */
+	if (literalOnly && (literalAtStart || literalAtEnd) &&
+	    memchr(str->ptr, '\n', str->len) != nullptr)
+		return true;
+
+	if (literalOnly && literalAtStart && literalAtEnd) {
+		found = llen == str->len && !memcmp(str->ptr, lptr, llen);
+	} else if (literalOnly && literalAtStart) {
+		found = !memcmp(str->ptr, lptr, llen);
+	} else if (literalOnly && literalAtEnd) {
+		found = !memcmp(str->ptr + str->len - llen, lptr, llen);
+	} else {
+		found = memmem(str->ptr, str->len, lptr, llen) != nullptr;
+	}
+	decided = literalOnly || !found;
+	return found;
+}
+
+vtl_always_inline bool Regex::matchString(const TString *str) const
+{
+	bool decided;
+	bool found;
+
+	if (!literal.isEmpty()) {
+		found = matchLiteral(str, decided);
+		if (decided)
+			return found;
+	}
+	return !regexec(&regex, str->ptr, 0, nullptr, 0);
+}
+
+vtl_always_inline bool Regex::match(const TString *str) const
+{
+	int r;
+
+	if (cache != nullptr) {
+		r = cache->lookup(str);
+		if (r >= 0)
+			return r != 0;
+	}
+	return matchString(str);
+}
+
 #endif /* _REGEXFILTER_H */
@@ -108,11 +108,11 @@ public:
 	exitstatus_t exitStatus;
 
 	/* lastRunnable is only used during extraction */
-	vtl::Time    lastRunnable;
-	int          lastRunnable_idx;
+	vtl::CompactTime lastRunnable;
+	eventidx_t   lastRunnable_idx;
 	runstatus_t  lastRunnable_status;
 
-	vtl::Time    lastSleepEntry;
+	vtl::CompactTime lastSleepEntry;
 
 	/*
 	 * The unified task needs to save pointers to these graphs so that they
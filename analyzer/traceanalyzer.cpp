@@ -50,6 +50,7 @@
  *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include <climits>
 #include <cstdio>
 #include <cstdlib>
@@ -66,6 +67,7 @@ extern "C" {
 #include <QtGlobal>
 #include <QList>
 #include <QString>
+#include <QThread>
 
 #include "vtl/compiler.h"
 #include "vtl/error.h"
@@ -76,6 +78,7 @@ extern "C" {
 #include "analyzer/cpuidle.h"
 #include "parser/genericparams.h"
 #include "analyzer/latencycomp.h"
+#include "analyzer/prescan.h"
 #include "analyzer/traceanalyzer.h"
 #include "parser/tracefile.h"
 #include "parser/traceparser.h"
@@ -84,6 +87,7 @@ extern "C" {
 #include "misc/settingstore.h"
 #include "misc/traceshark.h"
 #include "misc/translate.h"
+#include "threads/backgroundjob.h"
 #include "threads/workthread.h"
 #include "threads/workitem.h"
 #include "threads/workqueue.h"
@@ -103,11 +107,13 @@ TraceAnalyzer::TraceAnalyzer(const SettingStore *sstore)
 	: events(nullptr), cpuTaskMaps(nullptr), cpuFreq(nullptr),
 	  cpuIdle(nullptr), black(0, 0, 0), white(255, 255, 255),
 	  migrationOffset(0), migrationScale(0), maxCPU(0), nrCPUs(0),
-	  endTime(0, 6), startTime(0, 6), endTimeDbl(0), startTimeDbl(0),
+	  endTime(0), startTime(0), endTimeDbl(0), startTimeDbl(0),
 	  endTimeIdx(0), maxFreq(0), minFreq(0), maxIdleState(0),
-	  minIdleState(0), timePrecision(0), CPUs(nullptr),
-	  customPlot(nullptr), pidFilterInclusive(false),
-	  OR_pidFilterInclusive(false), setstor(sstore)
+	  minIdleState(0), timePrecision(0), processBegun(false),
+	  processStarted(false), processEOF(false), processReserved(false),
+	  processIndex(0), processReady(0), CPUs(nullptr),
+	  pidFilterInclusive(false), OR_pidFilterInclusive(false),
+	  deferFilters(false), filterPending(false), setstor(sstore)
 {
 	taskNamePool = new StringPool<>(16384, 256);
 	parser = new TraceParser();
@@ -134,9 +140,7 @@ int TraceAnalyzer::open(const QString &fileName)
 
 void TraceAnalyzer::prepareDataStructures()
 {
-	cpuTaskMaps = new vtl::AVLTree<int, CPUTask,
-				       vtl::AVLBALANCE_USEPOINTERS>
-		[NR_CPUS_ALLOWED];
+	cpuTaskMaps = new vtl::PidMap<CPUTask>[NR_CPUS_ALLOWED];
 	cpuFreq = new CpuFreq[NR_CPUS_ALLOWED];
 	cpuIdle = new CpuIdle[NR_CPUS_ALLOWED];
 	CPUs = new CPU[NR_CPUS_ALLOWED];
@@ -188,12 +192,17 @@ void TraceAnalyzer::close(int *ts_errno)
 	taskMap.clear();
 	disableAllFilters();
 	migrations.clear();
+	migrationArrows.clear();
 	colorMap.clear();
 	origColorMap.clear();
 	parser->close(ts_errno);
 	taskNamePool->clear();
+	eventIndex.clear();
+	zoneMap.clear();
+	pidEventLists.clear();
 	schedLatencies.clear();
 	wakeLatencies.clear();
+	processBegun = false;
 }
 
 void TraceAnalyzer::resetProperties()
@@ -210,37 +219,91 @@ void TraceAnalyzer::resetProperties()
 	maxIdleState = INT_MIN;
 	timePrecision = 0;
 	events = nullptr;
+	records = nullptr;
+	processStarted = false;
+	processEOF = false;
+	processReserved = false;
+	processIndex = 0;
+	processReady = 0;
 }
 
 bool TraceAnalyzer::processTrace(const QMap<int, QColor> &cmap)
 {
-	resetProperties();
+	bool done;
+
+	return processTracePartial(cmap, INT64_MAX, done);
+}
+
+/*
+ * This function processes the trace until at least nrEvents events have been
+ * processed, or until the end of the trace. It can be called repeatedly with
+ * increasing values of nrEvents, so that the caller can show the beginning of
+ * the trace while the parser is still working on the rest. Until done is set
+ * to true, the end time is only provisional and the tails have not been
+ * added to the tasks.
+ */
+bool TraceAnalyzer::processTracePartial(const QMap<int, QColor> &cmap,
+					eventidx_t nrEvents, bool &done)
+{
+	if (!processBegun) {
+		resetProperties();
+		processBegun = true;
+	} else if (processEOF) {
+		done = true;
+		return colorizeTasks(cmap);
+	}
 	/*
 	 * We do the processing from the main thread, since otherwise
 	 * we would have to wait for it
 	 */
-	threadProcess();
+	done = threadProcess(nrEvents);
 	return colorizeTasks(cmap);
 }
 
-void TraceAnalyzer::threadProcess()
+bool TraceAnalyzer::threadProcess(eventidx_t limit)
 {
-	parser->waitForTraceType();
-	events = parser->getEventsTList();
+	bool done;
+
+	if (events == nullptr) {
+		parser->waitForTraceType();
+		events = parser->getEventsTList();
+		records = parser->getRecordsTList();
+	}
 	switch (getTraceType()) {
 	case TRACE_TYPE_FTRACE:
-		processFtrace();
+		done = processFtrace(limit);
 		break;
 	case TRACE_TYPE_PERF:
-		processPerf();
+		done = processPerf(limit);
 		break;
 	default:
-		return;
+		return true;
 	}
+	if (done)
+		processFinish();
+	else
+		updateEndTime(processIndex - 1);
+	return done;
+}
+
+void TraceAnalyzer::processFinish()
+{
+	if (processIndex > 0)
+		updateEndTime(processIndex - 1);
 	processSchedAddTail();
 	processFreqAddTail();
 }
 
+void TraceAnalyzer::updateEndTime(eventidx_t lastIdx)
+{
+	endTime = events->at(lastIdx).time;
+	endTimeIdx = lastIdx;
+	AbstractTask::setEndTime(endTime);
+	endTimeDbl = endTime.toDouble();
+	nrCPUs = maxCPU + 1;
+	timePrecision = vtl::CompactTime::getPrecision();
+}
+
 void TraceAnalyzer::processSchedAddTail()
 {
 	/* Add the "tail" to all tasks, i.e. extend them until endTime */
@@ -320,30 +383,6 @@ void TraceAnalyzer::processFreqAddTail()
 	}
 }
 
-unsigned int TraceAnalyzer::guessTimePrecision()
-{
-	int s = events->size();
-	int r, p;
-
-	r = 0;
-	if (s < 1)
-		return r;
-
-	p = events->at(0).time.getPrecision();
-	if (p > r)
-		r = p;
-
-	p = events->at(s / 2).time.getPrecision();
-	if (p > r)
-		r = p;
-
-	p = events->at(s - 1).time.getPrecision();
-	if (p > r)
-		r = p;
-
-	return r;
-}
-
 /*
  * This function is supposed to be called seldom, thus it's ok to not have it
  * as optimized as the other functions, e.g. in terms of inlining
@@ -351,11 +390,11 @@ unsigned int TraceAnalyzer::guessTimePrecision()
 void TraceAnalyzer::handleWrongTaskOnCPU(const TraceEvent &/*event*/,
 					 unsigned int cpu,
 					 CPU *eventCPU, int oldpid,
-					 const vtl::Time &oldtime,
-					 int idx)
+					 const vtl::CompactTime &oldtime,
+					 eventidx_t idx)
 {
 	int epid = eventCPU->pidOnCPU;
-	vtl::Time prevtime, faketime;
+	vtl::CompactTime prevtime, faketime;
 	double fakeDbl;
 	CPUTask *cpuTask;
 	Task *task;
@@ -511,10 +550,10 @@ retry:
 }
 
 
-int TraceAnalyzer::binarySearch(const vtl::Time &time, int start, int end)
-	const
+eventidx_t TraceAnalyzer::binarySearch(const vtl::CompactTime &time,
+				       eventidx_t start, eventidx_t end) const
 {
-	int pivot = (end + start) / 2;
+	eventidx_t pivot = (end + start) / 2;
 	if (pivot == start)
 		return pivot;
 	if (time < events->at(pivot).time)
@@ -523,24 +562,13 @@ int TraceAnalyzer::binarySearch(const vtl::Time &time, int start, int end)
 		return binarySearch(time, pivot, end);
 }
 
-int TraceAnalyzer::binarySearchFiltered(const vtl::Time &time, int start,
-					int end) const
-{
-	int pivot = (end + start) / 2;
-	if (pivot == start)
-		return pivot;
-	if (time < filteredEvents.at(pivot)->time)
-		return binarySearchFiltered(time, start, pivot);
-	else
-		return binarySearchFiltered(time, pivot, end);
-}
-
-int TraceAnalyzer::findIndexBefore(const vtl::Time &time) const
+eventidx_t
+TraceAnalyzer::findIndexBefore(const vtl::CompactTime &time) const
 {
 	if (events->size() < 1)
 		return -1;
 
-	int end = events->size() - 1;
+	eventidx_t end = events->size() - 1;
 
 	/* Basic sanity checks */
 	if (time > events->at(end).time)
@@ -548,19 +576,24 @@ int TraceAnalyzer::findIndexBefore(const vtl::Time &time) const
 	if (time < events->at(0).time)
 		return 0;
 
-	int c = binarySearch(time, 0, end);
+	eventidx_t start = 0;
+	eventidx_t stop = end;
+	if (zoneMap.nrEvents() == events->size())
+		zoneMap.narrowSearch(time, start, stop);
+	eventidx_t c = binarySearch(time, start, stop);
 
 	while (c > 0 && events->at(c).time >= time)
 		c--;
 	return c;
 }
 
-int TraceAnalyzer::findIndexAfter(const vtl::Time &time) const
+eventidx_t
+TraceAnalyzer::findIndexAfter(const vtl::CompactTime &time) const
 {
 	if (events->size() < 1)
 		return -1;
 
-	int end = events->size() - 1;
+	eventidx_t end = events->size() - 1;
 
 	/* Basic sanity checks */
 	if (time > events->at(end).time)
@@ -568,170 +601,236 @@ int TraceAnalyzer::findIndexAfter(const vtl::Time &time) const
 	if (time < events->at(0).time)
 		return 0;
 
-	int c = binarySearch(time, 0, end);
+	eventidx_t start = 0;
+	eventidx_t stop = end;
+	if (zoneMap.nrEvents() == events->size())
+		zoneMap.narrowSearch(time, start, stop);
+	eventidx_t c = binarySearch(time, start, stop);
 
 	while (c < end && events->at(c).time <= time)
 		c++;
 	return c;
 }
 
-int TraceAnalyzer::findFilteredIndexBefore(const vtl::Time &time) const
-{
-	if (filteredEvents.size() < 1)
-		return -1;
-
-	int end = filteredEvents.size() - 1;
-
-	/* Basic sanity checks */
-	if (time > filteredEvents.at(end)->time)
-		return end;
-	if (time < filteredEvents.at(0)->time)
-		return 0;
-
-	int c = binarySearchFiltered(time, 0, end);
-
-	while (c > 0 && filteredEvents.at(c)->time >= time)
-		c--;
-	return c;
-}
-
 const TraceEvent *TraceAnalyzer::findPreviousSchedEvent(const vtl::Time &time,
 							int pid,
-							int *index) const
+							eventidx_t *index) const
 {
-	int start = findIndexBefore(time);
-	int i;
+	eventidx_t start = findIndexBefore(time);
+	const EventIndexList *list;
+	eventidx_t i;
+	int pos;
 
 	if (start < 0)
 		return nullptr;
 
-	for (i = start; i >= 0; i--) {
-		const TraceEvent &event = events->at(i);
-		if (event.type == SCHED_SWITCH  &&
-		    generic_sched_switch_newpid(event) == pid) {
-			if (index != nullptr)
-				*index = i;
-			return &event;
+	/* If the trace is too large for the task index, we need to scan */
+	if (!eventIndex.hasTaskIndex()) {
+		for (i = start; i >= 0; i--) {
+			const TraceEvent &event = events->at(i);
+			const SchedRecord &rec = records->at(i);
+			if (event.type == SCHED_SWITCH && rec.isValid() &&
+			    rec.pid2 == pid) {
+				if (index != nullptr)
+					*index = i;
+				return &event;
+			}
 		}
+		return nullptr;
 	}
-	return nullptr;
+
+	list = eventIndex.taskEvents(pid, TaskEventIndex::ROLE_SWITCH_IN);
+	if (list == nullptr)
+		return nullptr;
+
+	pos = EventIndex::findLastBefore(*list, start);
+	if (pos < 0)
+		return nullptr;
+
+	i = list->at(pos);
+	if (index != nullptr)
+		*index = i;
+	return &events->at(i);
 }
 
 const TraceEvent *TraceAnalyzer::findNextSchedSleepEvent(const vtl::Time &time,
 							 int pid,
-							 int *index) const
+							 eventidx_t *index) const
 {
-	int start = findIndexAfter(time);
-	int i;
-	int s = events->size();
+	eventidx_t start = findIndexAfter(time);
+	const EventIndexList *list;
+	eventidx_t i, nr;
+	int pos, s;
 
 	if (start < 0)
 		return nullptr;
 
-	for (i = start; i < s; i++) {
-		const TraceEvent &event = events->at(i);
-		if (event.type == SCHED_SWITCH &&
-		    generic_sched_switch_oldpid(event) == pid &&
-		    !task_state_is_runnable(
-			    generic_sched_switch_state(event))) {
+	if (!eventIndex.hasTaskIndex()) {
+		nr = events->size();
+		for (i = start; i < nr; i++) {
+			const TraceEvent &event = events->at(i);
+			const SchedRecord &rec = records->at(i);
+			if (event.type == SCHED_SWITCH && rec.isValid() &&
+			    rec.pid == pid &&
+			    !task_state_is_runnable(rec.state())) {
+				if (index != nullptr)
+					*index = i;
+				return &event;
+			}
+		}
+		return nullptr;
+	}
+
+	list = eventIndex.taskEvents(pid, TaskEventIndex::ROLE_SWITCH_OUT);
+	if (list == nullptr)
+		return nullptr;
+
+	s = list->size();
+	for (pos = EventIndex::findFirstAfter(*list, start); pos < s; pos++) {
+		i = list->at(pos);
+		const SchedRecord &rec = records->at(i);
+		if (!task_state_is_runnable(rec.state())) {
 			if (index != nullptr)
 				*index = i;
-			return &event;
+			return &events->at(i);
 		}
 	}
 	return nullptr;
 }
 
-const TraceEvent *TraceAnalyzer::findFilteredEvent(int index,
-						   int *filterIndex) const
+/*
+ * Returns the event at index if it passes the filters, and sets *filterIndex to
+ * its position among the filtered events.
+ */
+const TraceEvent *TraceAnalyzer::findFilteredEvent(eventidx_t index,
+						   eventidx_t *filterIndex)
+	const
 {
-	const TraceEvent *eptr = &events->at(index);
-	vtl::Time time = eptr->time;
-	int s = filteredEvents.size();
-	int i;
-	int start = findFilteredIndexBefore(time);
-
-	if (start < 0)
+	if (!filteredEvents.test(index))
 		return nullptr;
-
-	for (i = start; i < s; i++) {
-		const TraceEvent *cptr = filteredEvents[i];
-		if (cptr == eptr) {
-			*filterIndex = i;
-			return cptr;
-		}
-		if (cptr->time > time)
-			break;
-	}
-	return nullptr;
+	*filterIndex = filteredEvents.rank(index);
+	return &events->at(index);
 }
 
-const TraceEvent *TraceAnalyzer::findPreviousWakEvent(int startidx,
+const TraceEvent *TraceAnalyzer::findPreviousWakEvent(eventidx_t startidx,
 						      int pid,
 						      event_t wanted,
-						      int *index) const
+						      eventidx_t *index) const
 {
-	int i;
-	int epid = 0;
+	const EventIndexList *list;
+	TaskEventIndex::role_t role;
+	eventidx_t i;
+	int pos;
 
-	if (startidx < 0 || startidx >= (int) events->size())
+	if (startidx < 0 || startidx >= events->size())
 		return nullptr;
 
-	if (wanted != SCHED_WAKEUP && wanted != SCHED_WAKEUP_NEW &&
-	    wanted != SCHED_WAKING)
+	if (wanted == SCHED_WAKEUP || wanted == SCHED_WAKEUP_NEW)
+		role = TaskEventIndex::ROLE_WAKEUP;
+	else if (wanted == SCHED_WAKING)
+		role = TaskEventIndex::ROLE_WAKING;
+	else
 		return nullptr;
 
-	for (i = startidx; i >= 0; i--) {
-		const TraceEvent &event = events->at(i);
-		if ((event.type == wanted ||
-		     (wanted == SCHED_WAKEUP &&
-		      event.type == SCHED_WAKEUP_NEW))) {
-			if (wanted == SCHED_WAKING)
-				epid = generic_sched_waking_pid(event);
-			else
-				epid = generic_sched_wakeup_pid(event);
-			if (epid != pid)
+	if (!eventIndex.hasTaskIndex()) {
+		for (i = startidx; i >= 0; i--) {
+			const TraceEvent &event = events->at(i);
+			if (event.type != wanted &&
+			    (wanted != SCHED_WAKEUP ||
+			     event.type != SCHED_WAKEUP_NEW))
+				continue;
+			const SchedRecord &rec = records->at(i);
+			if (!rec.isValid() || rec.pid != pid)
 				continue;
 			if (index != nullptr)
 				*index = i;
 			return &event;
 		}
+		return nullptr;
+	}
+
+	list = eventIndex.taskEvents(pid, role);
+	if (list == nullptr)
+		return nullptr;
+
+	/*
+	 * The ROLE_WAKEUP list has both sched_wakeup and sched_wakeup_new
+	 * events, if only sched_wakeup_new is wanted, we need to skip the
+	 * others.
+	 */
+	for (pos = EventIndex::findLastBefore(*list, startidx); pos >= 0;
+	     pos--) {
+		i = list->at(pos);
+		const TraceEvent &event = events->at(i);
+		if (event.type == wanted || wanted == SCHED_WAKEUP) {
+			if (index != nullptr)
+				*index = i;
+			return &event;
+		}
 	}
 	return nullptr;
 }
 
 const TraceEvent *TraceAnalyzer::findWakingEvent(const TraceEvent *wakeup,
-						 int *index) const
+						 eventidx_t *index) const
 {
-	int i;
-	int startidx = findIndexBefore(wakeup->time);
-	int wpid = generic_sched_wakeup_pid(*wakeup);
-	int pid;
+	const EventIndexList *list;
+	const EventIndexList *invalid;
+	eventidx_t startidx = findIndexBefore(wakeup->time);
+	eventidx_t i;
+	int wpid;
+	int pos, ipos;
 
-	if (wpid == INT_MAX)
+	if (!sched_wakeup_args_ok(getTraceType(), *wakeup))
 		return nullptr;
+	wpid = sched_wakeup_pid(getTraceType(), *wakeup);
 
-	if (startidx < 0 || startidx >= (int) events->size())
+	if (startidx < 0 || startidx >= events->size())
 		return nullptr;
 
-	for (i = startidx; i >= 0; i--) {
-		const TraceEvent &event = events->at(i);
-		if (event.type != SCHED_WAKING)
-			continue;
-		pid = generic_sched_waking_pid(event);
-		if (pid == wpid) {
-			if (index != nullptr)
-				*index = i;
-			return &event;
-		} else if (pid == INT_MAX) {
+	if (!eventIndex.hasTaskIndex()) {
+		for (i = startidx; i >= 0; i--) {
+			const TraceEvent &event = events->at(i);
+			if (event.type != SCHED_WAKING)
+				continue;
+			const SchedRecord &rec = records->at(i);
 			/*
 			 * If we encounter a single waking event where we
 			 * can not parse the arguments, then we give up
 			 */
-			return nullptr;
+			if (!rec.isValid())
+				return nullptr;
+			if (rec.pid == wpid) {
+				if (index != nullptr)
+					*index = i;
+				return &event;
+			}
 		}
+		return nullptr;
 	}
-	return nullptr;
+
+	list = eventIndex.taskEvents(wpid, TaskEventIndex::ROLE_WAKING);
+	if (list == nullptr)
+		return nullptr;
+
+	pos = EventIndex::findLastBefore(*list, startidx);
+	if (pos < 0)
+		return nullptr;
+	i = list->at(pos);
+
+	/*
+	 * If there is a waking event between the one that we found and the
+	 * wakeup, where we can not parse the arguments, then we give up
+	 * because it might have been the one that we are looking for.
+	 */
+	invalid = eventIndex.invalidWakingEvents();
+	ipos = EventIndex::findLastBefore(*invalid, startidx);
+	if (ipos >= 0 && invalid->at(ipos) > i)
+		return nullptr;
+
+	if (index != nullptr)
+		*index = i;
+	return &events->at(i);
 }
 
 void TraceAnalyzer::setSchedOffset(unsigned int cpu, double offset)
@@ -774,11 +873,6 @@ void TraceAnalyzer::setMigrationScale(double scale)
 	migrationScale = scale;
 }
 
-void TraceAnalyzer::setQCustomPlot(QCustomPlot *plot)
-{
-	customPlot = plot;
-}
-
 Task *TraceAnalyzer::findRealTask(int pid)
 {
 	Task *task = findTask(pid);
@@ -813,8 +907,10 @@ void TraceAnalyzer::addCpuFreqWork(unsigned int cpu,
 	CpuFreq *freq = cpuFreq + cpu;
 	freq->scale = scale;
 	freq->offset = offset;
+	if (freq->lod.isValid())
+		return;
 	WorkItem<CpuFreq> *freqItem = new WorkItem<CpuFreq>
-		(freq, &CpuFreq::doScale);
+		(freq, &CpuFreq::doLod);
 	list.append(freqItem);
 }
 
@@ -826,8 +922,10 @@ void TraceAnalyzer::addCpuIdleWork(unsigned int cpu,
 	CpuIdle *idle = cpuIdle + cpu;
 	idle->scale = scale;
 	idle->offset = offset;
+	if (idle->lod.isValid())
+		return;
 	WorkItem<CpuIdle> *idleItem = new WorkItem<CpuIdle>
-		(idle, &CpuIdle::doScale);
+		(idle, &CpuIdle::doLod);
 	list.append(idleItem);
 }
 
@@ -841,54 +939,50 @@ void TraceAnalyzer::addCpuSchedWork(unsigned int cpu,
 		CPUTask &task = iter.value();
 		task.scale = scale;
 		task.offset = offset;
+		iter++;
+		if (task.schedLod.isValid())
+			continue;
 		WorkItem<CPUTask> *taskItem = new WorkItem<CPUTask>
-			(&task, &CPUTask::doScale);
-		list.append(taskItem);
-		taskItem = new WorkItem<CPUTask>(&task,
-						 &CPUTask::doScaleDelay);
-		list.append(taskItem);
-		taskItem = new WorkItem<CPUTask>(&task,
-						 &CPUTask::doScaleRunning);
+			(&task, &CPUTask::doLod);
 		list.append(taskItem);
-		taskItem = new WorkItem<CPUTask>(&task,
-						 &CPUTask::doScalePreempted);
-		list.append(taskItem);
-		taskItem = new WorkItem<CPUTask>(&task,
-						 &CPUTask::doScaleUnint);
-		list.append(taskItem);
-		iter++;
 	}
 }
 
+static bool arrowTimeLess(const MigrationArrow &a, const MigrationArrow &b)
+{
+	return a.time < b.time;
+}
+
 /*
- * This function must be called from the application mainthread because it
- * creates objects that are children customPlot, which is created by the
- * mainthread
+ * This function builds the time sorted vector of arrows that are drawn by the
+ * MigrationGraph. The vector must not be modified while the MigrationGraph
+ * exists, so this should only be called after the plot has been cleared.
  */
 void TraceAnalyzer::scaleMigration()
 {
-	QList<Migration>::iterator iter;
-	double unit = migrationScale / getNrCPUs();
-	const int width = setstor->getValue(Setting::MIGRATION_WIDTH).intv();
-	for (iter = migrations.begin(); iter != migrations.end(); iter++) {
-		Migration &m = *iter;
-		double s = migrationOffset + (m.oldcpu + 1) * unit;
-		double e = migrationOffset + (m.newcpu + 1) * unit;
-		QColor color = getTaskColor(m.pid);
-		/*
-		 * The constructor will save a pointer to the MigrationArrow
-		 * object in the customPlot object.
-		 */
-		new MigrationArrow(s, e, m.time.toDouble(), color,
-				   customPlot, width);
+	QList<Migration>::const_iterator iter;
+	MigrationArrow arrow;
+
+	migrationArrows.resize(0);
+	migrationArrows.reserve(migrations.size());
+	for (iter = migrations.constBegin(); iter != migrations.constEnd();
+	     iter++) {
+		const Migration &m = *iter;
+		arrow.time = m.time.toDouble();
+		arrow.color = getTaskColor(m.pid).rgb();
+		arrow.oldcpu = m.oldcpu;
+		arrow.newcpu = m.newcpu;
+		migrationArrows.append(arrow);
 	}
+	if (!std::is_sorted(migrationArrows.constBegin(),
+			    migrationArrows.constEnd(), arrowTimeLess))
+		std::stable_sort(migrationArrows.begin(),
+				 migrationArrows.end(), arrowTimeLess);
 }
 
 bool TraceAnalyzer::enableMigrations()
 {
-	return (setstor->getValue(Setting::SHOW_MIGRATION_GRAPHS).boolv() &&
-		(setstor->getValue(Setting::SHOW_MIGRATION_UNLIMITED).boolv() ||
-		 migrations.size() < MAX_NR_MIGRATIONS));
+	return setstor->getValue(Setting::SHOW_MIGRATION_GRAPHS).boolv();
 }
 
 void TraceAnalyzer::doScale()
@@ -949,7 +1043,6 @@ void TraceAnalyzer::doStats()
 	}
 
 	statsQueue.start();
-	doLatencyStats();
 	statsQueue.wait();
 
 	s = workList.size();
@@ -979,13 +1072,75 @@ void TraceAnalyzer::doLimitedStats()
 		delete workList[i];
 }
 
+bool TaskStatsLimited::run()
+{
+	if (!control->isCanceled())
+		task->statsTimeLimited(start, end, cursorTime, cursorPct);
+	control->advance();
+	return false; /* No error */
+}
+
+/*
+ * Computes the time limited stats of all tasks for the interval [start, end]
+ * into stats. The tasks are not modified, so this can be done in a background
+ * job.
+ */
+void TraceAnalyzer::computeLimitedStats(QVector<TaskStatsLimited> &stats,
+					const vtl::Time &start,
+					const vtl::Time &end,
+					JobControl *control)
+{
+	QList<AbstractWorkItem*> workList;
+	int i, s;
+
+	stats.resize(taskMap.size());
+	control->setTotal(stats.size());
+
+	i = 0;
+	DEFINE_TASKMAP_ITERATOR(iter);
+	for(iter = taskMap.begin(); iter != taskMap.end(); iter++) {
+		TaskStatsLimited &ts = stats[i];
+		ts.task = iter.value().task;
+		ts.control = control;
+		ts.start = start;
+		ts.end = end;
+		i++;
+	}
+
+	s = stats.size();
+	for (i = 0; i < s; i++) {
+		WorkItem<TaskStatsLimited> *item =
+			new WorkItem<TaskStatsLimited>
+			(&stats[i], &TaskStatsLimited::run);
+		workList.append(item);
+		statsLimitedQueue.addWorkItem(item);
+	}
+	statsLimitedQueue.start();
+	statsLimitedQueue.wait();
+
+	for (i = 0; i < s; i++)
+		delete workList[i];
+}
+
+/* Stores the result of computeLimitedStats() in the tasks */
+void TraceAnalyzer::commitLimitedStats(const QVector<TaskStatsLimited> &stats)
+{
+	int i;
+	int s = stats.size();
+
+	for (i = 0; i < s; i++) {
+		stats[i].task->cursorTime = stats[i].cursorTime;
+		stats[i].task->cursorPct = stats[i].cursorPct;
+	}
+}
+
 void TraceAnalyzer::doLatencyStats()
 {
-	unsigned int place;
+	int64_t place;
 	LatencyCompFunc lcompfunc(Latency::CMP_CREATE_PLACE,
 				  Latency::ORDER_NORMAL, this);
-	const unsigned nrSchedLat = int2uint(schedLatencies.size());
-	const unsigned nrWakeLat = int2uint(wakeLatencies.size());
+	const int64_t nrSchedLat = schedLatencies.size();
+	const int64_t nrWakeLat = wakeLatencies.size();
 
 	vtl::heapsort<vtl::TList, Latency>(schedLatencies, lcompfunc);
 	for (place = 0; place < nrSchedLat; place++)
@@ -996,81 +1151,674 @@ void TraceAnalyzer::doLatencyStats()
 		wakeLatencies[place].place = place;
 }
 
-void TraceAnalyzer::processFtrace()
+/*
+ * Adds the range [begin, end) to the eventIndex and the zoneMap. If reserve is
+ * true, the range must extend to the end of the trace, and then the events in
+ * it are also counted per task and CPU, so that the vectors that
+ * processGeneric() will append to can be reserved to their final sizes. The
+ * counting is done in parallel, with each Prescan taking care of a subset of
+ * the CPUs.
+ */
+void TraceAnalyzer::prescanEvents(eventidx_t begin, eventidx_t end,
+				  bool reserve)
 {
-	processGeneric(TRACE_TYPE_FTRACE);
-}
+	QList<AbstractWorkItem*> workList;
+	WorkItem<EventIndex> *indexItems[3];
+	WorkItem<ZoneMap> *zoneItem;
+	Prescan *prescans = nullptr;
+	int nr = 0;
+	int i, s;
 
-void TraceAnalyzer::processPerf()
-{
-	processGeneric(TRACE_TYPE_PERF);
+	if (end <= begin)
+		return;
+
+	if (reserve) {
+		nr = QThread::idealThreadCount();
+		if (nr <= 0)
+			nr = 1;
+		prescans = new Prescan[nr];
+		for (i = 0; i < nr; i++) {
+			prescans[i].setRange(events, records, begin, end, i,
+					     nr);
+			WorkItem<Prescan> *item = new WorkItem<Prescan>
+				(&prescans[i], &Prescan::count);
+			workList.append(item);
+			processingQueue.addWorkItem(item);
+		}
+	}
+
+	eventIndex.setRange(events, records, begin, end);
+	indexItems[0] = new WorkItem<EventIndex>(&eventIndex,
+						 &EventIndex::buildCPUIndex);
+	indexItems[1] = new WorkItem<EventIndex>(&eventIndex,
+						 &EventIndex::buildTypeIndex);
+	indexItems[2] = new WorkItem<EventIndex>(&eventIndex,
+						 &EventIndex::buildTaskIndex);
+	for (i = 0; i < 3; i++) {
+		workList.append(indexItems[i]);
+		processingQueue.addWorkItem(indexItems[i]);
+	}
+
+	zoneMap.setRange(events, records, begin, end);
+	/* The pidEventLists are only valid for the events of the old range */
+	pidEventLists.clear();
+	zoneItem = new WorkItem<ZoneMap>(&zoneMap, &ZoneMap::build);
+	workList.append(zoneItem);
+	processingQueue.addWorkItem(zoneItem);
+
+	processingQueue.start();
+	processingQueue.wait();
+
+	if (reserve)
+		reservePrescanned(prescans, nr);
+
+	s = workList.size();
+	for (i = 0; i < s; i++)
+		delete workList[i];
+	delete[] prescans;
 }
 
-void TraceAnalyzer::processAllFilters()
+/*
+ * A wakeup latency needs a wakeup, but there may be one before the range that
+ * was counted, so one more is allowed for. The vectors of a task get one
+ * scheduling point more than those of a CPUTask, since a new task can get two
+ * points before its first switch. Both can get a tail.
+ */
+void TraceAnalyzer::reservePrescanned(const Prescan *prescans, int nr)
 {
-	int i;
-	int s = events->size();
-	const TraceEvent *eptr;
+	vtl::PidMap<PrescanCount> taskCounts;
+	vtl::PidMap<PrescanCount>::iterator iter;
+	unsigned int cpu;
+	int i, s;
 
-	filteredEvents.clear();
+	/* The task totals are needed for the wakeups of the CPUTasks */
+	for (i = 0; i < nr; i++) {
+		const Prescan &p = prescans[i];
 
-	for (i = 0; i < s; i++) {
-		const TraceEvent &event = events->at(i);
-		eptr = &event;
-		/* OR filters */
-		if (OR_filterState.isEnabled(FilterState::FILTER_CPU)) {
-			if (OR_filterCPUMap.contains(event.cpu)) {
-				filteredEvents.append(eptr);
+		for (iter = p.tasks.begin(); iter != p.tasks.end(); iter++)
+			taskCounts[iter.key()].nrWakeup +=
+				iter.value().nrWakeup;
+
+		s = p.cpuTasks.size();
+		for (cpu = 0; cpu < (unsigned int) s; cpu++) {
+			const vtl::PidMap<PrescanCount> *map = p.cpuTasks[cpu];
+			if (map == nullptr)
 				continue;
+			for (iter = map->begin(); iter != map->end(); iter++) {
+				const PrescanCount &c = iter.value();
+				PrescanCount &t = taskCounts[iter.key()];
+				t.nrIn += c.nrIn;
+				t.nrOut += c.nrOut;
+				t.nrPreempted += c.nrPreempted;
+				t.nrRunning += c.nrRunning;
+				t.nrUnint += c.nrUnint;
 			}
 		}
-		if (OR_filterState.isEnabled(FilterState::FILTER_PID) &&
-		    !processPidFilter(event, OR_filterPidMap,
-				      OR_pidFilterInclusive)) {
-			filteredEvents.append(eptr);
-			continue;
-		}
-		if (OR_filterState.isEnabled(FilterState::FILTER_EVENT)) {
-			if (OR_filterEventMap.contains(event.type) ) {
-				filteredEvents.append(eptr);
+	}
+
+	for (i = 0; i < nr; i++) {
+		const Prescan &p = prescans[i];
+
+		s = p.cpuTasks.size();
+		for (cpu = 0; cpu < (unsigned int) s; cpu++) {
+			const vtl::PidMap<PrescanCount> *map = p.cpuTasks[cpu];
+			if (map == nullptr)
 				continue;
+			for (iter = map->begin(); iter != map->end(); iter++) {
+				const PrescanCount &c = iter.value();
+				const PrescanCount &t = taskCounts[iter.key()];
+				cpuTaskMaps[cpu][iter.key()].reserve(
+					c, 2, qMin(c.nrIn, t.nrWakeup + 1));
 			}
 		}
-		if (OR_filterState.isEnabled(FilterState::FILTER_TIME)) {
-			if (event.time >= OR_filterTimeLow &&
-			    event.time <= OR_filterTimeHigh) {
-				filteredEvents.append(eptr);
-				continue;
-			}
+
+		/* The frequency graphs also get a tail */
+		s = p.nrFreq.size();
+		for (cpu = 0; cpu < (unsigned int) s; cpu++) {
+			CpuFreq &freq = cpuFreq[cpu];
+			prescanReserve(freq.timev, p.nrFreq[cpu] + 1);
+			prescanReserve(freq.data, p.nrFreq[cpu] + 1);
 		}
-		if (OR_filterState.isEnabled(FilterState::FILTER_REGEX)) {
-			if (processRegexFilter(event, OR_filterRegex)) {
-				filteredEvents.append(eptr);
-				continue;
-			}
+
+		s = p.nrIdle.size();
+		for (cpu = 0; cpu < (unsigned int) s; cpu++) {
+			CpuIdle &idle = cpuIdle[cpu];
+			prescanReserve(idle.timev, p.nrIdle[cpu]);
+			prescanReserve(idle.data, p.nrIdle[cpu]);
 		}
-		/* AND filters */
-		if (filterState.isEnabled(FilterState::FILTER_CPU) &&
-		    !filterCPUMap.contains(event.cpu)) {
+	}
+
+	for (iter = taskCounts.begin(); iter != taskCounts.end(); iter++) {
+		const PrescanCount &t = iter.value();
+		if (t.nrIn == 0 && t.nrOut == 0)
 			continue;
+		Task &task = taskMap[iter.key()].getTask();
+		task.reserve(t, 3, qMin(t.nrIn, t.nrWakeup + 1));
+	}
+}
+
+bool TraceAnalyzer::processFtrace(eventidx_t limit)
+{
+	return processGeneric<TRACE_TYPE_FTRACE>(limit);
+}
+
+bool TraceAnalyzer::processPerf(eventidx_t limit)
+{
+	return processGeneric<TRACE_TYPE_PERF>(limit);
+}
+
+/*
+ * Returns true if the event passes the filters. The OR filters are checked
+ * first, if any of them matches, then the event passes regardless of the AND
+ * filters.
+ */
+vtl_always_inline bool TraceAnalyzer::filterEvent(const TraceEvent &event,
+						  const SchedRecord &rec)
+{
+	/* OR filters */
+	if (compiledFilter.orSet.anyMatch(event, rec))
+		return true;
+	if (OR_filterState.isEnabled(FilterState::FILTER_REGEX)) {
+		if (processRegexFilter(event, OR_filterRegex))
+			return true;
+	}
+	/* AND filters */
+	if (!compiledFilter.andSet.allMatch(event, rec))
+		return false;
+	if (filterState.isEnabled(FilterState::FILTER_REGEX) &&
+	    !processRegexFilter(event, filterRegex))
+		return false;
+	return true;
+}
+
+/*
+ * Returns the selection bitmap of the nr <= 64 events from begin, bit k is set
+ * if event begin + k passes the filters. The compiledFilter takes care of all
+ * filters but the regex filters, which are only evaluated for the events where
+ * they can make a difference.
+ */
+vtl_always_inline uint64_t TraceAnalyzer::selectEvents(eventidx_t begin,
+						       int nr)
+{
+	uint64_t orWord, andWord;
+	uint64_t sel, pending, m, bit;
+
+	compiledFilter.evaluate(events, records, begin, nr, &orWord,
+				&andWord);
+	sel = orWord;
+	pending = andWord & ~orWord;
+
+	if (filterState.isEnabled(FilterState::FILTER_REGEX)) {
+		for (m = pending; m != 0; m &= m - 1) {
+			bit = m & -m;
+			if (!processRegexFilter(events->at(begin + vtl_ctz64(m)),
+						filterRegex))
+				pending &= ~bit;
 		}
-		if (filterState.isEnabled(FilterState::FILTER_PID) &&
-		    processPidFilter(event, filterPidMap,
-				     pidFilterInclusive)) {
-			continue;
+	}
+	sel |= pending;
+
+	if (OR_filterState.isEnabled(FilterState::FILTER_REGEX)) {
+		m = nr < 64 ? (UINT64_C(1) << nr) - 1 : ~UINT64_C(0);
+		for (m &= ~sel; m != 0; m &= m - 1) {
+			bit = m & -m;
+			if (processRegexFilter(events->at(begin + vtl_ctz64(m)),
+					       OR_filterRegex))
+				sel |= bit;
 		}
-		if (filterState.isEnabled(FilterState::FILTER_EVENT) &&
-		    !filterEventMap.contains(event.type)) {
-			continue;
+	}
+	return sel;
+}
+
+/*
+ * Translates the filter maps to the bitmaps of the compiledFilter. This is done
+ * every time the filters are processed, since it's cheap compared to
+ * processing the events.
+ */
+void TraceAnalyzer::compileFilterSet(CompiledFilterSet &set,
+				     const FilterState &state,
+				     const QMap<unsigned, unsigned> &cpuMap,
+				     const QMap<int, int> &pidMap,
+				     const QMap<event_t, event_t> &eventMap,
+				     bool inclusive,
+				     const vtl::CompactTime &low,
+				     const vtl::CompactTime &high)
+{
+	set.clear();
+	if (state.isEnabled(FilterState::FILTER_CPU)) {
+		set.cpuEnabled = true;
+		set.cpus.setKeys(cpuMap);
+	}
+	if (state.isEnabled(FilterState::FILTER_PID)) {
+		set.pidEnabled = true;
+		set.pidInclusive = inclusive;
+		set.pids.setKeys(pidMap);
+	}
+	if (state.isEnabled(FilterState::FILTER_EVENT)) {
+		set.eventEnabled = true;
+		set.types.setKeys(eventMap);
+	}
+	if (state.isEnabled(FilterState::FILTER_TIME)) {
+		set.timeEnabled = true;
+		set.timeLow = low;
+		set.timeHigh = high;
+	}
+}
+
+void TraceAnalyzer::compileFilters()
+{
+	CompiledFilterSet &o = compiledFilter.orSet;
+
+	compileFilterSet(compiledFilter.andSet, filterState, filterCPUMap,
+			 filterPidMap, filterEventMap, pidFilterInclusive,
+			 filterTimeLow, filterTimeHigh);
+	compileFilterSet(o, OR_filterState, OR_filterCPUMap,
+			 OR_filterPidMap, OR_filterEventMap,
+			 OR_pidFilterInclusive, OR_filterTimeLow,
+			 OR_filterTimeHigh);
+	compiledFilter.orEnabled = o.cpuEnabled || o.pidEnabled ||
+		o.eventEnabled || o.timeEnabled;
+
+	if (filterState.isEnabled(FilterState::FILTER_REGEX))
+		buildRegexCaches(filterRegex);
+	if (OR_filterState.isEnabled(FilterState::FILTER_REGEX))
+		buildRegexCaches(OR_filterRegex);
+}
+
+/*
+ * If there are no OR filters and there is a CPU or an event filter, then only
+ * the events of the selected CPUs or event types can pass the filters. In that
+ * case we get the candidates from the eventIndex and return true, so that the
+ * caller doesn't need to check all events.
+ */
+bool TraceAnalyzer::filterCandidates(QVector<eventidx_t> &candidates) const
+{
+	QVector<const EventIndexList*> lists;
+	const EventIndexList *list;
+	int64_t total = 0;
+	int i, s;
+
+	if (OR_filterState.isEnabled())
+		return false;
+
+	if (filterState.isEnabled(FilterState::FILTER_CPU) &&
+	    eventIndex.hasCPUIndex()) {
+		QMap<unsigned, unsigned>::const_iterator iter;
+		for (iter = filterCPUMap.begin(); iter != filterCPUMap.end();
+		     iter++) {
+			list = eventIndex.cpuEvents(iter.key());
+			if (list != nullptr)
+				lists.append(list);
 		}
-		if (filterState.isEnabled(FilterState::FILTER_TIME) &&
-		    (event.time < filterTimeLow || event.time > filterTimeHigh))
-			continue;
-		if (filterState.isEnabled(FilterState::FILTER_REGEX) &&
-		    !processRegexFilter(event, filterRegex))
+	} else if (filterState.isEnabled(FilterState::FILTER_EVENT) &&
+		   eventIndex.hasTypeIndex()) {
+		QMap<event_t, event_t>::const_iterator iter;
+		for (iter = filterEventMap.begin();
+		     iter != filterEventMap.end(); iter++) {
+			list = eventIndex.typeEvents(iter.key());
+			if (list != nullptr)
+				lists.append(list);
+		}
+	} else {
+		return false;
+	}
+
+	s = lists.size();
+	/* The candidates have the same size limit as the lists */
+	for (i = 0; i < s; i++)
+		total += lists[i]->size();
+	if (total > EVENTINDEX_MAX_LIST_SIZE)
+		return false;
+
+	candidates.reserve((int) total);
+	for (i = 0; i < s; i++)
+		candidates += *lists[i];
+	if (s > 1)
+		std::sort(candidates.begin(), candidates.end());
+	return true;
+}
+
+/*
+ * The chunks of the filteredEvents are the same as the blocks of the zoneMap,
+ * so that the chunks of the blocks that cannot pass can be left empty.
+ */
+#if ZONEMAP_BLOCK_SHIFT != RANKBITMAP_CHUNK_SHIFT
+#error "The ZoneMap blocks must have the same size as the RankBitmap chunks"
+#endif
+
+void TraceAnalyzer::processAllFilters()
+{
+	if (deferFilters) {
+		filterPending = true;
+		return;
+	}
+	filterEvents(filteredEvents, nullptr);
+	filterPending = false;
+}
+
+/*
+ * Processes the filters for all events and stores the result in bitmap. This
+ * may be called from a background job, in which case the filters must not be
+ * changed until it has returned. If the control is canceled, then the bitmap
+ * is left incomplete.
+ */
+void TraceAnalyzer::filterEvents(vtl::RankBitmap &bitmap, JobControl *control)
+{
+	QVector<eventidx_t> candidates;
+	QVector<FilterJob> jobs;
+	QList<AbstractWorkItem*> workList;
+	int i, nr, s;
+
+	bitmap.resize(events->size());
+	compileFilters();
+
+	if (filterCandidates(candidates)) {
+		refilterEvents(bitmap, candidates);
+		bitmap.updateRanks();
+		return;
+	}
+
+	nr = QThread::idealThreadCount();
+	if (nr <= 0)
+		nr = 1;
+	if (nr > bitmap.nrChunks())
+		nr = qMax(bitmap.nrChunks(), 1);
+	jobs.resize(nr);
+	if (control != nullptr)
+		control->setTotal(bitmap.nrChunks());
+
+	for (i = 0; i < nr; i++) {
+		jobs[i].analyzer = this;
+		jobs[i].bitmap = &bitmap;
+		jobs[i].control = control;
+		jobs[i].index = i;
+		jobs[i].nr = nr;
+		WorkItem<FilterJob> *item = new WorkItem<FilterJob>
+			(&jobs[i], &FilterJob::run);
+		workList.append(item);
+		filterQueue.addWorkItem(item);
+	}
+	filterQueue.start();
+	filterQueue.wait();
+
+	s = workList.size();
+	for (i = 0; i < s; i++)
+		delete workList[i];
+	if (control == nullptr || !control->isCanceled())
+		bitmap.updateRanks();
+}
+
+/*
+ * Takes the result of filterEvents() into use as the filteredEvents. The
+ * bitmap is left with the previous filteredEvents.
+ */
+void TraceAnalyzer::commitFilteredEvents(vtl::RankBitmap &bitmap)
+{
+	filteredEvents.swap(bitmap);
+	filterPending = false;
+}
+
+void TraceAnalyzer::setDeferFilters(bool defer)
+{
+	deferFilters = defer;
+}
+
+bool TraceAnalyzer::filterChunks(vtl::RankBitmap &bitmap, JobControl *control,
+				 int index, int nr)
+{
+	QVector<uint64_t> words(RANKBITMAP_CHUNK_WORDS);
+	int c;
+	int s = bitmap.nrChunks();
+
+	for (c = index; c < s; c += nr) {
+		if (control != nullptr) {
+			if (control->isCanceled())
+				break;
+			control->advance();
+		}
+		filterChunk(bitmap, c, words.data());
+	}
+	return false; /* No error */
+}
+
+void TraceAnalyzer::filterChunk(vtl::RankBitmap &bitmap, int c,
+				uint64_t *words)
+{
+	eventidx_t begin = (eventidx_t) c << RANKBITMAP_CHUNK_SHIFT;
+	eventidx_t end = qMin(begin + RANKBITMAP_CHUNK_SIZE, events->size());
+	eventidx_t k;
+	int w;
+
+	for (w = 0; w < RANKBITMAP_CHUNK_WORDS; w++)
+		words[w] = 0;
+
+	/*
+	 * With only AND filters, an event can only pass if its block can pass,
+	 * so the blocks that the zoneMap rules out can be skipped.
+	 */
+	if (!OR_filterState.isEnabled() && end <= zoneMap.nrEvents() &&
+	    !blockCanPass(zoneMap.block(c))) {
+		bitmap.setChunk(c, words);
+		return;
+	}
+
+	for (k = begin, w = 0; k < end; k += 64, w++)
+		words[w] = selectEvents(k, (int) qMin(end - k,
+						      (eventidx_t) 64));
+	bitmap.setChunk(c, words);
+}
+
+/*
+ * Processes the filters for the events in list, which must be sorted, and
+ * updates their bits in the bitmap. The caller must make sure that the
+ * events that are not in the list cannot be affected by the change of the
+ * filters. The ranks of the bitmap are not updated.
+ */
+void TraceAnalyzer::refilterEvents(vtl::RankBitmap &bitmap,
+				   const EventIndexList &list)
+{
+	QVector<uint64_t> words(RANKBITMAP_CHUNK_WORDS);
+	uint64_t bit, old;
+	eventidx_t i;
+	int j, pos;
+	int c = -1;
+	int s = list.size();
+	bool dirty = false;
+
+	for (j = 0; j < s; j++) {
+		i = list[j];
+		if ((int) (i >> RANKBITMAP_CHUNK_SHIFT) != c) {
+			if (dirty)
+				bitmap.setChunk(c, words.data());
+			c = (int) (i >> RANKBITMAP_CHUNK_SHIFT);
+			bitmap.getChunk(c, words.data());
+			dirty = false;
+		}
+		pos = (int) (i & (RANKBITMAP_CHUNK_SIZE - 1));
+		uint64_t &word = words[pos / 64];
+		bit = UINT64_C(1) << (pos % 64);
+		old = word & bit;
+		if (filterEvent(events->at(i), records->at(i)))
+			word |= bit;
+		else
+			word &= ~bit;
+		if ((word & bit) != old)
+			dirty = true;
+	}
+	if (dirty)
+		bitmap.setChunk(c, words.data());
+}
+
+/*
+ * Returns the indices of the events where pid is the pid of the event or one
+ * of the pids of the SchedRecord. These are the only events that can be
+ * affected by adding pid to, or removing it from, a pid filter. The lists are
+ * built on demand from the blocks of the zoneMap that may have the pid.
+ * Returns nullptr if the blocks may have more events than an EventIndexList
+ * can hold.
+ */
+const EventIndexList *TraceAnalyzer::pidFilterEvents(int pid)
+{
+	vtl::PidMap<EventIndexList>::iterator iter = pidEventLists.find(pid);
+	eventidx_t i, begin, end;
+	int64_t maxSize = 0;
+	int b, nr;
+	bool isNew;
+
+	if (iter != pidEventLists.end())
+		return &iter.value();
+
+	nr = zoneMap.nrBlocks();
+	for (b = 0; b < nr; b++) {
+		if (zoneMap.block(b).mayHavePid(pid))
+			maxSize += ZONEMAP_BLOCK_SIZE;
+	}
+	if (maxSize > EVENTINDEX_MAX_LIST_SIZE)
+		return nullptr;
+
+	EventIndexList &list = pidEventLists.findValue(pid, isNew);
+	for (b = 0; b < nr; b++) {
+		if (!zoneMap.block(b).mayHavePid(pid))
 			continue;
-		filteredEvents.append(eptr);
+		begin = ZoneMap::blockBegin(b);
+		end = qMin(ZoneMap::blockBegin(b + 1), zoneMap.nrEvents());
+		for (i = begin; i < end; i++) {
+			const TraceEvent &event = events->at(i);
+			const SchedRecord &rec = records->at(i);
+			if (event.pid == pid ||
+			    (rec.isValid() &&
+			     (rec.pid == pid || rec.pid2 == pid)))
+				list.append(i);
+		}
+	}
+	return &list;
+}
+
+/*
+ * Updates the filteredEvents incrementally after the pid filters have changed
+ * for the pids. Returns false if this could not be done, in which case the
+ * caller needs to call processAllFilters().
+ */
+bool TraceAnalyzer::refilterPids(const QVector<int> &pids)
+{
+	EventIndexList list;
+	const EventIndexList *pidList;
+	int64_t total = 0;
+	int i;
+	int s = pids.size();
+
+	if (!filterState.isEnabled() || filterPending ||
+	    filteredEvents.size() != events->size() ||
+	    zoneMap.nrEvents() != events->size())
+		return false;
+
+	/* If many events are affected, it's faster to process all of them */
+	for (i = 0; i < s; i++) {
+		pidList = pidFilterEvents(pids[i]);
+		if (pidList == nullptr)
+			return false;
+		total += pidList->size();
+		if (total > events->size() / 4 ||
+		    total > EVENTINDEX_MAX_LIST_SIZE)
+			return false;
+	}
+
+	list.reserve((int) total);
+	for (i = 0; i < s; i++)
+		list += *pidFilterEvents(pids[i]);
+	if (s > 1) {
+		std::sort(list.begin(), list.end());
+		list.erase(std::unique(list.begin(), list.end()), list.end());
+	}
+
+	compileFilters();
+	refilterEvents(filteredEvents, list);
+	filteredEvents.updateRanks();
+	return true;
+}
+
+/* Stores the keys that are in only one of a and b in diff */
+void TraceAnalyzer::diffPidMaps(const QMap<int, int> &a,
+				const QMap<int, int> &b,
+				QVector<int> &diff)
+{
+	QMap<int, int>::const_iterator ia = a.begin();
+	QMap<int, int>::const_iterator ib = b.begin();
+
+	while (ia != a.end() || ib != b.end()) {
+		if (ib == b.end() || (ia != a.end() && ia.key() < ib.key())) {
+			diff.append(ia.key());
+			ia++;
+		} else if (ia == a.end() || ib.key() < ia.key()) {
+			diff.append(ib.key());
+			ib++;
+		} else {
+			ia++;
+			ib++;
+		}
+	}
+}
+
+/*
+ * Returns false if the AND filters are certain to filter out all events of the
+ * block. The regex filter cannot be checked against the block, so it's the
+ * other filters that need to rule out the block.
+ */
+bool TraceAnalyzer::blockCanPass(const EventBlockSummary &block) const
+{
+	bool found;
+
+	if (filterState.isEnabled(FilterState::FILTER_TIME) &&
+	    !block.overlaps(filterTimeLow, filterTimeHigh))
+		return false;
+
+	if (filterState.isEnabled(FilterState::FILTER_CPU)) {
+		QMap<unsigned, unsigned>::const_iterator iter;
+		found = false;
+		for (iter = filterCPUMap.begin(); iter != filterCPUMap.end();
+		     iter++) {
+			if (block.cpus.test(iter.key())) {
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+			return false;
+	}
+
+	if (filterState.isEnabled(FilterState::FILTER_EVENT)) {
+		QMap<event_t, event_t>::const_iterator iter;
+		found = false;
+		for (iter = filterEventMap.begin();
+		     iter != filterEventMap.end(); iter++) {
+			if ((int) iter.key() >= 0 &&
+			    block.types.test((unsigned int) iter.key())) {
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+			return false;
+	}
+
+	/*
+	 * The bloom filter has the pids of both the events and the
+	 * SchedRecords, so it works for inclusive pid filters too.
+	 */
+	if (filterState.isEnabled(FilterState::FILTER_PID)) {
+		QMap<int, int>::const_iterator iter;
+		found = false;
+		for (iter = filterPidMap.begin(); iter != filterPidMap.end();
+		     iter++) {
+			if (block.mayHavePid(iter.key())) {
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+			return false;
 	}
+	return true;
 }
 
 void TraceAnalyzer::createPidFilter(QMap<int, int> &map,
@@ -1087,6 +1835,21 @@ void TraceAnalyzer::createPidFilter(QMap<int, int> &map,
 		return;
 	}
 
+	/*
+	 * If only the pids have changed, then only the events of the pids that
+	 * were added or removed need to be processed again.
+	 */
+	const FilterState &state = orlogic ? OR_filterState : filterState;
+	bool oldInclusive = orlogic ? OR_pidFilterInclusive :
+		pidFilterInclusive;
+	bool incremental = state.isEnabled(FilterState::FILTER_PID) &&
+		oldInclusive == inclusive;
+	QVector<int> changed;
+
+	if (incremental)
+		diffPidMaps(orlogic ? OR_filterPidMap : filterPidMap, map,
+			    changed);
+
 	if (orlogic) {
 		OR_pidFilterInclusive = inclusive;
 		OR_filterPidMap = map;
@@ -1096,26 +1859,42 @@ void TraceAnalyzer::createPidFilter(QMap<int, int> &map,
 		filterPidMap = map;
 		filterState.enable(FilterState::FILTER_PID);
 	}
-	if (filterState.isEnabled())
-		processAllFilters();
+	if (filterState.isEnabled()) {
+		if (!incremental || !refilterPids(changed))
+			processAllFilters();
+	}
 }
 
 bool TraceAnalyzer::updatePidFilter(bool inclusive)
 {
 	bool changed = false;
 	bool or_changed = false;
+	QVector<int> pids;
+	DEFINE_FILTER_PIDMAP_ITERATOR(iter);
 
 	if (OR_filterState.isEnabled(FilterState::FILTER_PID)) {
 		or_changed = OR_pidFilterInclusive != inclusive;
 		OR_pidFilterInclusive = inclusive;
+		if (or_changed) {
+			for (iter = OR_filterPidMap.begin();
+			     iter != OR_filterPidMap.end(); iter++)
+				pids.append(iter.key());
+		}
 	}
 	if (filterState.isEnabled(FilterState::FILTER_PID)) {
 		changed = pidFilterInclusive != inclusive;
 		pidFilterInclusive = inclusive;
+		if (changed) {
+			for (iter = filterPidMap.begin();
+			     iter != filterPidMap.end(); iter++)
+				pids.append(iter.key());
+		}
 	}
 	changed = changed || or_changed;
 	if (filterState.isEnabled() && changed) {
-		processAllFilters();
+		/* Only the events of the pids in the filters are affected */
+		if (!refilterPids(pids))
+			processAllFilters();
 		return true;
 	}
 	return false;
@@ -1221,7 +2000,7 @@ int TraceAnalyzer::compileRegex(RegexFilter &filter)
 	QVector<Regex> &regvec = filter.regvec;
 	int s = regvec.size();
 	int i;
-	const char *rstr;
+	QByteArray rstr;
 	const int sflags = REG_NEWLINE | REG_NOSUB;
 	int cflags;
 	int ecode = 0;
@@ -1230,17 +2009,19 @@ int TraceAnalyzer::compileRegex(RegexFilter &filter)
 	for (i = 0; i < s; i++) {
 		cflags = sflags;
 		Regex &rx = regvec[i];
-		rstr = rx.text.toLocal8Bit().data();
+		rstr = rx.text.toLocal8Bit();
 		if (rx.isExtended)
 			cflags |= REG_EXTENDED;
 		if (!rx.caseSensitive)
 			cflags |= REG_ICASE;
-		ecode = regcomp(&rx.regex, rstr, cflags);
+		ecode = regcomp(&rx.regex, rstr.constData(), cflags);
 		rx.regex_valid = (ecode == 0);
+		rx.cache = nullptr;
 		if (ecode != 0) {
 			filter.valid = false;
 			break;
 		}
+		rx.analyzeLiteral();
 	}
 	return ecode;
 }
@@ -1252,9 +2033,50 @@ void TraceAnalyzer::freeRegex(RegexFilter &filter)
 	int i;
 
 	for (i = 0; i < s; i++) {
-		Regex rx = regvec[i];
+		Regex &rx = regvec[i];
 		if (rx.regex_valid)
 			regfree(&rx.regex);
+		delete rx.cache;
+		rx.cache = nullptr;
+	}
+}
+
+/*
+ * Evaluates each regex once for every unique argument string, so that the
+ * filtering only needs to look up the result. The parser interns the
+ * arguments in its pool, which is complete only after the whole trace has
+ * been parsed, so before that we let the regexes run without a cache. The
+ * arguments that the pool has not interned, because of its cutoff, are not
+ * found in the cache and are matched by running the regex.
+ */
+void TraceAnalyzer::buildRegexCaches(RegexFilter &filter)
+{
+	QVector<Regex> &regvec = filter.regvec;
+	const StringPool<> *pool;
+	RegexMatchCache *cache;
+	int s = regvec.size();
+	int i;
+
+	if (!processEOF)
+		return;
+	pool = parser->getArgPool();
+	if (pool == nullptr)
+		return;
+
+	for (i = 0; i < s; i++) {
+		Regex &rx = regvec[i];
+		if (!rx.regex_valid)
+			continue;
+		if (rx.cache != nullptr && rx.cache->nrStrings == pool->size())
+			continue;
+		delete rx.cache;
+		rx.cache = nullptr;
+		cache = new RegexMatchCache(pool->size());
+		auto add = [&rx, cache](const TString *str) {
+			cache->add(str, rx.matchString(str));
+		};
+		pool->forEachString(add);
+		rx.cache = cache;
 	}
 }
 
@@ -1289,10 +2111,12 @@ void TraceAnalyzer::disableFilter(FilterState::filter_t filter)
 	}
 	filterState.disable(filter);
 	OR_filterState.disable(filter);
-	if (filterState.isEnabled())
+	if (filterState.isEnabled()) {
 		processAllFilters();
-	else
+	} else {
 		filteredEvents.clear();
+		filterPending = false;
+	}
 }
 
 void TraceAnalyzer::addPidToFilter(int pid) {
@@ -1313,6 +2137,9 @@ epilogue:
 		return;
 	}
 
+	if (filterState.isEnabled(FilterState::FILTER_PID) &&
+	    refilterPids(QVector<int>(1, pid)))
+		return;
 	filterState.enable(FilterState::FILTER_PID);
 	processAllFilters();
 }
@@ -1333,7 +2160,8 @@ void TraceAnalyzer::removePidFromFilter(int pid) {
 		disableFilter(FilterState::FILTER_PID);
 		return;
 	}
-	processAllFilters();
+	if (!refilterPids(QVector<int>(1, pid)))
+		processAllFilters();
 }
 
 void TraceAnalyzer::disableAllFilters()
@@ -1355,6 +2183,7 @@ void TraceAnalyzer::disableAllFilters()
 	OR_filterRegex.regvec.clear();
 
 	filteredEvents.clear();
+	filterPending = false;
 }
 
 bool TraceAnalyzer::isFiltered() const
@@ -1417,22 +2246,28 @@ event_t TraceAnalyzer::determineCPUEvent(bool &ok)
 	return rval;
 }
 
+/*
+ * Exports the events that are set in selection, or all events if selection is
+ * nullptr.
+ */
 bool TraceAnalyzer::exportTraceFile(const char *fileName, int *ts_errno,
-				    exporttype_t export_type)
+				    exporttype_t export_type,
+				    const vtl::RankBitmap *selection,
+				    JobControl *control)
 {
 	bool isFtrace = false, isPerf = false;
 	char *wbuf, *wb;
 	int fd;
 	int written, written_io, space, write_rval, wrote;
-	int nr_elements;
-	int idx;
+	eventidx_t nr_elements;
+	eventidx_t idx;
 	const TraceEvent *eptr;
 	bool rval = true;
 	event_t cpuevent_type = (event_t) 0;
 	bool ok;
-	bool filtered = isFiltered();
+	bool filtered = selection != nullptr;
 
-	nr_elements = filtered ? filteredEvents.size() : events->size();
+	nr_elements = filtered ? selection->count() : events->size();
 	*ts_errno = 0;
 
 	if (!isOpen()) {
@@ -1496,8 +2331,22 @@ bool TraceAnalyzer::exportTraceFile(const char *fileName, int *ts_errno,
 		wb = wbuf;
 
 		while (idx < nr_elements && written < WRITE_BUFFER_LIMIT) {
+			/*
+			 * Skip the blocks that don't have any events of the
+			 * cpu cycles type.
+			 */
+			if (!filtered &&
+			    export_type == EXPORT_TYPE_CPU_CYCLES &&
+			    (idx & (ZONEMAP_BLOCK_SIZE - 1)) == 0 &&
+			    idx + ZONEMAP_BLOCK_SIZE <= zoneMap.nrEvents() &&
+			    (int) cpuevent_type >= 0 &&
+			    !zoneMap.block(idx >> ZONEMAP_BLOCK_SHIFT).types.test(
+				    (unsigned int) cpuevent_type)) {
+				idx += ZONEMAP_BLOCK_SIZE;
+				continue;
+			}
 			if (filtered)
-				eptr = filteredEvents[idx];
+				eptr = &(*events)[selection->select(idx)];
 			else
 				eptr = &(*events)[idx];
 			idx++;
@@ -1528,6 +2377,14 @@ bool TraceAnalyzer::exportTraceFile(const char *fileName, int *ts_errno,
 				}
 			} while(written_io < written);
 		}
+		if (control != nullptr) {
+			control->setProgress(idx, nr_elements);
+			if (control->isCanceled()) {
+				rval = false;
+				*ts_errno = - TS_ERROR_ABORT;
+				goto error_close;
+			}
+		}
 	} while(idx < nr_elements);
 
 	if (!parser->traceFile->isIntact(ts_errno)) {
@@ -1551,6 +2408,9 @@ error_close:
 			*ts_errno = errno;
 		}
 	}
+	/* Don't leave a partial file behind if the export was canceled */
+	if (!rval && *ts_errno == - TS_ERROR_ABORT)
+		unlink(fileName);
 
 error_munmap:
 	parser->traceFile->freeMmap();
@@ -1561,15 +2421,16 @@ error_munmap:
 }
 
 bool TraceAnalyzer::exportLatencies(exportformat_t format, latencytype_t type,
-				    const char *fileName, int *ts_errno)
+				    const char *fileName, int *ts_errno,
+				    JobControl *control)
 {
 	const char *sep = nullptr;
 	const vtl::TList<Latency> *latencies = nullptr;
 	char *wbuf = nullptr;
 	char *wb = nullptr;
 	int written, written_io, space, write_rval, wrote;
-	int nr_elements;
-	int idx;
+	int64_t nr_elements;
+	int64_t idx;
 	const Latency *lptr;
 	bool rval = true;
 	int fd;
@@ -1650,6 +2511,14 @@ bool TraceAnalyzer::exportLatencies(exportformat_t format, latencytype_t type,
 				}
 			} while(written_io < written);
 		}
+		if (control != nullptr) {
+			control->setProgress(idx, nr_elements);
+			if (control->isCanceled()) {
+				rval = false;
+				*ts_errno = - TS_ERROR_ABORT;
+				goto error_close;
+			}
+		}
 	} while(idx < nr_elements);
 
 error_close:
@@ -1659,6 +2528,9 @@ error_close:
 			*ts_errno = errno;
 		}
 	}
+	/* Don't leave a partial file behind if the export was canceled */
+	if (!rval && *ts_errno == - TS_ERROR_ABORT)
+		unlink(fileName);
 
 error_munmap:
 	if (munmap(wbuf, WRITE_BUFFER_SIZE) != 0)
@@ -1757,7 +2629,7 @@ int TraceAnalyzer::writePerfEvent(char *wb, int *space, const TraceEvent *eptr,
 }
 
 int TraceAnalyzer::writeLatency(char *wb, int *space, const Latency *lptr,
-				int size, const char *sep, int *ts_errno)
+				int64_t size, const char *sep, int *ts_errno)
 {
 	uint64_t pct = 10000UL;
 	char tbuf[40];
@@ -1765,7 +2637,7 @@ int TraceAnalyzer::writeLatency(char *wb, int *space, const Latency *lptr,
 	int written = 0;
 	int w;
 	Task *task;
-	const unsigned int usize = size > 1 ? size - 1 : 1;
+	const uint64_t usize = size > 1 ? size - 1 : 1;
 
 	pct *= usize - lptr->place;
 	pct /= usize;
@@ -1782,9 +2654,10 @@ int TraceAnalyzer::writeLatency(char *wb, int *space, const Latency *lptr,
 	 * which is used by LatencyWidget to display latencies, see
 	 * LatencyModel::data().
 	 */
-	w = snprintf(wb, *space, "%d%s%s%s%s%s%s%s%d%s%u.%02u\n",
+	w = snprintf(wb, *space, "%d%s%s%s%s%s%s%s%lld%s%u.%02u\n",
 		     lptr->pid, sep, dname.toLatin1().data(), sep, tbuf,
-		     sep, lbuf, sep, lptr->place, sep, (unsigned) (pct / 100),
+		     sep, lbuf, sep, (long long) lptr->place, sep,
+		     (unsigned) (pct / 100),
 		     (unsigned) (pct % 100));
 	if (likely(w > 0)) {
 		written += w;
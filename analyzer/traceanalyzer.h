@@ -63,29 +63,34 @@
 
 #include "vtl/avltree.h"
 #include "vtl/compiler.h"
+#include "vtl/pidmap.h"
+#include "vtl/rankbitmap.h"
 #include "vtl/time.h"
 #include "vtl/tlist.h"
 
 #include "analyzer/abstracttask.h"
+#include "analyzer/compiledfilter.h"
 #include "analyzer/cpu.h"
 #include "analyzer/cpufreq.h"
 #include "analyzer/cpuidle.h"
 #include "analyzer/cputask.h"
+#include "analyzer/eventindex.h"
 #include "analyzer/filterstate.h"
 #include "analyzer/latency.h"
 #include "analyzer/migration.h"
 #include "analyzer/regexfilter.h"
 #include "analyzer/task.h"
 #include "analyzer/tcolor.h"
+#include "analyzer/zonemap.h"
 #include "misc/traceshark.h"
 #include "mm/mempool.h"
 #include "parser/genericparams.h"
+#include "parser/schedrecord.h"
 #include "parser/traceevent.h"
 #include "parser/traceparser.h"
 #include "threads/workitem.h"
 #include "threads/workthread.h"
 #include "threads/workqueue.h"
-#include "ui/migrationarrow.h"
 
 /*
  * Ftrace and perf only record sched_switch events, there is no record of when
@@ -94,7 +99,7 @@
  * the sched_switch event and the new task was scheduled FAKE_DELTA after the
  * sched_switch event.
  */
-#define FAKE_DELTA (vtl::Time(20))
+#define FAKE_DELTA (vtl::CompactTime(20))
 
 /* Macros for the heights of the scheduling graph */
 #define FULL_HEIGHT  ((double) 1)
@@ -106,12 +111,47 @@
  */
 #define DELAY_MAX ((double) 0.020)
 
+class Prescan;
 class TraceFile;
-class QCustomPlot;
 class SettingStore;
+class TraceAnalyzer;
+class JobControl;
+
+/*
+ * A FilterJob processes the filters for the chunks c of the bitmap where
+ * c % nr == index, so that the filters can be processed in parallel.
+ */
+class FilterJob {
+public:
+	FilterJob(): analyzer(nullptr), bitmap(nullptr), control(nullptr),
+		index(0), nr(1) {}
+	vtl_always_inline bool run();
+	TraceAnalyzer *analyzer;
+	vtl::RankBitmap *bitmap;
+	JobControl *control;
+	int index;
+	int nr;
+};
+
+/*
+ * The time limited stats of one task, computed without modifying the task, so
+ * that they can be computed in the background.
+ */
+class TaskStatsLimited {
+public:
+	TaskStatsLimited(): task(nullptr), control(nullptr), cursorPct(0) {}
+	bool run();
+	Task *task;
+	JobControl *control;
+	vtl::Time start;
+	vtl::Time end;
+	vtl::Time cursorTime;
+	unsigned cursorPct;
+};
 
 class TraceAnalyzer
 {
+	friend class FilterJob;
 public:
 	typedef enum : int {
 		EXPORT_TYPE_ALL = 0,
@@ -135,23 +175,28 @@ public:
 	bool isOpen() const;
 	void close(int *ts_errno);
 	bool processTrace(const QMap<int, QColor> &cmap);
+	bool processTracePartial(const QMap<int, QColor> &cmap,
+				 eventidx_t nrEvents,
+				 bool &done);
+	vtl_always_inline eventidx_t getNrProcessedEvents() const;
 	const TraceEvent *findPreviousSchedEvent(const vtl::Time &time,
 						 int pid,
-						 int *index) const;
+						 eventidx_t *index) const;
 	const TraceEvent *findNextSchedSleepEvent(const vtl::Time &time,
 						  int pid,
-						  int *index) const;
-	const TraceEvent *findPreviousWakEvent(int startidx,
+						  eventidx_t *index) const;
+	const TraceEvent *findPreviousWakEvent(eventidx_t startidx,
 					       int pid,
 					       event_t wanted,
-					       int *index) const;
+					       eventidx_t *index) const;
 	const TraceEvent *findWakingEvent(const TraceEvent *wakeup,
-					  int *index) const;
-	const TraceEvent *findFilteredEvent(int index, int *filterIndex) const;
+					  eventidx_t *index) const;
+	const TraceEvent *findFilteredEvent(eventidx_t index,
+					    eventidx_t *filterIndex) const;
 	vtl_always_inline unsigned int getMaxCPU() const;
 	vtl_always_inline unsigned int getNrCPUs() const;
-	vtl_always_inline unsigned int getNrSchedLatencies() const;
-	vtl_always_inline unsigned int getNrWakeLatencies() const;
+	vtl_always_inline int64_t getNrSchedLatencies() const;
+	vtl_always_inline int64_t getNrWakeLatencies() const;
 	vtl_always_inline vtl::Time getStartTime() const;
 	vtl_always_inline vtl::Time getEndTime() const;
 	vtl_always_inline int getMinIdleState() const;
@@ -172,12 +217,18 @@ public:
 	void setCpuFreqScale(unsigned int cpu, double scale);
 	void setMigrationOffset(double offset);
 	void setMigrationScale(double scale);
+	vtl_always_inline double getMigrationOffset() const;
+	vtl_always_inline double getMigrationUnit() const;
 	bool enableMigrations();
 	void doScale();
 	void doStats();
 	void doLimitedStats();
+	void computeLimitedStats(QVector<TaskStatsLimited> &stats,
+				 const vtl::Time &start,
+				 const vtl::Time &end,
+				 JobControl *control);
+	void commitLimitedStats(const QVector<TaskStatsLimited> &stats);
 	void doLatencyStats();
-	void setQCustomPlot(QCustomPlot *plot);
 	vtl_always_inline Task *findTask(int pid);
 	Task *findRealTask(int pid);
 	void createPidFilter(QMap<int, int> &map,
@@ -194,80 +245,87 @@ public:
 	void disableAllFilters();
 	bool isFiltered() const;
 	bool filterActive(FilterState::filter_t filter) const;
+	void setDeferFilters(bool defer);
+	vtl_always_inline bool isFilterPending() const;
+	void filterEvents(vtl::RankBitmap &bitmap, JobControl *control);
+	void commitFilteredEvents(vtl::RankBitmap &bitmap);
 	bool exportTraceFile(const char *fileName, int *ts_errno,
-			     exporttype_t export_type);
+			     exporttype_t export_type,
+			     const vtl::RankBitmap *selection = nullptr,
+			     JobControl *control = nullptr);
 	bool exportLatencies(exportformat_t format, latencytype_t type,
-			     const char *fileName, int *ts_errno);
+			     const char *fileName, int *ts_errno,
+			     JobControl *control = nullptr);
 	TraceFile *getTraceFile();
 	vtl::TList<TraceEvent> *events;
-	vtl::TList<const TraceEvent*> filteredEvents;
+	vtl::TList<SchedRecord> *records;
+	vtl::RankBitmap filteredEvents;
 	vtl::TList<Latency> schedLatencies;
 	vtl::TList<Latency> wakeLatencies;
-	vtl::AVLTree<int, CPUTask, vtl::AVLBALANCE_USEPOINTERS>
-		*cpuTaskMaps;
-	vtl::AVLTree<int, TaskHandle> taskMap;
+	vtl::PidMap<CPUTask> *cpuTaskMaps;
+	vtl::PidMap<TaskHandle> taskMap;
 	CpuFreq *cpuFreq;
 	CpuIdle *cpuIdle;
 	QList<Migration> migrations;
+	QVector<MigrationArrow> migrationArrows;
 private:
 	TraceParser *parser;
 	void prepareDataStructures();
 	void resetProperties();
-	void threadProcess();
-	int binarySearch(const vtl::Time &time, int start, int end) const;
-	int binarySearchFiltered(const vtl::Time &time, int start, int end)
-		const;
+	bool threadProcess(eventidx_t limit);
+	void processFinish();
+	void updateEndTime(eventidx_t lastIdx);
+	eventidx_t binarySearch(const vtl::CompactTime &time, eventidx_t start,
+				eventidx_t end) const;
 	bool colorizeTasks(const QMap<int, QColor> &cmap);
 	event_t determineCPUEvent(bool &ok);
-	int findIndexBefore(const vtl::Time &time) const;
-	int findIndexAfter(const vtl::Time &time) const;
-	int findFilteredIndexBefore(const vtl::Time &time) const;
-	vtl_always_inline int
-		generic_sched_switch_newpid(const TraceEvent &event) const;
-	vtl_always_inline int
-		generic_sched_switch_oldpid(const TraceEvent &event) const;
-	vtl_always_inline taskstate_t
-		generic_sched_switch_state(const TraceEvent &event) const;
-	vtl_always_inline int
-		generic_sched_wakeup_pid(const TraceEvent &event) const;
-	vtl_always_inline int
-		generic_sched_waking_pid(const TraceEvent &event) const;
+	eventidx_t findIndexBefore(const vtl::CompactTime &time) const;
+	eventidx_t findIndexAfter(const vtl::CompactTime &time) const;
 	vtl_always_inline
-	vtl::Time estimateSchedDelayNew(const CPU *eventCPU,
-					const vtl::Time &newTime,
-					const vtl::Time &startTime,
-					bool &valid) const;
-	vtl_always_inline vtl::Time estimateSchedDelay(const Task *task,
-						       const vtl::Time &newTime,
-						       bool &valid) const;
-	vtl_always_inline vtl::Time estimateWakeDelay(const Task *task,
-						      const vtl::Time &newTime,
-						      bool &valid) const;
+	vtl::CompactTime estimateSchedDelayNew(const CPU *eventCPU,
+					       const vtl::CompactTime &newTime,
+					       const vtl::CompactTime &startTime,
+					       bool &valid) const;
+	vtl_always_inline
+	vtl::CompactTime estimateSchedDelay(const Task *task,
+					    const vtl::CompactTime &newTime,
+					    bool &valid) const;
+	vtl_always_inline
+	vtl::CompactTime estimateWakeDelay(const Task *task,
+					   const vtl::CompactTime &newTime,
+					   bool &valid) const;
 	void handleWrongTaskOnCPU(const TraceEvent &event, unsigned int cpu,
 				  CPU *eventCPU, int oldpid,
-				  const vtl::Time &oldtime,
-				  int idx);
-	vtl_always_inline void processSwitchEvent(tracetype_t ttype,
-						  const TraceEvent &event,
-						  int idx);
-	vtl_always_inline void processWakeupEvent(tracetype_t ttype,
-						  const TraceEvent &event,
-						  int idx);
-	vtl_always_inline void processCPUfreqEvent(tracetype_t ttype,
-						   const TraceEvent &event,
-						   int idx);
-	vtl_always_inline void processCPUidleEvent(tracetype_t ttype,
-						   const TraceEvent &event,
-						   int idx);
-	vtl_always_inline void processMigrateEvent(tracetype_t ttype,
-						   const TraceEvent &event,
-						   int idx);
-	vtl_always_inline void processForkEvent(tracetype_t ttype,
-						const TraceEvent &event,
-						int idx);
-	vtl_always_inline void processExitEvent(tracetype_t ttype,
-						const TraceEvent &event,
-						int idx);
+				  const vtl::CompactTime &oldtime,
+				  eventidx_t idx);
+	template<tracetype_t TT>
+	vtl_always_inline void processSwitchEvent(const TraceEvent &event,
+						  const SchedRecord &rec,
+						  eventidx_t idx);
+	template<tracetype_t TT>
+	vtl_always_inline void processWakeupEvent(const TraceEvent &event,
+						  const SchedRecord &rec,
+						  eventidx_t idx);
+	template<tracetype_t TT>
+	vtl_always_inline void processCPUfreqEvent(const TraceEvent &event,
+						   const SchedRecord &rec,
+						   eventidx_t idx);
+	template<tracetype_t TT>
+	vtl_always_inline void processCPUidleEvent(const TraceEvent &event,
+						   const SchedRecord &rec,
+						   eventidx_t idx);
+	template<tracetype_t TT>
+	vtl_always_inline void processMigrateEvent(const TraceEvent &event,
+						   const SchedRecord &rec,
+						   eventidx_t idx);
+	template<tracetype_t TT>
+	vtl_always_inline void processForkEvent(const TraceEvent &event,
+						const SchedRecord &rec,
+						eventidx_t idx);
+	template<tracetype_t TT>
+	vtl_always_inline void processExitEvent(const TraceEvent &event,
+						const SchedRecord &rec,
+						eventidx_t idx);
 	void addCpuFreqWork(unsigned int cpu,
 			    QList<AbstractWorkItem*> &list);
 	void addCpuIdleWork(unsigned int cpu,
@@ -277,32 +335,58 @@ private:
 	void scaleMigration();
 	void processSchedAddTail();
 	void processFreqAddTail();
-	unsigned int guessTimePrecision();
-	vtl_always_inline void processGeneric(tracetype_t ttype);
+	void prescanEvents(eventidx_t begin, eventidx_t end, bool reserve);
+	void reservePrescanned(const Prescan *prescans, int nr);
+	template<tracetype_t TT>
+	vtl_always_inline bool processGeneric(eventidx_t limit);
+	template<tracetype_t TT>
+	vtl_always_inline void processBatch(eventidx_t begin, eventidx_t end);
 	vtl_always_inline void updateMaxCPU(unsigned int cpu);
 	vtl_always_inline void updateMaxFreq(unsigned int freq);
 	vtl_always_inline void updateMinFreq(unsigned int freq);
 	vtl_always_inline void updateMaxIdleState(int state);
 	vtl_always_inline void updateMinIdleState(int state);
-	void processFtrace();
-	void processPerf();
+	bool processFtrace(eventidx_t limit);
+	bool processPerf(eventidx_t limit);
 	void processAllFilters();
-	vtl_always_inline
-		bool processPidFilter(const TraceEvent &event,
-				      QMap<int, int> &map,
-				      bool inclusive);
+	vtl_always_inline bool filterEvent(const TraceEvent &event,
+					   const SchedRecord &rec);
+	bool filterCandidates(QVector<eventidx_t> &candidates) const;
+	bool blockCanPass(const EventBlockSummary &block) const;
+	vtl_always_inline uint64_t selectEvents(eventidx_t begin, int nr);
+	void compileFilterSet(CompiledFilterSet &set,
+			      const FilterState &state,
+			      const QMap<unsigned, unsigned> &cpuMap,
+			      const QMap<int, int> &pidMap,
+			      const QMap<event_t, event_t> &eventMap,
+			      bool inclusive,
+			      const vtl::CompactTime &low,
+			      const vtl::CompactTime &high);
+	void compileFilters();
+	bool filterChunks(vtl::RankBitmap &bitmap, JobControl *control,
+			  int index, int nr);
+	void filterChunk(vtl::RankBitmap &bitmap, int c, uint64_t *words);
+	void refilterEvents(vtl::RankBitmap &bitmap,
+			    const EventIndexList &list);
+	const EventIndexList *pidFilterEvents(int pid);
+	bool refilterPids(const QVector<int> &pids);
+	static void diffPidMaps(const QMap<int, int> &a,
+				const QMap<int, int> &b,
+				QVector<int> &diff);
 	vtl_always_inline bool processRegexFilter(const TraceEvent &event,
 						  const RegexFilter &regex);
 	int compileRegex(RegexFilter &filter);
 	void freeRegex(RegexFilter &filter);
+	void buildRegexCaches(RegexFilter &filter);
 	int writePerfEvent(char *wb, int *space, const TraceEvent *eptr,
 				  int *ts_errno);
-	int writeLatency(char *wb, int *space, const Latency *lptr, int size,
-			 const char *sep, int *ts_errno);
+	int writeLatency(char *wb, int *space, const Latency *lptr,
+			 int64_t size, const char *sep, int *ts_errno);
 	WorkQueue processingQueue;
 	WorkQueue scalingQueue;
 	WorkQueue statsQueue;
 	WorkQueue statsLimitedQueue;
+	WorkQueue filterQueue;
 	vtl::AVLTree<int, TColor> colorMap;
 	vtl::AVLTree<int, TColor> origColorMap;
 	TColor black;
@@ -317,19 +401,32 @@ private:
 	double migrationScale;
 	unsigned int maxCPU;
 	unsigned int nrCPUs;
-	vtl::Time endTime;
-	vtl::Time startTime;
+	vtl::CompactTime endTime;
+	vtl::CompactTime startTime;
 	double endTimeDbl;
 	double startTimeDbl;
-	int endTimeIdx;
+	eventidx_t endTimeIdx;
 	unsigned int maxFreq;
 	unsigned int minFreq;
 	int maxIdleState;
 	int minIdleState;
 	unsigned int timePrecision;
+	/*
+	 * The state of the processing of the trace, which may be done in
+	 * several steps, see processTracePartial()
+	 */
+	bool processBegun;
+	bool processStarted;
+	bool processEOF;
+	/* Set when the vectors have been reserved for the rest of the trace */
+	bool processReserved;
+	eventidx_t processIndex;
+	eventidx_t processReady;
 	CPU *CPUs;
 	StringPool<> *taskNamePool;
-	QCustomPlot *customPlot;
+	EventIndex eventIndex;
+	ZoneMap zoneMap;
+	vtl::PidMap<EventIndexList> pidEventLists;
 	FilterState filterState;
 	FilterState OR_filterState;
 	QMap<int, int> filterPidMap;
@@ -342,10 +439,19 @@ private:
 	RegexFilter OR_filterRegex;
 	bool pidFilterInclusive;
 	bool OR_pidFilterInclusive;
-	vtl::Time filterTimeLow;
-	vtl::Time filterTimeHigh;
-	vtl::Time OR_filterTimeLow;
-	vtl::Time OR_filterTimeHigh;
+	vtl::CompactTime filterTimeLow;
+	vtl::CompactTime filterTimeHigh;
+	vtl::CompactTime OR_filterTimeLow;
+	vtl::CompactTime OR_filterTimeHigh;
+	CompiledFilter compiledFilter;
+	/*
+	 * If deferFilters is true, then processAllFilters() only sets
+	 * filterPending, and it's up to the caller to run filterEvents() and
+	 * commitFilteredEvents(), typically in a background job. Until then
+	 * the filteredEvents are left as they were.
+	 */
+	bool deferFilters;
+	bool filterPending;
 	static const char spaceStr[];
 	static const int spaceStrLen;
 	static const char * const cpuevents[];
@@ -354,12 +460,13 @@ private:
 };
 
 vtl_always_inline
-vtl::Time TraceAnalyzer::estimateSchedDelayNew(const CPU *eventCPU,
-					       const vtl::Time &newTime,
-					       const vtl::Time &startTime,
-					       bool &valid) const
+vtl::CompactTime
+TraceAnalyzer::estimateSchedDelayNew(const CPU *eventCPU,
+				     const vtl::CompactTime &newTime,
+				     const vtl::CompactTime &startTime,
+				     bool &valid) const
 {
-	vtl::Time delay;
+	vtl::CompactTime delay;
 
 	if (!eventCPU->hasBeenScheduled)
 		goto regular;
@@ -375,11 +482,11 @@ regular:
 }
 
 vtl_always_inline
-vtl::Time TraceAnalyzer::estimateSchedDelay(const Task *task,
-					    const vtl::Time &newTime,
-					    bool &valid) const
+vtl::CompactTime TraceAnalyzer::estimateSchedDelay(const Task *task,
+						   const vtl::CompactTime &newTime,
+						   bool &valid) const
 {
-	vtl::Time delay;
+	vtl::CompactTime delay;
 
 	/* Is this reasonable ? */
 	if (task->lastRunnable_status == RUN_STATUS_INVALID ||
@@ -394,11 +501,11 @@ vtl::Time TraceAnalyzer::estimateSchedDelay(const Task *task,
 }
 
 vtl_always_inline
-vtl::Time TraceAnalyzer::estimateWakeDelay(const Task *task,
-					   const vtl::Time &newTime,
-					   bool &valid) const
+vtl::CompactTime TraceAnalyzer::estimateWakeDelay(const Task *task,
+						  const vtl::CompactTime &newTime,
+						  bool &valid) const
 {
-	vtl::Time delay;
+	vtl::CompactTime delay;
 
 	/* Is this reasonable ? */
 	if (task->lastRunnable_status != RUN_STATUS_WAKEUP ||
@@ -412,85 +519,33 @@ vtl::Time TraceAnalyzer::estimateWakeDelay(const Task *task,
 	return delay;
 }
 
-vtl_always_inline int
-TraceAnalyzer::generic_sched_switch_newpid(const TraceEvent &event) const
-{
-	sched_switch_handle_t handle;
-	tracetype_t ttype = getTraceType();
-
-	if (!tracetype_is_valid(ttype))
-		return INT_MAX;
-	if (!sched_switch_parse(ttype, event, handle))
-		return INT_MAX;
-	return sched_switch_handle_newpid(ttype, event, handle);
-}
-
-vtl_always_inline int
-TraceAnalyzer::generic_sched_switch_oldpid(const TraceEvent &event) const
-{
-	sched_switch_handle_t handle;
-	tracetype_t ttype = getTraceType();
-
-	if (!tracetype_is_valid(ttype))
-		return INT_MAX;
-	if (!sched_switch_parse(ttype, event, handle))
-		return INT_MAX;
-	return sched_switch_handle_oldpid(ttype, event, handle);
-}
-
-vtl_always_inline taskstate_t
-TraceAnalyzer::generic_sched_switch_state(const TraceEvent &event) const
+vtl_always_inline unsigned int TraceAnalyzer::getMaxCPU() const
 {
-	sched_switch_handle_t handle;
-	tracetype_t ttype = getTraceType();
-
-	if (!tracetype_is_valid(ttype))
-		return 0;
-	if (!sched_switch_parse(ttype, event, handle))
-		return 0;
-	return sched_switch_handle_state(ttype, event, handle);
+	return maxCPU;
 }
 
-vtl_always_inline int
-TraceAnalyzer::generic_sched_wakeup_pid(const TraceEvent &event) const
+vtl_always_inline unsigned int TraceAnalyzer::getNrCPUs() const
 {
-	tracetype_t ttype = getTraceType();
-
-	if (!tracetype_is_valid(ttype))
-		return INT_MAX;
-	if (!sched_wakeup_args_ok(ttype, event))
-		return INT_MAX;
-	return sched_wakeup_pid(ttype, event);
+	return nrCPUs;
 }
 
-vtl_always_inline int
-TraceAnalyzer::generic_sched_waking_pid(const TraceEvent &event) const
+vtl_always_inline double TraceAnalyzer::getMigrationOffset() const
 {
-	tracetype_t ttype = getTraceType();
-
-	if (!tracetype_is_valid(ttype))
-		return INT_MAX;
-	if (!sched_waking_args_ok(ttype, event))
-		return INT_MAX;
-	return sched_waking_pid(ttype, event);
+	return migrationOffset;
 }
 
-vtl_always_inline unsigned int TraceAnalyzer::getMaxCPU() const
+/* The distance between the migration lines of two CPUs */
+vtl_always_inline double TraceAnalyzer::getMigrationUnit() const
 {
-	return maxCPU;
+	return migrationScale / getNrCPUs();
 }
 
-vtl_always_inline unsigned int TraceAnalyzer::getNrCPUs() const
-{
-	return nrCPUs;
-}
-
-vtl_always_inline unsigned int TraceAnalyzer::getNrSchedLatencies() const
+vtl_always_inline int64_t TraceAnalyzer::getNrSchedLatencies() const
 {
 	return schedLatencies.size();
 }
 
-vtl_always_inline unsigned int TraceAnalyzer::getNrWakeLatencies() const
+vtl_always_inline int64_t TraceAnalyzer::getNrWakeLatencies() const
 {
 	return wakeLatencies.size();
 }
@@ -505,6 +560,11 @@ vtl_always_inline vtl::Time TraceAnalyzer::getEndTime() const
 	return endTime;
 }
 
+vtl_always_inline eventidx_t TraceAnalyzer::getNrProcessedEvents() const
+{
+	return processIndex;
+}
+
 vtl_always_inline int TraceAnalyzer::getMinIdleState() const
 {
 	return minIdleState;
@@ -549,20 +609,21 @@ vtl_always_inline Task *TraceAnalyzer::findTask(int pid)
 		return iter.value().task;
 }
 
+template<tracetype_t TT>
 vtl_always_inline
-void TraceAnalyzer::processMigrateEvent(tracetype_t ttype,
-					const TraceEvent &event,
-					int /* idx */)
+void TraceAnalyzer::processMigrateEvent(const TraceEvent &event,
+					const SchedRecord &rec,
+					eventidx_t /* idx */)
 {
 	Migration m;
 	unsigned int oldcpu;
 	unsigned int newcpu;
 
-	if (!sched_migrate_args_ok(ttype, event))
+	if (!rec.isValid())
 		return;
 
-	oldcpu = sched_migrate_origCPU(ttype, event);
-	newcpu = sched_migrate_destCPU(ttype, event);
+	oldcpu = (unsigned int) rec.value;
+	newcpu = rec.cpu;
 
 	if (!isValidCPU(oldcpu) || !isValidCPU(newcpu))
 		return;
@@ -570,24 +631,25 @@ void TraceAnalyzer::processMigrateEvent(tracetype_t ttype,
 	updateMaxCPU(oldcpu);
 	updateMaxCPU(newcpu);
 
-	m.pid = sched_migrate_pid(ttype, event);
+	m.pid = rec.pid;
 	m.oldcpu = oldcpu;
 	m.newcpu = newcpu;
 	m.time = event.time;
 	migrations.append(m);
 }
 
-vtl_always_inline void TraceAnalyzer::processForkEvent(tracetype_t ttype,
-						       const TraceEvent &event,
-						       int idx)
+template<tracetype_t TT>
+vtl_always_inline void TraceAnalyzer::processForkEvent(const TraceEvent &event,
+						       const SchedRecord &rec,
+						       eventidx_t idx)
 {
 	Migration m;
 	const char *childname;
 
-	if (!sched_process_fork_args_ok(ttype, event))
+	if (!rec.isValid())
 		return;
 
-	m.pid = sched_process_fork_childpid(ttype, event);
+	m.pid = rec.pid;
 	m.oldcpu = -1;
 	m.newcpu = event.cpu;
 	m.time = event.time;
@@ -602,22 +664,23 @@ vtl_always_inline void TraceAnalyzer::processForkEvent(tracetype_t ttype,
 		task->schedTimev.append(event.time.toDouble());
 		task->schedData.append(FLOOR_BIT);
 		task->schedEventIdx.append(idx);
-		childname = sched_process_fork_childname_strdup(ttype, event,
+		childname = sched_process_fork_childname_strdup<TT>(event,
 								taskNamePool);
 		task->checkName(childname, true);
 	}
 }
 
-vtl_always_inline void TraceAnalyzer::processExitEvent(tracetype_t ttype,
-						       const TraceEvent &event,
-						       int /* idx */)
+template<tracetype_t TT>
+vtl_always_inline void TraceAnalyzer::processExitEvent(const TraceEvent &event,
+						       const SchedRecord &rec,
+						       eventidx_t /* idx */)
 {
 	Migration m;
 
-	if (!sched_process_exit_args_ok(ttype, event))
+	if (!rec.isValid())
 		return;
 
-	m.pid = sched_process_exit_pid(ttype, event);
+	m.pid = rec.pid;
 	m.oldcpu = event.cpu;
 	m.newcpu = -1;
 	m.time = event.time;
@@ -629,24 +692,24 @@ vtl_always_inline void TraceAnalyzer::processExitEvent(tracetype_t ttype,
 	task->exitStatus = STATUS_EXITCALLED;
 }
 
+template<tracetype_t TT>
 vtl_always_inline
-void TraceAnalyzer::processSwitchEvent(tracetype_t ttype,
-				       const TraceEvent &event,
-				       int idx)
+void TraceAnalyzer::processSwitchEvent(const TraceEvent &event,
+				       const SchedRecord &rec, eventidx_t idx)
 {
 	sched_switch_handle_t handle;
 	unsigned int cpu = event.cpu;
-	vtl::Time oldtime = event.time - FAKE_DELTA;
-	vtl::Time newtime = event.time + FAKE_DELTA;
-	vtl::Time midtime = event.time;
+	vtl::CompactTime oldtime = event.time - FAKE_DELTA;
+	vtl::CompactTime newtime = event.time + FAKE_DELTA;
+	vtl::CompactTime midtime = event.time;
 	double oldtimeDbl = 0.0, newtimeDbl = 0.0;
 	int oldpid = 0;
 	int newpid = 0;
 	CPUTask *cpuTask = nullptr;
 	Task *task = nullptr;
-	vtl::Time delay;
+	vtl::CompactTime delay;
 	bool delayOK = false;
-	vtl::Time wakedelay;
+	vtl::CompactTime wakedelay;
 	bool wakedelayOK = false;
 	CPU *eventCPU = &CPUs[cpu];
 	taskstate_t state = 0;
@@ -657,11 +720,11 @@ void TraceAnalyzer::processSwitchEvent(tracetype_t ttype,
 	double delayDbl = 0.0;
 	double wakedelayDbl = 0.0;
 
-	if (!sched_switch_parse(ttype, event, handle))
+	if (!rec.isValid())
 		return;
 
-	oldpid = sched_switch_handle_oldpid(ttype, event, handle);
-	newpid = sched_switch_handle_newpid(ttype, event, handle);
+	oldpid = rec.pid;
+	newpid = rec.pid2;
 
 	if (!isValidCPU(cpu))
 		return;
@@ -748,12 +811,12 @@ void TraceAnalyzer::processSwitchEvent(tracetype_t ttype,
 	/* Handle the outgoing task */
 	cpuTask = &cpuTaskMaps[cpu][oldpid];
 	task = &taskMap[oldpid].getTask();
-	state = sched_switch_handle_state(ttype, event, handle);
+	state = rec.state();
 
-	name = sched_switch_handle_oldname_strdup(ttype,
-						  event,
-						  taskNamePool,
-						  handle);
+	rec.getHandle<TT>(handle);
+	name = sched_switch_handle_oldname_strdup<TT>(event,
+							      taskNamePool,
+							      handle);
 	task->checkName(name);
 
 	/* First handle the global task */
@@ -838,10 +901,10 @@ skip:
 
 	/* Handle the incoming task */
 	task = &taskMap[newpid].getTask();
-	name = sched_switch_handle_newname_strdup(ttype,
-						  event,
-						  taskNamePool,
-						  handle);
+	rec.getHandle<TT>(handle);
+	name = sched_switch_handle_newname_strdup<TT>(event,
+							      taskNamePool,
+							      handle);
 	if (name != nullptr)
 		task->checkName(name);
 	if (task->isNew) {
@@ -940,25 +1003,25 @@ out:
 	return;
 }
 
+template<tracetype_t TT>
 vtl_always_inline
-void TraceAnalyzer::processWakeupEvent(tracetype_t ttype,
-				       const TraceEvent &event,
-				       int idx)
+void TraceAnalyzer::processWakeupEvent(const TraceEvent &event,
+				       const SchedRecord &rec, eventidx_t idx)
 {
 	int pid;
 	Task *task;
-	vtl::Time time;
+	vtl::CompactTime time;
 	const char *name;
 
-	if (!sched_wakeup_args_ok(ttype, event))
+	if (!rec.isValid())
 		return;
 
 	/* Only interested in success */
-	if (!sched_wakeup_success(ttype, event))
+	if (!rec.isSuccess())
 		return;
 
 	time = event.time;
-	pid = sched_wakeup_pid(ttype, event);
+	pid = rec.pid;
 
 	/* Handle the woken up task */
 	task = &taskMap[pid].getTask();
@@ -968,7 +1031,7 @@ void TraceAnalyzer::processWakeupEvent(tracetype_t ttype,
 	if (task->isNew) {
 		task->pid = pid;
 		task->isNew = false;
-		name = sched_wakeup_name_strdup(ttype, event, taskNamePool);
+		name = sched_wakeup_name_strdup<TT>(event, taskNamePool);
 		if (name != nullptr)
 			task->checkName(name);
 		task->schedTimev.append(startTimeDbl);
@@ -977,20 +1040,21 @@ void TraceAnalyzer::processWakeupEvent(tracetype_t ttype,
 	}
 }
 
+template<tracetype_t TT>
 vtl_always_inline
-void TraceAnalyzer::processCPUfreqEvent(tracetype_t ttype,
-					const TraceEvent &event,
-					int /* idx */)
+void TraceAnalyzer::processCPUfreqEvent(const TraceEvent &event,
+					const SchedRecord &rec,
+					eventidx_t /* idx */)
 {
 	unsigned int cpu;
 	unsigned int freq;
-	vtl::Time time = event.time;
+	vtl::CompactTime time = event.time;
 
-	if(!cpufreq_args_ok(ttype, event))
+	if (!rec.isValid())
 		return;
 
-	cpu = cpufreq_cpu(ttype, event);
-	freq = cpufreq_freq(ttype, event);
+	cpu = rec.cpu;
+	freq = (unsigned int) rec.value;
 
 	if (!isValidCPU(cpu))
 		return;
@@ -1009,21 +1073,22 @@ void TraceAnalyzer::processCPUfreqEvent(tracetype_t ttype,
 	cpuFreq[cpu].data.append((double) freq);
 }
 
+template<tracetype_t TT>
 vtl_always_inline
-void TraceAnalyzer::processCPUidleEvent(tracetype_t ttype,
-					const TraceEvent &event,
-					int /* idx */)
+void TraceAnalyzer::processCPUidleEvent(const TraceEvent &event,
+					const SchedRecord &rec,
+					eventidx_t /* idx */)
 {
 	unsigned int cpu;
 	double time;
 	unsigned int state;
 
-	if (!cpuidle_args_ok(ttype, event))
+	if (!rec.isValid())
 		return;
 
-	cpu = cpuidle_cpu(ttype, event);
+	cpu = rec.cpu;
 	time = event.time.toDouble();
-	state = cpuidle_state(ttype, event) + 1;
+	state = rec.value + 1;
 
 	if (!isValidCPU(cpu))
 		return;
@@ -1066,116 +1131,96 @@ vtl_always_inline void TraceAnalyzer::updateMinIdleState(int state)
 		minIdleState = state;
 }
 
-vtl_always_inline void TraceAnalyzer::processGeneric(tracetype_t ttype)
+/*
+ * Process the events that the parser has made available until we have
+ * processed at least limit events or have reached the end of the trace.
+ * Returns true if the end of the trace has been reached.
+ */
+template<tracetype_t TT>
+vtl_always_inline bool TraceAnalyzer::processGeneric(eventidx_t limit)
 {
-	int i;
-	bool eof = false;
-	int indexReady = 0;
-	int prevIndex = 0;
+	eventidx_t end;
+	bool reserve;
 
-	while (!eof && indexReady <= 0)
-		parser->waitForNextBatch(eof, indexReady);
+	if (!processStarted) {
+		while (!processEOF && processReady <= 0)
+			parser->waitForNextBatch(processEOF, processReady);
 
-	if (indexReady <= 0)
-		return;
+		if (processReady <= 0)
+			return true;
 
-	startTime = (*events)[0].time;
-	AbstractTask::setStartTime(startTime);
-	AbstractTask::setEvents(events);
-	startTimeDbl = startTime.toDouble();
-
-	while(true) {
-		for (i = prevIndex; i < indexReady; i++) {
-			TraceEvent &event = (*events)[i];
-			if (!isValidCPU(event.cpu))
-				continue;
-			updateMaxCPU(event.cpu);
-			switch (event.type) {
-			case CPU_FREQUENCY:
-				processCPUfreqEvent(ttype, event, i);
-				break;
-			case CPU_IDLE:
-				processCPUidleEvent(ttype, event, i);
-				break;
-			case SCHED_MIGRATE_TASK:
-				processMigrateEvent(ttype, event, i);
-				break;
-			case SCHED_SWITCH:
-				processSwitchEvent(ttype, event, i);
-				break;
-			case SCHED_WAKEUP:
-			case SCHED_WAKEUP_NEW:
-				processWakeupEvent(ttype, event, i);
-				break;
-			case SCHED_PROCESS_FORK:
-				processForkEvent(ttype, event, i);
-				break;
-			case SCHED_PROCESS_EXIT:
-				processExitEvent(ttype, event, i);
-				break;
-			default:
+		startTime = (*events)[0].time;
+		AbstractTask::setStartTime(startTime);
+		AbstractTask::setEvents(events);
+		startTimeDbl = startTime.toDouble();
+		processStarted = true;
+	}
+
+	/*
+	 * Every batch that the parser has made available is processed while
+	 * the parser continues with the next batch. Until the parser has
+	 * reached the end of the trace, we don't know how large the vectors
+	 * will become, so they grow as usual. After that, the rest of the
+	 * events is counted once, so that the vectors can be reserved to
+	 * their final sizes.
+	 */
+	while (processIndex < limit) {
+		if (processIndex >= processReady) {
+			if (processEOF)
 				break;
-			}
+			parser->waitForNextBatch(processEOF, processReady);
+			continue;
 		}
-		if (eof)
-			break;
-		prevIndex = indexReady;
-		parser->waitForNextBatch(eof, indexReady);
+		end = processReady;
+		reserve = processEOF && !processReserved;
+		prescanEvents(processIndex, end, reserve);
+		if (reserve)
+			processReserved = true;
+		processBatch<TT>(processIndex, end);
+		processIndex = end;
 	}
-	endTime = events->last().time;
-	endTimeIdx = events->size() - 1;
-	AbstractTask::setEndTime(endTime);
-	endTimeDbl = endTime.toDouble();
-	nrCPUs = maxCPU + 1;
-	timePrecision = guessTimePrecision();
+	return processEOF && processIndex >= processReady;
 }
 
-vtl_always_inline
-bool TraceAnalyzer::processPidFilter(const TraceEvent &event,
-				     QMap<int, int> &map,
-				     bool inclusive)
+template<tracetype_t TT>
+vtl_always_inline void TraceAnalyzer::processBatch(eventidx_t begin,
+						   eventidx_t end)
 {
-	sched_switch_handle sw_handle;
-	DEFINE_FILTER_PIDMAP_ITERATOR(iter);
-	iter = map.find(event.pid);
-	if (iter == map.end()) {
-		tracetype_t ttype = getTraceType();
-		int pid = INT_MAX;
-		if (!inclusive)
-			return true;
+	eventidx_t i;
+
+	for (i = begin; i < end; i++) {
+		TraceEvent &event = (*events)[i];
+		const SchedRecord &rec = (*records)[i];
+		if (!isValidCPU(event.cpu))
+			continue;
+		updateMaxCPU(event.cpu);
 		switch (event.type) {
+		case CPU_FREQUENCY:
+			processCPUfreqEvent<TT>(event, rec, i);
+			break;
+		case CPU_IDLE:
+			processCPUidleEvent<TT>(event, rec, i);
+			break;
+		case SCHED_MIGRATE_TASK:
+			processMigrateEvent<TT>(event, rec, i);
+			break;
+		case SCHED_SWITCH:
+			processSwitchEvent<TT>(event, rec, i);
+			break;
 		case SCHED_WAKEUP:
 		case SCHED_WAKEUP_NEW:
-			if (!sched_wakeup_args_ok(ttype, event))
-				return true;
-			pid = sched_wakeup_pid(ttype, event);
-			break;
-		case SCHED_WAKING:
-			if (!sched_waking_args_ok(ttype, event))
-				return true;
-			pid = sched_waking_pid(ttype, event);
+			processWakeupEvent<TT>(event, rec, i);
 			break;
 		case SCHED_PROCESS_FORK:
-			if (!sched_process_fork_args_ok(ttype, event))
-				return true;
-			pid = sched_process_fork_childpid(ttype, event);
+			processForkEvent<TT>(event, rec, i);
 			break;
-		case SCHED_SWITCH:
-			if (!sched_switch_parse(ttype, event, sw_handle))
-				return true;
-			pid = sched_switch_handle_newpid(ttype, event,
-							 sw_handle);
-			if (pid == 0)
-				return true;
+		case SCHED_PROCESS_EXIT:
+			processExitEvent<TT>(event, rec, i);
 			break;
 		default:
-			return true;
+			break;
 		}
-		iter = filterPidMap.find(pid);
-		if (iter == filterPidMap.end())
-			return true;
 	}
-	return false;
 }
 
 vtl_always_inline
@@ -1196,9 +1241,7 @@ bool TraceAnalyzer::processRegexFilter(const TraceEvent &event,
 		switch (regex.posType) {
 		case Regex::POS_NONE:
 			for (j = 0; j < event.argc; j++) {
-				value = !regexec(&regex.regex,
-						 event.argv[j]->ptr,
-						 0, NULL, 0);
+				value = regex.match(event.argv[j]);
 				if (value) {
 					pidx = j;
 					break;
@@ -1209,9 +1252,7 @@ bool TraceAnalyzer::processRegexFilter(const TraceEvent &event,
 			if (regex.pos < 0 || regex.pos > event.argc - 1)
 				value = false;
 			else {
-				value = !regexec(&regex.regex,
-						 event.argv[regex.pos]->ptr,
-						 0, NULL, 0);
+				value = regex.match(event.argv[regex.pos]);
 				if (value) {
 					pidx = regex.pos;
 					break;
@@ -1225,9 +1266,7 @@ bool TraceAnalyzer::processRegexFilter(const TraceEvent &event,
 			if (pos < 0 || pos > event.argc - 1)
 				value = false;
 			else {
-				value = !regexec(&regex.regex,
-						 event.argv[pos]->ptr,
-						 0, NULL, 0);
+				value = regex.match(event.argv[pos]);
 				if (value) {
 					pidx = pos;
 					break;
@@ -1266,4 +1305,14 @@ bool TraceAnalyzer::processRegexFilter(const TraceEvent &event,
 	return sum;
 }
 
+vtl_always_inline bool TraceAnalyzer::isFilterPending() const
+{
+	return filterPending;
+}
+
+vtl_always_inline bool FilterJob::run()
+{
+	return analyzer->filterChunks(*bitmap, control, index, nr);
+}
+
 #endif /* TRACEANALYZER_H */
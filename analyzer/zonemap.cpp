@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <limits>
+
+#include "analyzer/zonemap.h"
+#include "misc/traceshark.h"
+#include "parser/schedrecord.h"
+#include "parser/traceevent.h"
+#include "vtl/tlist.h"
+
+EventBlockSummary::EventBlockSummary():
+	minTime(std::numeric_limits<vtl::CompactTime::timeint_t>::max()),
+	maxTime(std::numeric_limits<vtl::CompactTime::timeint_t>::min())
+{}
+
+ZoneMap::ZoneMap():
+	events(nullptr), records(nullptr), beginIdx(0), endIdx(0),
+	nrIndexed(0)
+{}
+
+void ZoneMap::setRange(const vtl::TList<TraceEvent> *ev,
+		       const vtl::TList<SchedRecord> *rec,
+		       eventidx_t begin, eventidx_t end)
+{
+	events = ev;
+	records = rec;
+	beginIdx = begin;
+	endIdx = end;
+}
+
+void ZoneMap::clear()
+{
+	blocks.clear();
+	nrIndexed = 0;
+}
+
+/*
+ * The last block of a range is usually partial, so it will be updated again
+ * when the next range is added.
+ */
+bool ZoneMap::build()
+{
+	eventidx_t i;
+	int nr;
+
+	if (endIdx <= beginIdx)
+		return false; /* No error */
+
+	nr = (int) (((endIdx - 1) >> ZONEMAP_BLOCK_SHIFT) + 1);
+	if (nr > blocks.size())
+		blocks.resize(nr);
+
+	for (i = beginIdx; i < endIdx; i++) {
+		const TraceEvent &event = events->at(i);
+		const SchedRecord &rec = records->at(i);
+		EventBlockSummary &b = blocks[(int) (i >> ZONEMAP_BLOCK_SHIFT)];
+
+		if (event.time < b.minTime)
+			b.minTime = event.time;
+		if (event.time > b.maxTime)
+			b.maxTime = event.time;
+		b.cpus.set(event.cpu);
+		if ((int) event.type >= 0)
+			b.types.set((unsigned int) event.type);
+		b.addPid(event.pid);
+		if (rec.isValid()) {
+			b.addPid(rec.pid);
+			b.addPid(rec.pid2);
+		}
+	}
+	nrIndexed = endIdx;
+	return false; /* No error */
+}
+
+/*
+ * Narrows the range [start, end] of a binary search for time to the blocks
+ * that can contain the result. The events are sorted by time, so the result is
+ * in the last block whose first event is not after time.
+ */
+void ZoneMap::narrowSearch(const vtl::CompactTime &time, eventidx_t &start,
+			   eventidx_t &end) const
+{
+	int low = 0;
+	int high = blocks.size();
+	int mid;
+	eventidx_t s, e;
+
+	/* Find the first block that starts after time */
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (blocks[mid].minTime <= time)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	if (low == 0)
+		return;
+
+	s = blockBegin(low - 1);
+	e = low < blocks.size() ? blockBegin(low) : nrIndexed - 1;
+	if (s > start)
+		start = s;
+	if (e < end)
+		end = e;
+}
@@ -0,0 +1,224 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ZONEMAP_H
+#define ZONEMAP_H
+
+#include <QVector>
+#include <cstdint>
+
+#include "misc/types.h"
+#include "vtl/compiler.h"
+#include "vtl/time.h"
+
+class SchedRecord;
+class TraceEvent;
+
+namespace vtl {
+	template<class T> class TList;
+}
+
+#define ZONEMAP_BLOCK_SHIFT (16)
+#define ZONEMAP_BLOCK_SIZE (1 << ZONEMAP_BLOCK_SHIFT)
+
+/* The number of bits in the CPU and event type sets of a block */
+#define ZONEMAP_NR_BITS (256)
+/* The number of bits in the pid bloom filter of a block */
+#define ZONEMAP_NR_PIDBITS (1024)
+
+/*
+ * A fixed size bitset. Values that don't fit are mapped to the last bit, so
+ * that the set can be used to tell that a value is certainly not present.
+ */
+template<unsigned int NR_BITS>
+class ZoneBits {
+public:
+	ZoneBits() { clear(); }
+	vtl_always_inline void clear();
+	vtl_always_inline void set(unsigned int v);
+	vtl_always_inline bool test(unsigned int v) const;
+private:
+	vtl_always_inline static unsigned int bitnr(unsigned int v);
+	uint64_t words[NR_BITS / 64];
+};
+
+template<unsigned int NR_BITS>
+vtl_always_inline void ZoneBits<NR_BITS>::clear()
+{
+	unsigned int i;
+
+	for (i = 0; i < NR_BITS / 64; i++)
+		words[i] = 0;
+}
+
+template<unsigned int NR_BITS>
+vtl_always_inline unsigned int ZoneBits<NR_BITS>::bitnr(unsigned int v)
+{
+	return v < NR_BITS ? v : NR_BITS - 1;
+}
+
+template<unsigned int NR_BITS>
+vtl_always_inline void ZoneBits<NR_BITS>::set(unsigned int v)
+{
+	unsigned int b = bitnr(v);
+
+	words[b / 64] |= UINT64_C(1) << (b % 64);
+}
+
+template<unsigned int NR_BITS>
+vtl_always_inline bool ZoneBits<NR_BITS>::test(unsigned int v) const
+{
+	unsigned int b = bitnr(v);
+
+	return (words[b / 64] & (UINT64_C(1) << (b % 64))) != 0;
+}
+
+/*
+ * The summary of a block of ZONEMAP_BLOCK_SIZE events. The pids are the pid of
+ * the event and the pids in its SchedRecord, they are stored in a bloom filter
+ * with two bits per pid.
+ */
+class EventBlockSummary {
+public:
+	EventBlockSummary();
+	vtl_always_inline void addPid(int pid);
+	vtl_always_inline bool mayHavePid(int pid) const;
+	vtl_always_inline bool overlaps(const vtl::CompactTime &low,
+					const vtl::CompactTime &high) const;
+	vtl::CompactTime minTime;
+	vtl::CompactTime maxTime;
+	ZoneBits<ZONEMAP_NR_BITS> cpus;
+	ZoneBits<ZONEMAP_NR_BITS> types;
+	ZoneBits<ZONEMAP_NR_PIDBITS> pids;
+private:
+	vtl_always_inline static uint64_t pidHash(int pid);
+};
+
+vtl_always_inline uint64_t EventBlockSummary::pidHash(int pid)
+{
+	return (uint64_t) (uint32_t) pid * UINT64_C(0x9e3779b97f4a7c15);
+}
+
+vtl_always_inline void EventBlockSummary::addPid(int pid)
+{
+	uint64_t h = pidHash(pid);
+
+	pids.set((unsigned int) (h >> 54));
+	pids.set((unsigned int) (h >> 44) % ZONEMAP_NR_PIDBITS);
+}
+
+vtl_always_inline bool EventBlockSummary::mayHavePid(int pid) const
+{
+	uint64_t h = pidHash(pid);
+
+	return pids.test((unsigned int) (h >> 54)) &&
+		pids.test((unsigned int) (h >> 44) % ZONEMAP_NR_PIDBITS);
+}
+
+vtl_always_inline
+bool EventBlockSummary::overlaps(const vtl::CompactTime &low,
+				 const vtl::CompactTime &high) const
+{
+	return !(maxTime < low || minTime > high);
+}
+
+/*
+ * The ZoneMap has an EventBlockSummary for every block of ZONEMAP_BLOCK_SIZE
+ * events, so that scans over the events can skip the blocks that cannot have
+ * any matching events. Like the EventIndex, it is built one range at a time
+ * and the ranges must be added in increasing order.
+ */
+class ZoneMap {
+public:
+	ZoneMap();
+	void setRange(const vtl::TList<TraceEvent> *ev,
+		      const vtl::TList<SchedRecord> *rec,
+		      eventidx_t begin, eventidx_t end);
+	bool build();
+	void clear();
+	vtl_always_inline int nrBlocks() const;
+	vtl_always_inline eventidx_t nrEvents() const;
+	vtl_always_inline const EventBlockSummary &block(int i) const;
+	vtl_always_inline static eventidx_t blockBegin(int i);
+	void narrowSearch(const vtl::CompactTime &time, eventidx_t &start,
+			  eventidx_t &end) const;
+private:
+	const vtl::TList<TraceEvent> *events;
+	const vtl::TList<SchedRecord> *records;
+	eventidx_t beginIdx;
+	eventidx_t endIdx;
+	eventidx_t nrIndexed;
+	QVector<EventBlockSummary> blocks;
+};
+
+vtl_always_inline int ZoneMap::nrBlocks() const
+{
+	return blocks.size();
+}
+
+/* The number of events that have been added to the ZoneMap */
+vtl_always_inline eventidx_t ZoneMap::nrEvents() const
+{
+	return nrIndexed;
+}
+
+vtl_always_inline const EventBlockSummary &ZoneMap::block(int i) const
+{
+	return blocks[i];
+}
+
+vtl_always_inline eventidx_t ZoneMap::blockBegin(int i)
+{
+	return (eventidx_t) i << ZONEMAP_BLOCK_SHIFT;
+}
+
+#endif /* ZONEMAP_H */
@@ -59,7 +59,9 @@
 
 #include <QDesktopWidget>
 
-#else /* QT_VERSION >= QT_VERSION_CHECK(5, 6, 0) */
+#endif
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
 
 #include <QScreen>
 
@@ -111,6 +113,21 @@ namespace QtCompat {
 		return QApplication::primaryScreen()->availableGeometry();
 	}
 
+#endif
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+
+	vtl_always_inline qreal refreshRate() {
+		return 60;
+	}
+
+#else /* QT_VERSION >= QT_VERSION_CHECK(5, 0, 0) */
+
+	vtl_always_inline qreal refreshRate() {
+		QScreen *screen = QApplication::primaryScreen();
+		return screen != nullptr ? screen->refreshRate() : 60;
+	}
+
 #endif
 
 	vtl_always_inline void enableHighDpi() {
@@ -78,7 +78,6 @@ public:
 		SHOW_CPUFREQ_GRAPHS,
 		SHOW_CPUIDLE_GRAPHS,
 		SHOW_MIGRATION_GRAPHS,
-		SHOW_MIGRATION_UNLIMITED,
 		OPENGL_ENABLED,
 		LINE_WIDTH,
 		IDLE_LINE_WIDTH,
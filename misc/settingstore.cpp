@@ -67,7 +67,6 @@ SettingStore::SettingStore()
 	QObject q;
 
 	Setting::Dependency schedDep(Setting::SHOW_SCHED_GRAPHS, true);
-	Setting::Dependency unlimitedDep(Setting::SHOW_MIGRATION_GRAPHS, true);
 	Setting::Dependency openglDep(Setting::OPENGL_ENABLED, true);
 	Setting::Dependency vertlatDep(Setting::VERTICAL_LATENCY, true);
 	Setting::Dependency loadsizeDep(Setting::LOAD_WINDOW_SIZE_START, true);
@@ -111,22 +110,11 @@ SettingStore::SettingStore()
 	setKey(Setting::SHOW_CPUIDLE_GRAPHS, QString("SHOW_CPUIDLE_GRAPHS"));
 	initBoolValue(Setting::SHOW_CPUIDLE_GRAPHS, true);
 
-	QString maxstr = QString::number(MAX_NR_MIGRATIONS / 1000);
-	maxstr = maxstr + QString("k");
-	setName(Setting::SHOW_MIGRATION_GRAPHS, q.tr("Show migrations if < ")
-		+ maxstr);
+	setName(Setting::SHOW_MIGRATION_GRAPHS, q.tr("Show migrations"));
 	setKey(Setting::SHOW_MIGRATION_GRAPHS,
 	       QString("SHOW_MIGRATION_GRAPHS"));
 	initBoolValue(Setting::SHOW_MIGRATION_GRAPHS, true);
 
-	setName(Setting::SHOW_MIGRATION_UNLIMITED,
-		q.tr("Unlimited migrations"));
-	setKey(Setting::SHOW_MIGRATION_UNLIMITED,
-	       QString("SHOW_MIGRATION_UNLIMITED"));
-	initBoolValue(Setting::SHOW_MIGRATION_UNLIMITED, false);
-	initDisabledBoolValue(Setting::SHOW_MIGRATION_UNLIMITED, false);
-	addDependency(Setting::SHOW_MIGRATION_UNLIMITED, unlimitedDep);
-
 	bool opengl = has_opengl() && !Setting::isLowResScreen();
 	int width = opengl ? DEFAULT_LINE_WIDTH_OPENGL : DEFAULT_LINE_WIDTH;
 
@@ -60,6 +60,7 @@
 #include <QtCore>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 
 QT_BEGIN_NAMESPACE
 class QString;
@@ -106,8 +107,6 @@ QT_END_NAMESPACE
 #include <QtWidgets>
 #endif
 
-#define MAX_NR_MIGRATIONS (200000)
-
 typedef enum : int {
 	TRACE_TYPE_FTRACE = 0,
 	TRACE_TYPE_PERF,
@@ -130,11 +129,10 @@ vtl_always_inline unsigned int int2uint(int value) {
 }
 
 #define DEFINE_CPUTASKMAP_ITERATOR(name) \
-	vtl::AVLTree<int, CPUTask, \
-		vtl::AVLBALANCE_USEPOINTERS>::iterator name
+	vtl::PidMap<CPUTask>::iterator name
 
 #define DEFINE_TASKMAP_ITERATOR(name) \
-	vtl::AVLTree<int, TaskHandle>::iterator name
+	vtl::PidMap<TaskHandle>::iterator name
 
 #define DEFINE_COLORMAP_ITERATOR(name) \
 	vtl::AVLTree<int, TColor>::iterator name
@@ -206,6 +204,80 @@ namespace TShark {
 		return uvalue.word32;
 	}
 
+	vtl_always_inline uint64_t load64(const char *p)
+	{
+		uint64_t v;
+		memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	vtl_always_inline uint32_t load32(const char *p)
+	{
+		uint32_t v;
+		memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	vtl_always_inline uint64_t rotl64(uint64_t v, int n)
+	{
+		return (v << n) | (v >> (64 - n));
+	}
+
+	vtl_always_inline uint64_t mix64(uint64_t v)
+	{
+		v ^= v >> 33;
+		v *= 0xff51afd7ed558ccdULL;
+		v ^= v >> 33;
+		v *= 0xc4ceb9fe1a85ec53ULL;
+		v ^= v >> 33;
+		return v;
+	}
+
+	/*
+	 * A hash function that, unlike StrHash32(), depends on all characters
+	 * of the string. It consumes 16 bytes per iteration and does at most
+	 * two unaligned loads for the tail, so the cost is low also for the
+	 * short strings that are typical in traces.
+	 */
+	vtl_always_inline uint64_t StrHash64(const TString *str)
+	{
+		const uint64_t k0 = 0x9e3779b97f4a7c15ULL;
+		const uint64_t k1 = 0xbf58476d1ce4e5b9ULL;
+		const uint64_t k2 = 0x94d049bb133111ebULL;
+		const char *p = str->ptr;
+		int len = str->len;
+		uint64_t h = k0 ^ ((uint64_t) len * k1);
+		uint64_t a, b;
+
+		while (len > 16) {
+			a = load64(p);
+			b = load64(p + 8);
+			h = rotl64(h ^ (a * k1), 31) * k0;
+			h = rotl64(h ^ (b * k2), 29) * k0;
+			p += 16;
+			len -= 16;
+		}
+
+		if (len >= 8) {
+			a = load64(p);
+			b = load64(p + len - 8);
+		} else if (len >= 4) {
+			a = load32(p);
+			b = load32(p + len - 4);
+		} else if (len > 0) {
+			a = ((uint64_t) (uint8_t) p[0] << 16) |
+				((uint64_t) (uint8_t) p[len >> 1] << 8) |
+				(uint64_t) (uint8_t) p[len - 1];
+			b = 0;
+		} else {
+			a = 0;
+			b = 0;
+		}
+		h = rotl64(h ^ (a * k1), 31) * k0;
+		h ^= b * k2;
+		return mix64(h);
+	}
+
 	vtl_always_inline bool cmp_timespec(const struct timespec &s1,
 					    const struct timespec &s2) {
 		return s1.tv_sec == s2.tv_sec && s1.tv_nsec == s2.tv_nsec;
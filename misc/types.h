@@ -54,8 +54,13 @@
 #ifndef MISC_TYPES_H_
 #define MISC_TYPES_H_
 
+#include <cstdint>
+
 typedef uint32_t taskstate_t;
 
+/* The index of an event, traces may contain more than 2^31 events */
+typedef int64_t eventidx_t;
+
 /*
  * This is the maximum length of strings in TRACEEVENT_DEFS_. If a new string is
  * added and it is longer than the value below, then it must be increased.
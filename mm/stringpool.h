@@ -54,100 +54,56 @@
 #define STRINGPOOL_H
 
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <new>
 #include "mm/mempool.h"
 #include "misc/osapi.h"
 #include "misc/traceshark.h"
 #include "misc/tstring.h"
-#include "vtl/avltree.h"
 #include "vtl/compiler.h"
-#include "vtl/tlist.h"
 
-#define STRINGPOOL_MAX(A, B) ((A) >= (B) ? A:B)
-#define STRINGPOOL_MIN(A, B) ((A) < (B) ? A:B)
+#define STRINGPOOL_MINSIZE (64)
+#define STRINGPOOL_MINREGIONS (64)
 
-class DummySP_ {};
-
-class PoolBundleSP {
-public:
-	MemPool *charPool;
-	MemPool *nodePool;
-};
-
-template<typename HashFunc>
-class StringPool;
-
-#define STRINGPOOL_ITERATOR_(name) \
-vtl::AVLTree<TString, DummySP_, vtl::AVLBALANCE_USEPOINTERS, \
-AVLAllocatorSP<TString, DummySP_>, AVLCompareSP<TString>>::iterator
-
-template <class T>
-class AVLCompareSP {
-public:
-	vtl_always_inline static int compare(const T &a, const T &b) {
-		return strcmp(a.ptr, b.ptr);
-	}
-};
-
-template <class T, class U>
-class AVLAllocatorSP {
+class StringPoolSlot {
 public:
-	AVLAllocatorSP(void *data) {
-		PoolBundleSP *pb = (PoolBundleSP*) data;
-		pools = *pb;
-	}
-	vtl_always_inline vtl::AVLNode<T, U> *alloc(const T &key) {
-		vtl::AVLNode<T, U> *node = (vtl::AVLNode<T, U> *)
-			pools.nodePool->allocObj();
-		node->key.len = key.len;
-		node->key.ptr = (char*) pools.charPool->allocChars(key.len + 1);
-		strcpy(node->key.ptr, key.ptr);
-		return node;
-	}
-	vtl_always_inline int clear() {
-		/*
-		 * Do nothing because the pools are owned by StringPool. This
-		 * is only called from StringPool, via AVLTree, when the object
-		 * is cleared.
-		 */
-		return 0;
-	}
-private:
-	PoolBundleSP pools;
+	uint64_t hval;
+	TString *str;
 };
 
-#define AVLTREE_SIZE ((int)sizeof(vtl::AVLTree<TString, DummySP_,	 \
-vtl::AVLBALANCE_USEPOINTERS, AVLAllocatorSP<TString, DummySP_>, \
-			     AVLCompareSP<TString>>))
-#define TSTRING_PTR_SIZE ((int)sizeof(TString*))
-#define TYPICAL_CACHE_LINE_SIZE (64)
-
-#define SP_CACHE_SIZE (TYPICAL_CACHE_LINE_SIZE - TSTRING_PTR_SIZE - \
-		       AVLTREE_SIZE)
-
-template<typename HashFunc>
-class StringPoolEntry {
-	friend class StringPool<HashFunc>;
+class StringPoolRegion {
 public:
-StringPoolEntry(void *data): cachePtr(nullptr), avlTree(data) {
-		tshark_bzero(cache, SP_CACHE_SIZE);
-	}
-protected:
-	char cache[SP_CACHE_SIZE];
-	TString *cachePtr;
-	vtl::AVLTree<TString, DummySP_, vtl::AVLBALANCE_USEPOINTERS,
-		     AVLAllocatorSP<TString, DummySP_>, AVLCompareSP<TString>>
-		avlTree;
+	uint32_t nrAllocs;
+	uint32_t nrReuse;
 };
 
 class StringPoolDefaultHashFunc {
 public:
-	vtl_always_inline uint32_t operator()(const TString *str) const
+	vtl_always_inline uint64_t operator()(const TString *str) const
 	{
-		return TShark::StrHash32(str);
+		return TShark::StrHash64(str);
 	}
 };
 
+/*
+ * The StringPool makes sure that equal strings are only stored once. It is an
+ * open addressing hash table with linear probing. The slots store the full
+ * hash value, so that strings only need to be compared when the hash values
+ * are equal, and the table is never more than half full. The strings and the
+ * TString objects are allocated from MemPools, so they never move.
+ *
+ * If allocString() is given a non-zero cutoff, the pool keeps count of how
+ * many strings that are added and reused in each region of the hash space.
+ * Once a region has seen more than cutoff new strings, and they are not being
+ * reused more often than that, new strings of that region are copied but not
+ * added to the table. This bounds the size of the table for strings that are
+ * mostly unique, such as addresses.
+ *
+ * A StringPool is not thread safe but it doesn't need to be; each grammar has
+ * its own pools, which are only used by the parser thread, and the analyzer
+ * has its own pool.
+ */
 template<typename HashFunc = StringPoolDefaultHashFunc>
 class StringPool
 {
@@ -155,20 +111,25 @@ public:
 	StringPool(unsigned int nr_pages = 256 * 10, unsigned int hSizeP = 256);
 	~StringPool();
 	vtl_always_inline const TString *allocString(const TString *str,
-						   uint32_t cutoff);
+						   uint32_t cutoff = 0);
 	void clear();
 	void reset();
+	vtl_always_inline uint64_t size() const;
+	template<typename Func>
+	void forEachString(Func &func) const;
 private:
-	vtl_always_inline const TString *allocUniqueString(const TString *str);
-	MemPool *coldCharPool;
+	vtl_always_inline TString *newString(const TString *str);
+	vtl_always_inline StringPoolRegion *regionOf(uint64_t hval);
+	bool allocTable(uint64_t size);
+	bool grow();
+	MemPool *charPool;
 	MemPool *strPool;
-	PoolBundleSP avlPools;
-	StringPoolEntry<HashFunc> **hashTable;
-	unsigned int *countAllocs;
-	unsigned int *countReuse;
-	unsigned int hSize;
-	void clearTable();
-	vtl::TList<StringPoolEntry<HashFunc>*> deleteList;
+	StringPoolSlot *table;
+	StringPoolRegion *regions;
+	uint64_t tableSize;
+	uint64_t initialSize;
+	uint64_t nrStrings;
+	unsigned int regionShift;
 	HashFunc hFunc;
 };
 
@@ -177,57 +138,73 @@ vtl_always_inline
 const TString *StringPool<HashFunc>::allocString(const TString *str,
 						 uint32_t cutoff)
 {
-	StringPoolEntry<HashFunc> *entry;
-	bool isNew;
-	uint32_t hval = hFunc(str);
-
-	hval = hval % hSize;
+	uint64_t hval = hFunc(str);
+	uint64_t mask;
+	uint64_t i;
+	StringPoolRegion *region = nullptr;
+	StringPoolSlot *slot;
+	TString *newstr;
 
-	if (cutoff != 0 && countAllocs[hval] > cutoff &&
-	    countAllocs[hval] > countReuse[hval]) {
-		const TString *newstr = allocUniqueString(str);
-		return newstr;
+	if (cutoff != 0) {
+		region = regionOf(hval);
+		if (region->nrAllocs > cutoff &&
+		    region->nrAllocs > region->nrReuse)
+			return newString(str);
 	}
 
-	if (hashTable[hval] != nullptr) {
-		entry = hashTable[hval];
-		if (entry->cachePtr != nullptr &&
-		    strcmp(entry->cache, str->ptr) == 0) {
-			if (cutoff != 0)
-				countReuse[hval]++;
-			return entry->cachePtr;
-		}
-		STRINGPOOL_ITERATOR_(iter) iter =
-			entry->avlTree.findInsert(*str, isNew);
-		TString &refStr = iter.key();
-		if (isNew) {
-			if (cutoff != 0)
-				countAllocs[hval]++;
-		} else {
-			if (refStr.len < SP_CACHE_SIZE) {
-				strcpy(entry->cache, refStr.ptr);
-				entry->cachePtr = &refStr;
-			}
-			if (cutoff != 0)
-				countReuse[hval]++;
+	/* Grow before inserting, so that a failed allocation is harmless */
+	if (unlikely(nrStrings >= tableSize / 2) && !grow())
+		return nullptr;
+
+	mask = tableSize - 1;
+	i = hval & mask;
+	while (true) {
+		slot = &table[i];
+		if (slot->str == nullptr)
+			break;
+		if (slot->hval == hval && slot->str->len == str->len &&
+		    memcmp(slot->str->ptr, str->ptr, str->len) == 0) {
+			if (region != nullptr)
+				region->nrReuse++;
+			return slot->str;
 		}
-		return &refStr;
-	} else {
-		entry = new StringPoolEntry<HashFunc>(&avlPools);
-		hashTable[hval] = entry;
-		deleteList.append(entry);
-		STRINGPOOL_ITERATOR_(iter) iter =
-			entry->avlTree.findInsert(*str, isNew);
-		if (cutoff != 0)
-			countAllocs[hval]++;
-		TString &refStr = iter.key();
-		return &refStr;
+		i = (i + 1) & mask;
+	}
+
+	newstr = newString(str);
+	if (newstr == nullptr)
+		return nullptr;
+	slot->hval = hval;
+	slot->str = newstr;
+	nrStrings++;
+	if (region != nullptr)
+		region->nrAllocs++;
+	return newstr;
+}
+
+/* The number of strings in the table */
+template<typename HashFunc>
+vtl_always_inline uint64_t StringPool<HashFunc>::size() const
+{
+	return nrStrings;
+}
+
+/* Calls func(const TString *) for every string in the table */
+template<typename HashFunc>
+template<typename Func>
+void StringPool<HashFunc>::forEachString(Func &func) const
+{
+	uint64_t i;
+
+	for (i = 0; i < tableSize; i++) {
+		if (table[i].str != nullptr)
+			func(table[i].str);
 	}
 }
 
 template<typename HashFunc>
 vtl_always_inline
-const TString *StringPool<HashFunc>::allocUniqueString(const TString *str)
+TString *StringPool<HashFunc>::newString(const TString *str)
 {
 	TString *newstr;
 
@@ -235,80 +212,129 @@ const TString *StringPool<HashFunc>::allocUniqueString(const TString *str)
 	if (newstr == nullptr)
 		return nullptr;
 	newstr->len = str->len;
-	newstr->ptr = (char*) coldCharPool->allocChars(str->len + 1);
+	newstr->ptr = (char*) charPool->allocChars(str->len + 1);
 	if (newstr->ptr == nullptr)
 		return nullptr;
-	strcpy(newstr->ptr, str->ptr);
+	memcpy(newstr->ptr, str->ptr, str->len);
+	newstr->ptr[str->len] = '\0';
 	return newstr;
 }
 
+/*
+ * The regions use the high bits of the hash value, so that they do not
+ * depend on the size of the table, which uses the low bits.
+ */
 template<typename HashFunc>
-StringPool<HashFunc>::StringPool(unsigned int nr_pages, unsigned int hSizeP)
+vtl_always_inline
+StringPoolRegion *StringPool<HashFunc>::regionOf(uint64_t hval)
 {
-	unsigned int entryPages, strPages;
-
-	if (hSizeP == 0)
-		hSize = 1;
-	else
-		hSize = hSizeP;
-
-	entryPages = 2 * hSize *
-		sizeof(vtl::AVLNode<TString, DummySP_>) / 4096;
-	entryPages = STRINGPOOL_MAX(1, entryPages);
-	strPages = 2* hSize * sizeof(TString) / 4096;
-	strPages = STRINGPOOL_MAX(16, strPages);
-
-	coldCharPool = new MemPool(nr_pages, 1);
-	strPool = new MemPool(nr_pages, sizeof(TString));
-
-	avlPools.charPool = new MemPool(nr_pages, sizeof(char));
-	avlPools.nodePool = new MemPool(entryPages, sizeof(vtl::AVLNode<TString,
-							   DummySP_>));
-	hashTable = new StringPoolEntry<HashFunc>*[hSize];
-	countAllocs = new unsigned int[hSize];
-	countReuse = new unsigned int[hSize];
-	clearTable();
+	return &regions[hval >> regionShift];
+}
+
+template<typename HashFunc>
+StringPool<HashFunc>::StringPool(unsigned int nr_pages, unsigned int hSizeP):
+	table(nullptr), regions(nullptr), tableSize(0), nrStrings(0)
+{
+	unsigned int strPages;
+	uint64_t nrRegions;
+
+	/* The table size must be a power of two */
+	initialSize = STRINGPOOL_MINSIZE;
+	while (initialSize < hSizeP)
+		initialSize *= 2;
+
+	/*
+	 * Like the buckets of the old chained table, there is one region per
+	 * slot of the initial table, but not fewer than STRINGPOOL_MINREGIONS.
+	 */
+	nrRegions = STRINGPOOL_MINREGIONS;
+	regionShift = 64 - 6;
+	while (nrRegions < initialSize) {
+		nrRegions *= 2;
+		regionShift--;
+	}
+
+	strPages = initialSize * sizeof(TString) / 4096;
+	strPages = TSMAX(16, strPages);
+
+	charPool = new MemPool(nr_pages, 1);
+	strPool = new MemPool(strPages, sizeof(TString));
+	regions = (StringPoolRegion*) calloc(nrRegions,
+					     sizeof(StringPoolRegion));
+	if (regions == nullptr || !allocTable(initialSize)) {
+		free(regions);
+		delete charPool;
+		delete strPool;
+		throw std::bad_alloc();
+	}
 }
 
 template<typename HashFunc>
 StringPool<HashFunc>::~StringPool()
 {
-	unsigned int i, s;
-	delete coldCharPool;
+	delete charPool;
 	delete strPool;
-	delete avlPools.charPool;
-	delete avlPools.nodePool;
-	delete[] hashTable;
-	delete[] countAllocs;
-	delete[] countReuse;
-	s = deleteList.size();
-	for (i = 0; i < s; i++) {
-		delete deleteList[i];
-	}
+	free(table);
+	free(regions);
 }
 
 template<typename HashFunc>
-void StringPool<HashFunc>::clearTable()
+bool StringPool<HashFunc>::allocTable(uint64_t size)
 {
-	tshark_bzero(hashTable, hSize * sizeof(StringPoolEntry<HashFunc>*));
-	tshark_bzero(countAllocs, hSize * sizeof(unsigned int));
-	tshark_bzero(countReuse, hSize * sizeof(unsigned int));
+	StringPoolSlot *t;
+
+	t = (StringPoolSlot*) calloc(size, sizeof(StringPoolSlot));
+	if (t == nullptr)
+		return false;
+	table = t;
+	tableSize = size;
+	return true;
+}
+
+/*
+ * Doubles the size of the table. If the allocation fails, the old table is
+ * kept and false is returned.
+ */
+template<typename HashFunc>
+bool StringPool<HashFunc>::grow()
+{
+	StringPoolSlot *old = table;
+	uint64_t oldSize = tableSize;
+	uint64_t mask;
+	uint64_t i, j;
+
+	if (!allocTable(oldSize * 2))
+		return false;
+	mask = tableSize - 1;
+
+	for (i = 0; i < oldSize; i++) {
+		if (old[i].str == nullptr)
+			continue;
+		j = old[i].hval & mask;
+		while (table[j].str != nullptr)
+			j = (j + 1) & mask;
+		table[j] = old[i];
+	}
+	free(old);
+	return true;
 }
 
 template<typename HashFunc>
 void StringPool<HashFunc>::clear()
 {
-	unsigned int s, i;
-	clearTable();
-	coldCharPool->reset();
+	StringPoolSlot *old = table;
+	uint64_t nrRegions = ((uint64_t) 1) << (64 - regionShift);
+
+	charPool->reset();
 	strPool->reset();
-	avlPools.nodePool->reset();
-	avlPools.charPool->reset();
-	s = deleteList.size();
-	for (i = 0; i < s; i++) {
-		delete deleteList[i];
+	tshark_bzero(regions, nrRegions * sizeof(StringPoolRegion));
+	if (tableSize == initialSize || !allocTable(initialSize)) {
+		/* If the smaller table cannot be allocated, reuse the old */
+		tshark_bzero(table, tableSize * sizeof(StringPoolSlot));
+	} else {
+		free(old);
 	}
-	deleteList.clear();
+	nrStrings = 0;
 }
 
 template<typename HashFunc>
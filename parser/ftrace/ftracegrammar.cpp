@@ -58,7 +58,7 @@
 #include "parser/traceevent.h"
 
 FtraceGrammar::FtraceGrammar() :
-	unknownTypeCounter(EVENT_UNKNOWN), tmp_argc(0)
+	timePrecision(0), unknownTypeCounter(EVENT_UNKNOWN), tmp_argc(0)
 {
 	argPool = new StringPool<>(2048, 1024 * 1024);
 	flagPool = new StringPool<>(1024, 65536);
@@ -84,6 +84,7 @@ void FtraceGrammar::clear()
 	eventTree->clear();
 	setupEventTree();
 	unknownTypeCounter = EVENT_UNKNOWN;
+	timePrecision = 0;
 }
 
 void FtraceGrammar::setupEventTree()
@@ -79,6 +79,9 @@ public:
 	vtl_always_inline bool parseLine(const TraceLine &line,
 				       TraceEvent &event);
 	StringTree<> *eventTree;
+	/* The highest number of decimals seen in a timestamp */
+	unsigned int timePrecision;
+	vtl_always_inline const StringPool<> *getArgPool() const;
 private:
 	void setupEventTree();
 	vtl_always_inline bool NamePidMatch(const TString *str,
@@ -108,6 +111,11 @@ private:
 	const TString *tmp_argv[EVENT_MAX_NR_ARGS];
 };
 
+vtl_always_inline const StringPool<> *FtraceGrammar::getArgPool() const
+{
+	return argPool;
+}
+
 vtl_always_inline bool FtraceGrammar::NamePidMatch(const TString *str,
 						   TraceEvent &/*event*/)
 {
@@ -182,7 +190,7 @@ vtl_always_inline bool FtraceGrammar::FlagMatch(const TString *str,
 	if (fifth != '.' && !isxdigit(fifth))
 		return false;
 
-	event.flagstr = flagPool->allocString(str, 0);
+	event.flagstr = flagPool->allocString(str);
 	return true;
 }
 
@@ -230,6 +238,7 @@ vtl_always_inline bool FtraceGrammar::TimeMatch(const TString *str,
 						TraceEvent &event)
 {
 	bool rval;
+	vtl::Time time;
 	TString namestr;
 	TString finistr;
 	const TString *newname;
@@ -248,7 +257,8 @@ vtl_always_inline bool FtraceGrammar::TimeMatch(const TString *str,
 	 * atof() and sscanf() are not up to the task because they are
 	 * too slow and get confused by locality issues.
 	 */
-	event.time = vtl::Time::fromString(str->ptr, rval);
+	time = vtl::Time::fromString(str->ptr, rval);
+	event.time = time;
 
 	/*
 	 * This is the time field, if it is successful we need to assemble
@@ -256,6 +266,8 @@ vtl_always_inline bool FtraceGrammar::TimeMatch(const TString *str,
 	 * tmp_argv/tmp_argc.
 	 */
 	if (rval) {
+		if (time.getPrecision() > timePrecision)
+			timePrecision = time.getPrecision();
 		if (tmp_argc < 2)
 			return false;
 
@@ -281,10 +293,10 @@ vtl_always_inline bool FtraceGrammar::TimeMatch(const TString *str,
 			}
 			if (!namestr.merge(&finistr, maxlen))
 				return false;
-			newname = namePool->allocString(&namestr, 0);
+			newname = namePool->allocString(&namestr);
 		} else {
 			/* This is the common case, no spaces in the name. */
-			newname = namePool->allocString(&finistr, 0);
+			newname = namePool->allocString(&finistr);
 		}
 
 		if (newname == nullptr)
@@ -197,7 +197,7 @@ ftrace_sched_switch_handle_newname_strdup_(const TraceEvent &event,
 	}
 
 	ts.len = len;
-	retstr = pool->allocString(&ts, 0);
+	retstr = pool->allocString(&ts);
 	if (retstr == nullptr)
 		return NullStr;
 
@@ -271,7 +271,7 @@ ftrace_sched_switch_handle_oldname_strdup_(const TraceEvent &event,
 			return NullStr;
 	}
 	ts.len = len;
-	retstr = pool->allocString(&ts, 0);
+	retstr = pool->allocString(&ts);
 	if (retstr == nullptr)
 		return NullStr;
 
@@ -519,7 +519,7 @@ static vtl_always_inline const char
 			return NullStr;
 	}
 	ts.len = len;
-	retstr = pool->allocString(&ts, 0);
+	retstr = pool->allocString(&ts);
 	if (retstr == nullptr)
 		return NullStr;
 
@@ -611,7 +611,7 @@ found:
 	len++;
 
 	ts.len = len;
-	retstr = pool->allocString(&ts, 0);
+	retstr = pool->allocString(&ts);
 	if (retstr == nullptr)
 		return NullStr;
 
@@ -675,7 +675,7 @@ ftrace_sched_waking_name_strdup_(const TraceEvent &event, StringPool<> *pool)
 		return NullStr;
 
 	ts.len = len;
-	retstr = pool->allocString(&ts, 0);
+	retstr = pool->allocString(&ts);
 	if (retstr == nullptr)
 		return NullStr;
 	return retstr->ptr;
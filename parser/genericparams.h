@@ -63,50 +63,100 @@ static vtl_always_inline bool tracetype_is_valid(tracetype_t ttype)
 	return ttype == TRACE_TYPE_FTRACE || ttype == TRACE_TYPE_PERF;		
 }
 
+/*
+ * Each of these macros declares two functions. The first one is a template
+ * that takes the trace type as a template parameter, so that the dispatch is
+ * done at compile time. This is the one that should be used in loops over
+ * the events. The second one dispatches at runtime and is intended to be
+ * used when only a few events are accessed.
+ */
 #define DECLARE_GENERIC_TRACEFN(FNAME, RETTYPE)			   \
+template<tracetype_t TT>					   \
+static vtl_always_inline RETTYPE FNAME(const TraceEvent &event)   \
+{							           \
+	if (TT == TRACE_TYPE_FTRACE)				   \
+		return ftrace_##FNAME(event);			   \
+	else /* (TT == TRACE_TYPE_PERF) */			   \
+		return perf_##FNAME(event);			   \
+}								   \
+								   \
 static vtl_always_inline RETTYPE FNAME(tracetype_t tt,	  	   \
 				       const TraceEvent &event)	   \
 {							           \
 	if (tt == TRACE_TYPE_FTRACE)				   \
-		return ftrace_##FNAME(event);			   \
+		return FNAME<TRACE_TYPE_FTRACE>(event);		   \
 	else /* (tt == TRACE_TYPE_PERF) */			   \
-		return perf_##FNAME(event);			   \
+		return FNAME<TRACE_TYPE_PERF>(event);		   \
 }
 
 #define DECLARE_GENERIC_TRACEFN_POOL(FNAME, RETTYPE)		   \
+template<tracetype_t TT>					   \
+static vtl_always_inline RETTYPE FNAME(const TraceEvent &event,   \
+				       StringPool<> *pool)	   \
+{							           \
+	if (TT == TRACE_TYPE_FTRACE)				   \
+		return ftrace_##FNAME(event, pool);		   \
+	else /* (TT == TRACE_TYPE_PERF) */			   \
+		return perf_##FNAME(event, pool);		   \
+}								   \
+								   \
 static vtl_always_inline RETTYPE FNAME(tracetype_t tt,	  	   \
 				       const TraceEvent &event,	   \
 				       StringPool<> *pool)	   \
 {							           \
 	if (tt == TRACE_TYPE_FTRACE)				   \
-		return ftrace_##FNAME(event, pool);		   \
+		return FNAME<TRACE_TYPE_FTRACE>(event, pool);	   \
 	else /* (tt == TRACE_TYPE_PERF) */			   \
-		return perf_##FNAME(event, pool);		   \
+		return FNAME<TRACE_TYPE_PERF>(event, pool);	   \
 }
 
 #define DECLARE_GENERIC_TRACEFN_HANDLE(FNAME, RETTYPE, HANDLETYPE)	\
+	template<tracetype_t TT>					\
+	static vtl_always_inline RETTYPE FNAME(const TraceEvent &event,	\
+					       HANDLETYPE handle	\
+		)							\
+	{								\
+		if (TT == TRACE_TYPE_FTRACE)				\
+			return ftrace_##FNAME(event, handle);		\
+		else /* (TT == TRACE_TYPE_PERF) */			\
+			return perf_##FNAME(event, handle);		\
+	}								\
+									\
 	static vtl_always_inline RETTYPE FNAME(tracetype_t tt,		\
 					       const TraceEvent &event,	\
 					       HANDLETYPE handle	\
 		)							\
 	{								\
 		if (tt == TRACE_TYPE_FTRACE)				\
-			return ftrace_##FNAME(event, handle);		\
+			return FNAME<TRACE_TYPE_FTRACE>(event, handle);	\
 		else /* (tt == TRACE_TYPE_PERF) */			\
-			return perf_##FNAME(event, handle);		\
+			return FNAME<TRACE_TYPE_PERF>(event, handle);	\
 	}
 
 
 #define DECLARE_GENERIC_TRACEFN_POOL_HANDLE(FNAME, RETTYPE, HANDLETYPE)	\
+	template<tracetype_t TT>					\
+	static vtl_always_inline RETTYPE FNAME(const TraceEvent &event,	\
+					       StringPool<> *pool,	\
+					       HANDLETYPE handle)	\
+	{								\
+		if (TT == TRACE_TYPE_FTRACE)				\
+			return ftrace_##FNAME(event, pool, handle);	\
+		else /* (TT == TRACE_TYPE_PERF) */			\
+			return perf_##FNAME(event, pool, handle);	\
+	}								\
+									\
 	static vtl_always_inline RETTYPE FNAME(tracetype_t tt,		\
 					       const TraceEvent &event,	\
 					       StringPool<> *pool,	\
 					       HANDLETYPE handle)	\
 	{								\
 		if (tt == TRACE_TYPE_FTRACE)				\
-			return ftrace_##FNAME(event, pool, handle);	\
+			return FNAME<TRACE_TYPE_FTRACE>(event, pool,	\
+							handle);	\
 		else /* (tt == TRACE_TYPE_PERF) */			\
-			return perf_##FNAME(event, pool, handle);	\
+			return FNAME<TRACE_TYPE_PERF>(event, pool,	\
+						      handle);		\
 	}
 
 DECLARE_GENERIC_TRACEFN(cpufreq_args_ok, bool)
@@ -57,7 +57,7 @@
 #include "parser/traceevent.h"
 
 PerfGrammar::PerfGrammar() :
-	unknownTypeCounter(EVENT_UNKNOWN)
+	timePrecision(0), unknownTypeCounter(EVENT_UNKNOWN)
 {
 	argPool = new StringPool<>(2048, 1024 * 1024);
 	namePool =  new StringPool<>(1024, 65536);
@@ -79,6 +79,7 @@ void PerfGrammar::clear()
 	eventTree->clear();
 	setupEventTree();
 	unknownTypeCounter = EVENT_UNKNOWN;
+	timePrecision = 0;
 }
 
 void PerfGrammar::setupEventTree()
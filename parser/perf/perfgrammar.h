@@ -76,6 +76,9 @@ public:
 	void clear();
 	vtl_always_inline bool parseLine(TraceLine &line, TraceEvent &event);
 	StringTree<> *eventTree;
+	/* The highest number of decimals seen in a timestamp */
+	unsigned int timePrecision;
+	vtl_always_inline const StringPool<> *getArgPool() const;
 private:
 	void setupEventTree();
 	vtl_always_inline bool StoreMatch(TString *str, TraceEvent &event);
@@ -108,6 +111,11 @@ private:
 	} grammarstate_t;
 };
 
+vtl_always_inline const StringPool<> *PerfGrammar::getArgPool() const
+{
+	return argPool;
+}
+
 vtl_always_inline bool PerfGrammar::StoreMatch(TString *str, TraceEvent &event)
 {
 	/*
@@ -224,6 +232,7 @@ vtl_always_inline int PerfGrammar::pidFromString(const TString &str, bool &ok)
 vtl_always_inline bool PerfGrammar::TimeMatch(TString *str, TraceEvent &event)
 {
 	bool rval;
+	vtl::Time time;
 	TString namestr;
 	const TString *newname;
 	char cstr[256];
@@ -236,7 +245,8 @@ vtl_always_inline bool PerfGrammar::TimeMatch(TString *str, TraceEvent &event)
 	namestr.len = 0;
 
 	/* atof() and sscanf() are buggy. */
-	event.time = vtl::Time::fromString(str->ptr, rval);
+	time = vtl::Time::fromString(str->ptr, rval);
+	event.time = time;
 
 	/*
 	 * This is the time field, if it is successful we need to assemble
@@ -244,6 +254,8 @@ vtl_always_inline bool PerfGrammar::TimeMatch(TString *str, TraceEvent &event)
 	 * argv/argc.
 	 */
 	if (rval) {
+		if (time.getPrecision() > timePrecision)
+			timePrecision = time.getPrecision();
 		if (event.argc < 3)
 			return false;
 
@@ -259,9 +271,9 @@ vtl_always_inline bool PerfGrammar::TimeMatch(TString *str, TraceEvent &event)
 					return false;
 			}
 
-			newname = namePool->allocString(&namestr, 0);
+			newname = namePool->allocString(&namestr);
 		} else {
-			newname = namePool->allocString(event.argv[0], 0);
+			newname = namePool->allocString(event.argv[0]);
 		}
 		if (newname == nullptr)
 			return false;
@@ -263,7 +263,7 @@ perf_sched_switch_handle_newname_strdup_(const TraceEvent &event,
 	}
 
 	ts.len = len;
-	retstr = pool->allocString(&ts, 0);
+	retstr = pool->allocString(&ts);
 	if (retstr == nullptr)
 		return NullStr;
 
@@ -329,7 +329,7 @@ perf_sched_switch_handle_oldname_strdup_(const TraceEvent &event,
 			return NullStr;
 	}
 	ts.len = len;
-	retstr = pool->allocString(&ts, 0);
+	retstr = pool->allocString(&ts);
 	if (retstr == nullptr)
 		return NullStr;
 
@@ -537,7 +537,7 @@ perf_sched_wakeup_name_strdup_(const TraceEvent &event, StringPool<> *pool)
 		return NullStr;
 
 	ts.len = len;
-	retstr = pool->allocString(&ts, 0);
+	retstr = pool->allocString(&ts);
 	if (retstr == nullptr)
 		return NullStr;
 
@@ -627,7 +627,7 @@ perf_sched_process_fork_childname_strdup_(const TraceEvent &event,
 		return NullStr;
 
 	ts.len = len;
-	retstr = pool->allocString(&ts, 0);
+	retstr = pool->allocString(&ts);
 	if (retstr == nullptr)
 		return NullStr;
 
@@ -0,0 +1,230 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef SCHEDRECORD_H
+#define SCHEDRECORD_H
+
+#include <cstdint>
+
+#include "parser/genericparams.h"
+#include "parser/paramhelpers.h"
+#include "parser/traceevent.h"
+#include "misc/traceshark.h"
+#include "misc/types.h"
+#include "vtl/compiler.h"
+
+/*
+ * A SchedRecord holds the numeric arguments of a scheduling or power event,
+ * decoded once by the parser when the event is committed. There is exactly
+ * one record for each event in the events list, so that the record of an
+ * event can be found with the same index. Events that are not decoded get a
+ * record without the SCHEDRECORD_VALID flag.
+ *
+ * The meaning of the fields depends on the event type:
+ *
+ * SCHED_SWITCH:	pid = oldpid, pid2 = newpid, value = state
+ * SCHED_WAKEUP(_NEW):	pid = pid, cpu = target cpu
+ * SCHED_WAKING:	pid = pid, cpu = target cpu
+ * SCHED_MIGRATE_TASK:	pid = pid, cpu = dest cpu, value = orig cpu
+ * SCHED_PROCESS_FORK:	pid = child pid, pid2 = parent pid
+ * SCHED_PROCESS_EXIT:	pid = pid
+ * CPU_FREQUENCY:	cpu = cpu, value = freq
+ * CPU_IDLE:		cpu = cpu, value = state
+ *
+ * Task names are not decoded here, they are only needed when a task is seen
+ * for the first time and are then extracted from the event. For
+ * sched_switch, the handle is stored so that the names can be found without
+ * parsing the arguments again.
+ */
+
+#define SCHEDRECORD_VALID	(0x01)
+#define SCHEDRECORD_SUCCESS	(0x02)
+
+class SchedRecord {
+public:
+	int pid;
+	int pid2;
+	unsigned int cpu;
+	int32_t value;
+	int16_t handleIndex;
+	uint8_t handleFormat;
+	uint8_t flags;
+	template<tracetype_t TT>
+		vtl_always_inline void decode(const TraceEvent &event);
+	vtl_always_inline bool isValid() const;
+	vtl_always_inline bool isSuccess() const;
+	vtl_always_inline taskstate_t state() const;
+	template<tracetype_t TT>
+		vtl_always_inline void getHandle(sched_switch_handle &handle)
+		const;
+private:
+	template<tracetype_t TT>
+		vtl_always_inline void setHandle(
+			const sched_switch_handle &handle);
+};
+
+vtl_always_inline bool SchedRecord::isValid() const
+{
+	return (flags & SCHEDRECORD_VALID) != 0;
+}
+
+vtl_always_inline bool SchedRecord::isSuccess() const
+{
+	return (flags & SCHEDRECORD_SUCCESS) != 0;
+}
+
+vtl_always_inline taskstate_t SchedRecord::state() const
+{
+	return (taskstate_t) value;
+}
+
+template<tracetype_t TT>
+vtl_always_inline void SchedRecord::getHandle(sched_switch_handle &handle)
+	const
+{
+	if (TT == TRACE_TYPE_FTRACE) {
+		handle.ftrace.format = (ftraceschedformat_t) handleFormat;
+		handle.ftrace.index = handleIndex;
+	} else {
+		handle.perf.is_distro_style = handleFormat != 0;
+		handle.perf.index = handleIndex;
+	}
+}
+
+template<tracetype_t TT>
+vtl_always_inline void SchedRecord::setHandle(
+	const sched_switch_handle &handle)
+{
+	if (TT == TRACE_TYPE_FTRACE) {
+		handleFormat = (uint8_t) handle.ftrace.format;
+		handleIndex = (int16_t) handle.ftrace.index;
+	} else {
+		handleFormat = handle.perf.is_distro_style ? 1 : 0;
+		handleIndex = (int16_t) handle.perf.index;
+	}
+}
+
+template<tracetype_t TT>
+vtl_always_inline void SchedRecord::decode(const TraceEvent &event)
+{
+	sched_switch_handle handle;
+
+	pid = INT_MAX;
+	pid2 = INT_MAX;
+	cpu = 0;
+	value = 0;
+	handleIndex = 0;
+	handleFormat = 0;
+	flags = 0;
+
+	switch (event.type) {
+	case SCHED_SWITCH:
+		if (!sched_switch_parse<TT>(event, handle))
+			return;
+		pid = sched_switch_handle_oldpid<TT>(event, handle);
+		pid2 = sched_switch_handle_newpid<TT>(event, handle);
+		value = (int32_t) sched_switch_handle_state<TT>(event, handle);
+		setHandle<TT>(handle);
+		break;
+	case SCHED_WAKEUP:
+	case SCHED_WAKEUP_NEW:
+		if (!sched_wakeup_args_ok<TT>(event))
+			return;
+		pid = sched_wakeup_pid<TT>(event);
+		cpu = sched_wakeup_cpu<TT>(event);
+		if (sched_wakeup_success<TT>(event))
+			flags |= SCHEDRECORD_SUCCESS;
+		break;
+	case SCHED_WAKING:
+		if (!sched_waking_args_ok<TT>(event))
+			return;
+		pid = sched_waking_pid<TT>(event);
+		cpu = sched_waking_cpu<TT>(event);
+		break;
+	case SCHED_MIGRATE_TASK:
+		if (!sched_migrate_args_ok<TT>(event))
+			return;
+		pid = sched_migrate_pid<TT>(event);
+		cpu = sched_migrate_destCPU<TT>(event);
+		value = (int32_t) sched_migrate_origCPU<TT>(event);
+		break;
+	case SCHED_PROCESS_FORK:
+		if (!sched_process_fork_args_ok<TT>(event))
+			return;
+		pid = sched_process_fork_childpid<TT>(event);
+		pid2 = sched_process_fork_parent_pid<TT>(event);
+		break;
+	case SCHED_PROCESS_EXIT:
+		if (!sched_process_exit_args_ok<TT>(event))
+			return;
+		pid = sched_process_exit_pid<TT>(event);
+		break;
+	case CPU_FREQUENCY:
+		if (!cpufreq_args_ok<TT>(event))
+			return;
+		cpu = cpufreq_cpu<TT>(event);
+		value = (int32_t) cpufreq_freq<TT>(event);
+		break;
+	case CPU_IDLE:
+		if (!cpuidle_args_ok<TT>(event))
+			return;
+		cpu = cpuidle_cpu<TT>(event);
+		value = cpuidle_state<TT>(event);
+		break;
+	default:
+		return;
+	}
+	flags |= SCHEDRECORD_VALID;
+}
+
+#endif /* SCHEDRECORD_H */
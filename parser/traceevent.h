@@ -157,7 +157,7 @@ public:
 	int pid;
 	unsigned int cpu;
 	const TString *flagstr;
-	vtl::Time time;
+	vtl::CompactTime time;
 	int intArg;
 	event_t type;
 	const TString **argv;
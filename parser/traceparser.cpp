@@ -73,7 +73,7 @@
 #define TRACE_TYPE_CONFIDENCE_FACTOR (100)
 
 TraceParser::TraceParser()
-	: traceType(TRACE_TYPE_UNKNOWN), events(nullptr)
+	: traceType(TRACE_TYPE_UNKNOWN), events(nullptr), records(nullptr)
 {
 	traceFile = nullptr;
 	ptrPool = new MemPool(16384, sizeof(TString*));
@@ -91,6 +91,8 @@ TraceParser::TraceParser()
 	traceTypeWatcher = new IndexWatcher;
 	ftraceEvents = new vtl::TList<TraceEvent>();
 	perfEvents = new vtl::TList<TraceEvent>();
+	ftraceRecords = new vtl::TList<SchedRecord>();
+	perfRecords = new vtl::TList<SchedRecord>();
 
 	fakeEvent.clear();
 
@@ -115,6 +117,8 @@ TraceParser::~TraceParser()
 	delete traceTypeWatcher;
 	delete ftraceEvents;
 	delete perfEvents;
+	delete ftraceRecords;
+	delete perfRecords;
 }
 
 int TraceParser::open(const QString &fileName)
@@ -163,9 +167,12 @@ void TraceParser::close(int *ts_errno)
 	postEventPool->reset();
 	perfGrammar->clear();
 	perfEvents->clear();
+	perfRecords->clear();
 	ftraceGrammar->clear();
 	ftraceEvents->clear();
+	ftraceRecords->clear();
 	events = nullptr;
+	records = nullptr;
 	traceType = TRACE_TYPE_UNKNOWN;
 }
 
@@ -286,6 +293,13 @@ out:
 	 */
 	fixLastEvent();
 
+	/*
+	 * The precision was set from the timestamps that had been parsed when
+	 * the trace type was determined. A later timestamp may have had more
+	 * decimals, so update it before the analyzer sees the end of the trace.
+	 */
+	vtl::CompactTime::raisePrecision(grammarTimePrecision());
+
 	eventsWatcher->sendNextIndex(events->size());
 	eventsWatcher->sendEOF();
 
@@ -295,7 +309,7 @@ out:
 
 void TraceParser::waitForTraceType()
 {
-	int index;
+	int64_t index;
 	bool eof = false;
 	while (!eof)
 		traceTypeWatcher->waitForNextBatch(eof, index);
@@ -303,9 +317,22 @@ void TraceParser::waitForTraceType()
 
 void TraceParser::sendTraceType()
 {
+	/*
+	 * The events only store the nanoseconds of the timestamps, the
+	 * precision is the same for the whole trace and it is set here, before
+	 * anyone gets to see the events.
+	 */
+	vtl::CompactTime::setPrecision(grammarTimePrecision());
 	traceTypeWatcher->sendEOF();
 }
 
+unsigned int TraceParser::grammarTimePrecision() const
+{
+	if (traceType == TRACE_TYPE_FTRACE)
+		return ftraceGrammar->timePrecision;
+	return perfGrammar->timePrecision;
+}
+
 void TraceParser::prepareParse()
 {
 	fakePostEventInfo.offset = 0;
@@ -322,7 +349,10 @@ void TraceParser::prepareParse()
 
 	ftraceEvents->clear();
 	perfEvents->clear();
+	ftraceRecords->clear();
+	perfRecords->clear();
 	events = nullptr;
+	records = nullptr;
 }
 
 void TraceParser::clearFtraceStackData()
@@ -442,6 +472,7 @@ void TraceParser::determineTraceType()
 		traceType = TRACE_TYPE_FTRACE;
 		TraceEvent::setStringTree(ftraceGrammar->eventTree);
 		events = ftraceEvents;
+		records = ftraceRecords;
 		sendTraceType();
 		return;
 	} else if (perfLineData.nrEvents > (TSMAX(1, ftraceLineData.nrEvents)
@@ -449,6 +480,7 @@ void TraceParser::determineTraceType()
 		traceType = TRACE_TYPE_PERF;
 		TraceEvent::setStringTree(perfGrammar->eventTree);
 		events = perfEvents;
+		records = perfRecords;
 		sendTraceType();
 		return;
 	}
@@ -461,14 +493,17 @@ void TraceParser::guessTraceType()
 		traceType = TRACE_TYPE_PERF;
 		TraceEvent::setStringTree(perfGrammar->eventTree);
 		events = perfEvents;
+		records = perfRecords;
 	} else if (perfLineData.nrEvents < ftraceLineData.nrEvents) {
 		traceType = TRACE_TYPE_FTRACE;
 		TraceEvent::setStringTree(ftraceGrammar->eventTree);
 		events = ftraceEvents;
+		records = ftraceRecords;
 	} else {
 		traceType = TRACE_TYPE_UNKNOWN;
 		TraceEvent::setStringTree(perfGrammar->eventTree);
 		events = perfEvents;
+		records = perfRecords;
 	}
 	sendTraceType();
 }
@@ -56,6 +56,7 @@
 #include <QVector>
 
 #include "parser/genericparams.h"
+#include "parser/schedrecord.h"
 #include "parser/ftrace/ftracegrammar.h"
 #include "parser/perf/perfgrammar.h"
 #include "mm/mempool.h"
@@ -92,10 +93,12 @@ public:
 	void threadParser();
 	void threadReader();
 	vtl_always_inline vtl::TList<TraceEvent> *getEventsTList() const;
+	vtl_always_inline vtl::TList<SchedRecord> *getRecordsTList() const;
 	const StringTree<> *getPerfEventTree();
 	const StringTree<> *getFtraceEventTree();
+	vtl_always_inline const StringPool<> *getArgPool() const;
 protected:
-	vtl_always_inline void waitForNextBatch(bool &eof, int &index);
+	vtl_always_inline void waitForNextBatch(bool &eof, eventidx_t &index);
 	void waitForTraceType();
 	tracetype_t traceType;
 	TraceFile *traceFile;
@@ -103,6 +106,7 @@ private:
 	void determineTraceType();
 	void guessTraceType();
 	void sendTraceType();
+	unsigned int grammarTimePrecision() const;
 	void prepareParse();
 	vtl_always_inline bool parseBuffer_(tracetype_t ttppe,
 					    unsigned int index);
@@ -148,13 +152,34 @@ private:
 	vtl::TList<TraceEvent> *ftraceEvents;
 	vtl::TList<TraceEvent> *perfEvents;
 	vtl::TList<TraceEvent> *events;
+	/*
+	 * These contain one SchedRecord for each event in the corresponding
+	 * events list above, with the same index.
+	 */
+	vtl::TList<SchedRecord> *ftraceRecords;
+	vtl::TList<SchedRecord> *perfRecords;
+	vtl::TList<SchedRecord> *records;
 	IndexWatcher *eventsWatcher;
 	/* This IndexWatcher isn't really watching an index, it's to synchronize
 	 * when traceType has been determined in the parser thread */
 	IndexWatcher *traceTypeWatcher;
 };
 
-vtl_always_inline void TraceParser::waitForNextBatch(bool &eof, int &index)
+/* Returns the pool where the arguments of the events are interned */
+vtl_always_inline const StringPool<> *TraceParser::getArgPool() const
+{
+	switch (traceType) {
+	case TRACE_TYPE_FTRACE:
+		return ftraceGrammar->getArgPool();
+	case TRACE_TYPE_PERF:
+		return perfGrammar->getArgPool();
+	default:
+		return nullptr;
+	}
+}
+
+vtl_always_inline void TraceParser::waitForNextBatch(bool &eof,
+						     eventidx_t &index)
 {
 	eventsWatcher->waitForNextBatch(eof, index);
 }
@@ -271,6 +296,7 @@ vtl_always_inline bool TraceParser::parseLineFtrace(TraceLine &line,
 
 		ptrPool->commitN(event.argc);
 		ftraceEvents->commit();
+		ftraceRecords->increase().decode<TRACE_TYPE_FTRACE>(event);
 
 		event.postEventInfo = nullptr;
 		ftraceSetLastEventForCPU(event.cpu, &event);
@@ -296,6 +322,7 @@ vtl_always_inline bool TraceParser::parseLinePerf(TraceLine &line,
 
 		ptrPool->commitN(event.argc);
 		perfEvents->commit();
+		perfRecords->increase().decode<TRACE_TYPE_PERF>(event);
 
 		if (perfLineData.prevLineIsEvent) {
 			perfLineData.prevEvent->postEventInfo = nullptr;
@@ -325,4 +352,10 @@ vtl_always_inline vtl::TList<TraceEvent> *TraceParser::getEventsTList() const
 	return events;
 }
 
+vtl_always_inline
+vtl::TList<SchedRecord> *TraceParser::getRecordsTList() const
+{
+	return records;
+}
+
 #endif /* TRACEPARSER_H */
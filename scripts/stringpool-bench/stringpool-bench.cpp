@@ -0,0 +1,270 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * A microbenchmark that compares the StringPool with the OldStringPool, which
+ * was used before the StringPool became an open addressing table. It feeds
+ * both with the argument strings of a synthetic ftrace trace, or of a real
+ * trace file, in the same way as the grammars do, with a cutoff of 16.
+ *
+ * It can be built from the top directory of traceshark with:
+ *
+ * moc threads/tthread.h -o moc_tthread.cpp
+ * g++ -O2 -fPIC -I. $(pkg-config --cflags Qt5Widgets) \
+ *	scripts/stringpool-bench/stringpool-bench.cpp parser/fileinfo.cpp \
+ *	parser/traceevent.cpp parser/tracefile.cpp parser/traceparser.cpp \
+ *	parser/ftrace/ftracegrammar.cpp parser/ftrace/ftraceparams.cpp \
+ *	parser/perf/perfgrammar.cpp parser/perf/perfparams.cpp \
+ *	threads/indexwatcher.cpp threads/loadbuffer.cpp threads/loadthread.cpp \
+ *	threads/tthread.cpp threads/workqueue.cpp moc_tthread.cpp mm/mempool.cpp \
+ *	misc/errors.cpp misc/qtcompat.cpp misc/traceshark.cpp vtl/error.cpp \
+ *	vtl/time.cpp $(pkg-config --libs Qt5Widgets) -o stringpool-bench
+ *
+ * The optional argument is the number of synthetic tokens, in millions. With
+ * -f <file>, the tokens are instead the arguments of the events in the ftrace
+ * or perf trace file, as they are read by the TraceParser.
+ */
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <QString>
+
+#include "misc/errors.h"
+#include "mm/stringpool.h"
+#include "parser/traceevent.h"
+#include "parser/traceparser.h"
+#include "scripts/stringpool-bench/oldstringpool.h"
+#include "vtl/tlist.h"
+
+#define BENCH_NR_PIDS (3000)
+#define BENCH_NR_CPUS (16)
+#define BENCH_CUTOFF (16)
+#define BENCH_ROUNDS (3)
+
+static const char * const comms[] = {
+	"swapper/0", "kworker/u16:2", "Xorg", "chrome", "rcu_sched",
+	"ksoftirqd/3", "gnome-shell", "pulseaudio", "bash", "make", "cc1plus",
+	"ld"
+};
+
+#define NR_COMMS (sizeof(comms) / sizeof(comms[0]))
+
+static void add(std::vector<std::string> &v, const char *fmt, ...)
+	__attribute__((format(printf, 2, 3)));
+
+static void add(std::vector<std::string> &v, const char *fmt, ...)
+{
+	char buf[128];
+	va_list ap;
+
+	va_start(ap, fmt);
+	vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+	v.push_back(buf);
+}
+
+static std::mt19937 rng(1);
+
+static vtl_always_inline unsigned int rnd(unsigned int n)
+{
+	return (unsigned int) (rng() % n);
+}
+
+/*
+ * The mix is 60% sched_switch, 25% sched_wakeup, 10% cpu_frequency and 5%
+ * events with an argument that is unique, like an address.
+ */
+static void generate(std::vector<std::string> &v, size_t n)
+{
+	unsigned int r, p1, p2;
+
+	v.reserve(n + 8);
+	while (v.size() < n) {
+		r = rnd(20);
+		p1 = rnd(BENCH_NR_PIDS);
+		p2 = rnd(BENCH_NR_PIDS);
+		if (r < 12) {
+			add(v, "prev_comm=%s", comms[p1 % NR_COMMS]);
+			add(v, "prev_pid=%u", p1);
+			add(v, "prev_prio=%u", 100 + rnd(40));
+			add(v, "prev_state=%s", rnd(2) ? "S" : "R+");
+			add(v, "==>");
+			add(v, "next_comm=%s", comms[p2 % NR_COMMS]);
+			add(v, "next_pid=%u", p2);
+			add(v, "next_prio=%u", 100 + rnd(40));
+		} else if (r < 17) {
+			add(v, "comm=%s", comms[p1 % NR_COMMS]);
+			add(v, "pid=%u", p1);
+			add(v, "prio=%u", 100 + rnd(40));
+			add(v, "target_cpu=%03u", rnd(BENCH_NR_CPUS));
+		} else if (r < 19) {
+			add(v, "state=%u", 800000 + rnd(30) * 100000);
+			add(v, "cpu_id=%u", rnd(BENCH_NR_CPUS));
+		} else {
+			add(v, "ptr=0x%08x%08x", (unsigned int) rng(),
+			    (unsigned int) rng());
+		}
+	}
+}
+
+/* Gives access to the functions that the TraceAnalyzer uses */
+class BenchParser : public TraceParser {
+public:
+	using TraceParser::waitForNextBatch;
+	using TraceParser::waitForTraceType;
+};
+
+/*
+ * The parser has interned the arguments in its own pool, so we copy the
+ * strings of the events. This gives the tokens that the grammar has fed to
+ * its pool, in the same order.
+ */
+static bool readTrace(std::vector<std::string> &v, const char *fileName)
+{
+	BenchParser *parser = new BenchParser();
+	vtl::TList<TraceEvent> *events;
+	eventidx_t i, nr = 0;
+	bool eof = false;
+	int ts_errno, j;
+
+	ts_errno = parser->open(QString(fileName));
+	if (ts_errno != 0) {
+		fprintf(stderr, "Failed to open %s: %s\n", fileName,
+			ts_strerror(ts_errno));
+		delete parser;
+		return false;
+	}
+
+	parser->waitForTraceType();
+	while (!eof)
+		parser->waitForNextBatch(eof, nr);
+
+	events = parser->getEventsTList();
+	for (i = 0; i < nr; i++) {
+		const TraceEvent &event = (*events)[i];
+		for (j = 0; j < event.argc; j++)
+			v.push_back(std::string(event.argv[j]->ptr,
+						event.argv[j]->len));
+	}
+
+	parser->close(&ts_errno);
+	delete parser;
+	return true;
+}
+
+template<typename Pool>
+static double run(Pool *pool, const std::vector<TString> &tokens)
+{
+	std::chrono::steady_clock::time_point t0, t1;
+	size_t i;
+
+	t0 = std::chrono::steady_clock::now();
+	for (i = 0; i < tokens.size(); i++) {
+		if (pool->allocString(&tokens[i], BENCH_CUTOFF) == nullptr) {
+			fprintf(stderr, "allocString() failed\n");
+			exit(1);
+		}
+	}
+	t1 = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(t1 - t0).count();
+}
+
+int main(int argc, char *argv[])
+{
+	std::vector<std::string> strings;
+	std::vector<TString> tokens;
+	size_t n = 20;
+	double told, tnew;
+	uint64_t interned;
+	size_t i;
+	int round;
+
+	if (argc > 2 && strcmp(argv[1], "-f") == 0) {
+		if (!readTrace(strings, argv[2]))
+			return 1;
+	} else {
+		if (argc > 1)
+			n = strtoul(argv[1], nullptr, 10);
+		n *= 1000000;
+		generate(strings, n);
+	}
+	tokens.resize(strings.size());
+	for (i = 0; i < strings.size(); i++) {
+		tokens[i].ptr = (char *) strings[i].c_str();
+		tokens[i].len = strings[i].size();
+	}
+
+	/* Same parameters as the argPool of the ftrace grammar */
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		OldStringPool<> *oldPool =
+			new OldStringPool<>(2048, 1024 * 1024);
+		StringPool<> *newPool = new StringPool<>(2048, 1024 * 1024);
+
+		told = run(oldPool, tokens);
+		tnew = run(newPool, tokens);
+		interned = newPool->size();
+		printf("%zu tokens: old %.1f ns/token, new %.1f ns/token, "
+		       "%llu strings interned\n", tokens.size(),
+		       told * 1e9 / tokens.size(), tnew * 1e9 / tokens.size(),
+		       (unsigned long long) interned);
+		delete oldPool;
+		delete newPool;
+	}
+	return 0;
+}
@@ -1,7 +1,7 @@
 // SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
 /*
  * Traceshark - a visualizer for visualizing ftrace and perf traces
- * Copyright (C) 2015, 2017, 2020  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
  *
  * This file is dual licensed: you can use it either under the terms of
  * the GPL, or the BSD license, at your option.
@@ -50,20 +50,54 @@
  *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifndef MIGRATIONARROW_H
-#define MIGRATIONARROW_H
+#include "threads/backgroundjob.h"
 
-#include <QColor>
-#include "ui/qcustomplot.h"
+JobControl::JobControl():
+	canceled(0), done(0), total(0)
+{}
 
-class MigrationArrow : public QCPItemLine
+void JobControl::cancel()
 {
-	Q_OBJECT
-public:
-	MigrationArrow(double start, double end, double time,
-		       const QColor &color, QCustomPlot *parent, int width);
-private:
-	QCPLineEnding head;
-};
+	canceled.storeRelease(1);
+}
 
-#endif /* MIGRATIONARROW_H */
+/* Sets the number of steps that the job will advance() */
+void JobControl::setTotal(int t)
+{
+	done.storeRelease(0);
+	total.storeRelease(t);
+}
+
+/* For jobs that count their progress in larger units than int */
+void JobControl::setProgress(int64_t d, int64_t t)
+{
+	if (t <= 0)
+		return;
+	total.storeRelease(1000);
+	done.storeRelease((int) (d * 1000 / t));
+}
+
+/* Returns the progress in permille, or -1 if it is unknown */
+int JobControl::progress() const
+{
+	int t = total.loadAcquire();
+	int d = done.loadAcquire();
+
+	if (t <= 0)
+		return -1;
+	if (d >= t)
+		return 1000;
+	return (int) ((int64_t) d * 1000 / t);
+}
+
+BackgroundJob::BackgroundJob(kind_t k):
+	kind(k), generation(0)
+{}
+
+BackgroundJob::~BackgroundJob()
+{}
+
+bool BackgroundJob::supersedes() const
+{
+	return true;
+}
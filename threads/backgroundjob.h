@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BACKGROUNDJOB_H
+#define BACKGROUNDJOB_H
+
+#include <cstdint>
+
+#include <QAtomicInt>
+
+#include "vtl/compiler.h"
+
+/*
+ * The state that a running job shares with the rest of the program. The job
+ * should check isCanceled() at regular intervals and report its progress, the
+ * other functions may be called from any thread.
+ */
+class JobControl {
+public:
+	JobControl();
+	void cancel();
+	vtl_always_inline bool isCanceled() const;
+	void setTotal(int total);
+	vtl_always_inline void advance(int n = 1);
+	void setProgress(int64_t done, int64_t total);
+	int progress() const;
+private:
+	QAtomicInt canceled;
+	QAtomicInt done;
+	QAtomicInt total;
+};
+
+vtl_always_inline bool JobControl::isCanceled() const
+{
+	return canceled.loadAcquire() != 0;
+}
+
+vtl_always_inline void JobControl::advance(int n)
+{
+	done.fetchAndAddRelaxed(n);
+}
+
+/*
+ * A piece of work that is executed by the JobRunner. The run() function is
+ * called in the thread of the JobRunner and must only store its results in
+ * the job object, they are handed over to the GUI thread with the
+ * JobRunner::jobFinished() signal.
+ */
+class BackgroundJob {
+public:
+	typedef enum : int {
+		JOB_FILTER = 0,
+		JOB_STATS_LIMITED,
+		JOB_LATENCY_SORT,
+		JOB_EXPORT_EVENTS,
+		JOB_EXPORT_LATENCIES,
+		JOB_NR_KINDS
+	} kind_t;
+	BackgroundJob(kind_t k);
+	virtual ~BackgroundJob();
+	virtual void run() = 0;
+	/*
+	 * Returns true if a newly submitted job should cancel the older jobs
+	 * of the same kind, otherwise they are all executed in order.
+	 */
+	virtual bool supersedes() const;
+	kind_t kind;
+	unsigned int generation;
+	JobControl control;
+};
+
+#endif /* BACKGROUNDJOB_H */
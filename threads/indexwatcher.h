@@ -53,6 +53,8 @@
 #ifndef INDEXWATCHER_H
 #define INDEXWATCHER_H
 
+#include <cstdint>
+
 #include <QMutex>
 #include <QWaitCondition>
 
@@ -63,22 +65,23 @@ class IndexWatcher
 public:
 	IndexWatcher(int bSize = 100);
 	void setBatchSize(int bSize);
-	vtl_always_inline void waitForNextBatch(bool &eof, int &index);
-	vtl_always_inline void sendNextIndex(int index);
+	vtl_always_inline void waitForNextBatch(bool &eof, int64_t &index);
+	vtl_always_inline void sendNextIndex(int64_t index);
 	void sendEOF();
 	void reset();
 private:
 	int batchSize;
 	bool isEOF;
 	/* This is the highest index posted by the producer */
-	int postedIndex;
+	int64_t postedIndex;
 	/* This is the higher index being received by the consumer */
-	int receivedIndex;
+	int64_t receivedIndex;
 	QMutex mutex;
 	QWaitCondition batchCompleted;
 };
 
-vtl_always_inline void IndexWatcher::waitForNextBatch(bool &eof, int &index)
+vtl_always_inline void IndexWatcher::waitForNextBatch(bool &eof,
+						      int64_t &index)
 {
 	mutex.lock();
 	while(!isEOF && postedIndex - receivedIndex < batchSize) {
@@ -90,7 +93,7 @@ vtl_always_inline void IndexWatcher::waitForNextBatch(bool &eof, int &index)
 	mutex.unlock();
 }
 
-vtl_always_inline void IndexWatcher::sendNextIndex(int index)
+vtl_always_inline void IndexWatcher::sendNextIndex(int64_t index)
 {
 	mutex.lock();
 	if (index <= postedIndex)
@@ -0,0 +1,271 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <QMetaObject>
+#include <QTimer>
+
+#include "misc/traceshark.h"
+#include "threads/jobrunner.h"
+
+#define JOBRUNNER_POLL_MSEC (100)
+
+JobRunner::JobRunner(QObject *parent):
+	QObject(parent), running(nullptr), exiting(false), busy(false)
+{
+	int i;
+
+	for (i = 0; i < BackgroundJob::JOB_NR_KINDS; i++)
+		generation[i] = 0;
+
+	progressTimer = new QTimer(this);
+	progressTimer->setInterval(JOBRUNNER_POLL_MSEC);
+	tsconnect(progressTimer, timeout(), this, pollProgress());
+
+	thread = new WorkThread<JobRunner>(QString("JobRunner"), this,
+					   &JobRunner::threadLoop);
+	thread->start();
+}
+
+JobRunner::~JobRunner()
+{
+	int i;
+
+	mutex.lock();
+	exiting = true;
+	for (i = 0; i < BackgroundJob::JOB_NR_KINDS; i++)
+		cancel_((BackgroundJob::kind_t) i);
+	workCond.wakeAll();
+	mutex.unlock();
+
+	thread->wait();
+	delete thread;
+
+	for (i = 0; i < finished.size(); i++)
+		delete finished[i];
+}
+
+/* Must be called with the mutex held */
+void JobRunner::cancel_(BackgroundJob::kind_t kind)
+{
+	int i;
+
+	generation[kind]++;
+	for (i = 0; i < queue.size(); ) {
+		if (queue[i]->kind == kind) {
+			delete queue[i];
+			queue.removeAt(i);
+		} else {
+			i++;
+		}
+	}
+	if (running != nullptr && running->kind == kind)
+		running->control.cancel();
+}
+
+/* Must be called with the mutex held */
+bool JobRunner::isCurrent(const BackgroundJob *job) const
+{
+	if (job->control.isCanceled())
+		return false;
+	return !job->supersedes() || job->generation == generation[job->kind];
+}
+
+/* Takes the ownership of the job */
+void JobRunner::submit(BackgroundJob *job)
+{
+	mutex.lock();
+	if (job->supersedes())
+		cancel_(job->kind);
+	job->generation = generation[job->kind];
+	queue.append(job);
+	workCond.wakeOne();
+	mutex.unlock();
+
+	if (!busy) {
+		busy = true;
+		progressTimer->start();
+		emit busyChanged(true);
+	}
+}
+
+/* Cancels the queued and running jobs of kind */
+void JobRunner::cancel(BackgroundJob::kind_t kind)
+{
+	mutex.lock();
+	cancel_(kind);
+	mutex.unlock();
+}
+
+void JobRunner::cancelAll()
+{
+	int i;
+
+	mutex.lock();
+	for (i = 0; i < BackgroundJob::JOB_NR_KINDS; i++)
+		cancel_((BackgroundJob::kind_t) i);
+	mutex.unlock();
+}
+
+/*
+ * Waits until all jobs have been executed and delivers the results of those
+ * that have not been canceled or superseded. Must be called from the thread of
+ * the JobRunner object.
+ */
+void JobRunner::waitIdle()
+{
+	mutex.lock();
+	while (running != nullptr || !queue.isEmpty())
+		idleCond.wait(&mutex);
+	mutex.unlock();
+	deliver();
+}
+
+/* Must be called with the mutex held */
+bool JobRunner::hasJob(BackgroundJob::kind_t kind) const
+{
+	int i;
+
+	if (running != nullptr && running->kind == kind)
+		return true;
+	for (i = 0; i < queue.size(); i++) {
+		if (queue[i]->kind == kind)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Waits until there are no queued or running jobs of kind. The jobs of other
+ * kinds are left to run and the results are delivered as usual, from the event
+ * loop. Must be called from the thread of the JobRunner object.
+ */
+void JobRunner::waitIdle(BackgroundJob::kind_t kind)
+{
+	mutex.lock();
+	while (hasJob(kind))
+		idleCond.wait(&mutex);
+	mutex.unlock();
+}
+
+bool JobRunner::isBusy()
+{
+	return busy;
+}
+
+void JobRunner::threadLoop()
+{
+	BackgroundJob *job;
+
+	mutex.lock();
+	while (true) {
+		while (queue.isEmpty() && !exiting)
+			workCond.wait(&mutex);
+		if (exiting)
+			break;
+		job = queue.takeFirst();
+		running = job;
+		mutex.unlock();
+
+		if (!job->control.isCanceled())
+			job->run();
+
+		mutex.lock();
+		running = nullptr;
+		finished.append(job);
+		idleCond.wakeAll();
+		QMetaObject::invokeMethod(this, "deliver",
+					  Qt::QueuedConnection);
+	}
+	mutex.unlock();
+}
+
+void JobRunner::deliver()
+{
+	QList<BackgroundJob*> jobs;
+	QList<bool> current;
+	bool idle;
+	int i;
+
+	mutex.lock();
+	jobs = finished;
+	finished.clear();
+	for (i = 0; i < jobs.size(); i++)
+		current.append(isCurrent(jobs[i]));
+	mutex.unlock();
+
+	for (i = 0; i < jobs.size(); i++) {
+		if (current[i])
+			emit jobFinished(jobs[i]);
+		delete jobs[i];
+	}
+
+	mutex.lock();
+	idle = running == nullptr && queue.isEmpty() && finished.isEmpty();
+	mutex.unlock();
+
+	if (busy && idle) {
+		busy = false;
+		progressTimer->stop();
+		emit busyChanged(false);
+	}
+}
+
+void JobRunner::pollProgress()
+{
+	int permille = -1;
+
+	mutex.lock();
+	if (running != nullptr)
+		permille = running->control.progress();
+	mutex.unlock();
+	emit progressChanged(permille);
+}
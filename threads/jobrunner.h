@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JOBRUNNER_H
+#define JOBRUNNER_H
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QWaitCondition>
+
+#include "threads/backgroundjob.h"
+#include "threads/workthread.h"
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+/*
+ * Executes BackgroundJobs one at a time in a thread of its own. When a job
+ * of a superseding kind is submitted, the older jobs of the same kind are
+ * canceled and the generation of the kind is increased, so that the results
+ * of the older jobs are never delivered, even if they have already completed.
+ *
+ * The results are handed over with the jobFinished() signal, which is emitted
+ * in the thread of the JobRunner object, after which the job is deleted. The
+ * jobs may read the data of the program freely, so it's the responsibility of
+ * the caller to use waitIdle() before modifying anything that a job may read,
+ * or waitIdle(kind) if only the jobs of one kind read it.
+ */
+class JobRunner : public QObject
+{
+	Q_OBJECT
+public:
+	JobRunner(QObject *parent = nullptr);
+	~JobRunner();
+	void submit(BackgroundJob *job);
+	void cancel(BackgroundJob::kind_t kind);
+	void cancelAll();
+	void waitIdle();
+	void waitIdle(BackgroundJob::kind_t kind);
+	bool isBusy();
+signals:
+	void jobFinished(BackgroundJob *job);
+	void progressChanged(int permille);
+	void busyChanged(bool busy);
+private slots:
+	void deliver();
+	void pollProgress();
+private:
+	void threadLoop();
+	bool isCurrent(const BackgroundJob *job) const;
+	bool hasJob(BackgroundJob::kind_t kind) const;
+	void cancel_(BackgroundJob::kind_t kind);
+	WorkThread<JobRunner> *thread;
+	QMutex mutex;
+	QWaitCondition workCond;
+	QWaitCondition idleCond;
+	QList<BackgroundJob*> queue;
+	QList<BackgroundJob*> finished;
+	BackgroundJob *running;
+	unsigned int generation[BackgroundJob::JOB_NR_KINDS];
+	bool exiting;
+	bool busy;
+	QTimer *progressTimer;
+};
+
+#endif /* JOBRUNNER_H */
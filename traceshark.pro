@@ -389,6 +389,8 @@ HEADERS      += qcustomplot/qcplist.h
 }
 
 HEADERS      +=  ui/abstracttaskmodel.h
+HEADERS      +=  ui/axismap.h
+HEADERS      +=  ui/cpulanegraph.h
 HEADERS      +=  ui/cpuselectdialog.h
 HEADERS      +=  ui/cpuselectmodel.h
 HEADERS      +=  ui/cursor.h
@@ -401,45 +403,56 @@ HEADERS      +=  ui/eventsmodel.h
 HEADERS      +=  ui/eventswidget.h
 HEADERS      +=  ui/graphenabledialog.h
 HEADERS      +=  ui/infowidget.h
+HEADERS      +=  ui/laneindex.h
 HEADERS      +=  ui/latencymodel.h
 HEADERS      +=  ui/latencywidget.h
 HEADERS      +=  ui/licensedialog.h
+HEADERS      +=  ui/lodgraph.h
 HEADERS      +=  ui/mainwindow.h
-HEADERS      +=  ui/migrationarrow.h
+HEADERS      +=  ui/markerstamp.h
+HEADERS      +=  ui/migrationgraph.h
 HEADERS      +=  ui/migrationline.h
 HEADERS      +=  ui/qcustomplot.h
 HEADERS      +=  ui/regexdialog.h
 HEADERS      +=  ui/regexwidget.h
 HEADERS      +=  ui/statslimitedmodel.h
 HEADERS      +=  ui/statsmodel.h
+HEADERS      +=  ui/stepgraph.h
 HEADERS      +=  ui/tableview.h
 HEADERS      +=  ui/taskgraph.h
 HEADERS      +=  ui/taskmodel.h
 HEADERS      +=  ui/taskrangeallocator.h
 HEADERS      +=  ui/taskselectdialog.h
 HEADERS      +=  ui/tasktoolbar.h
+HEADERS      +=  ui/tilecache.h
 HEADERS      +=  ui/traceplot.h
 HEADERS      +=  ui/tracesharkstyle.h
 HEADERS      +=  ui/valuebox.h
 HEADERS      +=  ui/yaxisticker.h
 
 HEADERS      +=  analyzer/abstracttask.h
+HEADERS      +=  analyzer/analyzerjobs.h
+HEADERS      +=  analyzer/compiledfilter.h
 HEADERS      +=  analyzer/cpufreq.h
 HEADERS      +=  analyzer/cpu.h
 HEADERS      +=  analyzer/cpuidle.h
 HEADERS      +=  analyzer/cputask.h
+HEADERS      +=  analyzer/eventindex.h
 HEADERS      +=  analyzer/filterstate.h
 HEADERS      +=  analyzer/latency.h
 HEADERS      +=  analyzer/latencycomp.h
 HEADERS      +=  analyzer/migration.h
+HEADERS      +=  analyzer/prescan.h
 HEADERS      +=  analyzer/regexfilter.h
 HEADERS      +=  analyzer/task.h
 HEADERS      +=  analyzer/tcolor.h
 HEADERS      +=  analyzer/traceanalyzer.h
+HEADERS      +=  analyzer/zonemap.h
 
 HEADERS      +=  parser/fileinfo.h
 HEADERS      +=  parser/genericparams.h
 HEADERS      +=  parser/paramhelpers.h
+HEADERS      +=  parser/schedrecord.h
 HEADERS      +=  parser/traceevent.h
 HEADERS      +=  parser/tracefile.h
 HEADERS      +=  parser/tracelinedata.h
@@ -453,7 +466,9 @@ HEADERS      +=  parser/perf/helpers.h
 HEADERS      +=  parser/perf/perfparams.h
 HEADERS      +=  parser/perf/perfgrammar.h
 
+HEADERS      +=  threads/backgroundjob.h
 HEADERS      +=  threads/indexwatcher.h
+HEADERS      +=  threads/jobrunner.h
 HEADERS      +=  threads/loadbuffer.h
 HEADERS      +=  threads/loadthread.h
 HEADERS      +=  threads/threadbuffer.h
@@ -489,6 +504,9 @@ HEADERS      +=  vtl/bsdexits.h
 HEADERS      +=  vtl/compiler.h
 HEADERS      +=  vtl/error.h
 HEADERS      +=  vtl/heapsort.h
+HEADERS      +=  vtl/minmaxpyramid.h
+HEADERS      +=  vtl/pidmap.h
+HEADERS      +=  vtl/rankbitmap.h
 HEADERS      +=  vtl/tlist.h
 HEADERS      +=  vtl/time.h
 
@@ -501,6 +519,7 @@ SOURCES       = qcustomplot/qcustomplot.cpp
 }
 
 SOURCES      +=  ui/abstracttaskmodel.cpp
+SOURCES      +=  ui/cpulanegraph.cpp
 SOURCES      +=  ui/cpuselectdialog.cpp
 SOURCES      +=  ui/cpuselectmodel.cpp
 SOURCES      +=  ui/cursor.cpp
@@ -513,22 +532,27 @@ SOURCES      +=  ui/eventsmodel.cpp
 SOURCES      +=  ui/eventswidget.cpp
 SOURCES      +=  ui/graphenabledialog.cpp
 SOURCES      +=  ui/infowidget.cpp
+SOURCES      +=  ui/laneindex.cpp
 SOURCES      +=  ui/latencymodel.cpp
 SOURCES      +=  ui/latencywidget.cpp
 SOURCES      +=  ui/licensedialog.cpp
+SOURCES      +=  ui/lodgraph.cpp
 SOURCES      +=  ui/mainwindow.cpp
-SOURCES      +=  ui/migrationarrow.cpp
+SOURCES      +=  ui/markerstamp.cpp
+SOURCES      +=  ui/migrationgraph.cpp
 SOURCES      +=  ui/migrationline.cpp
 SOURCES      +=  ui/regexdialog.cpp
 SOURCES      +=  ui/regexwidget.cpp
 SOURCES      +=  ui/statslimitedmodel.cpp
 SOURCES      +=  ui/statsmodel.cpp
+SOURCES      +=  ui/stepgraph.cpp
 SOURCES      +=  ui/tableview.cpp
 SOURCES      +=  ui/taskgraph.cpp
 SOURCES      +=  ui/taskmodel.cpp
 SOURCES      +=  ui/taskrangeallocator.cpp
 SOURCES      +=  ui/taskselectdialog.cpp
 SOURCES      +=  ui/tasktoolbar.cpp
+SOURCES      +=  ui/tilecache.cpp
 SOURCES      +=  ui/traceplot.cpp
 SOURCES      +=  ui/tracesharkstyle.cpp
 SOURCES      +=  ui/valuebox.cpp
@@ -536,15 +560,20 @@ SOURCES      +=  ui/yaxisticker.cpp
 
 
 SOURCES      +=  analyzer/abstracttask.cpp
+SOURCES      +=  analyzer/analyzerjobs.cpp
+SOURCES      +=  analyzer/compiledfilter.cpp
 SOURCES      +=  analyzer/cpufreq.cpp
 SOURCES      +=  analyzer/cpuidle.cpp
 SOURCES      +=  analyzer/cputask.cpp
+SOURCES      +=  analyzer/eventindex.cpp
 SOURCES      +=  analyzer/filterstate.cpp
 SOURCES      +=  analyzer/latencycomp.cpp
+SOURCES      +=  analyzer/prescan.cpp
 SOURCES      +=  analyzer/regexfilter.cpp
 SOURCES      +=  analyzer/task.cpp
 SOURCES      +=  analyzer/tcolor.cpp
 SOURCES      +=  analyzer/traceanalyzer.cpp
+SOURCES      +=  analyzer/zonemap.cpp
 
 SOURCES      +=  parser/fileinfo.cpp
 SOURCES      +=  parser/traceevent.cpp
@@ -557,7 +586,9 @@ SOURCES      +=  parser/ftrace/ftracegrammar.cpp
 SOURCES      +=  parser/perf/perfparams.cpp
 SOURCES      +=  parser/perf/perfgrammar.cpp
 
+SOURCES      +=  threads/backgroundjob.cpp
 SOURCES      +=  threads/indexwatcher.cpp
+SOURCES      +=  threads/jobrunner.cpp
 SOURCES      +=  threads/loadbuffer.cpp
 SOURCES      +=  threads/loadthread.cpp
 SOURCES      +=  threads/tthread.cpp
@@ -577,6 +608,9 @@ SOURCES      +=  misc/translate.cpp
 
 SOURCES      +=  vtl/bitvector.cpp
 SOURCES      +=  vtl/error.cpp
+SOURCES      +=  vtl/minmaxpyramid.cpp
+SOURCES      +=  vtl/rankbitmap.cpp
+SOURCES      +=  vtl/time.cpp
 
 ###############################################################################
 # Directories
@@ -55,7 +55,7 @@
 
 #include <QAbstractTableModel>
 
-#include "vtl/avltree.h"
+#include "vtl/pidmap.h"
 
 #include "analyzer/task.h"
 
@@ -72,7 +72,7 @@ class AbstractTaskModel : public QAbstractTableModel
 public:
 	AbstractTaskModel(QObject *parent = 0);
 	virtual ~AbstractTaskModel() = 0;
-	virtual void setTaskMap(vtl::AVLTree<int, TaskHandle> *map,
+	virtual void setTaskMap(vtl::PidMap<TaskHandle> *map,
 				unsigned int nrcpus) = 0;
 	virtual void beginResetModel() = 0;
 	virtual void endResetModel() = 0;
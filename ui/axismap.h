@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef AXISMAP_H
+#define AXISMAP_H
+
+#include "ui/qcustomplot.h"
+#include "vtl/compiler.h"
+
+/*
+ * A snapshot of the mapping between the coordinates and the pixels of a linear
+ * QCPAxis. It has the subset of the QCPAxis interface that the LOD drawing
+ * code needs, so that the same code can draw both to the plot and, from
+ * worker threads, to the offscreen tiles of the TileCache, which have their
+ * own mappings.
+ */
+class AxisMap {
+public:
+	AxisMap();
+	AxisMap(const QCPAxis *axis);
+	AxisMap(const QCPRange &range, double base, double origin,
+		double pixelsPerCoord, bool rangeReversed);
+	vtl_always_inline double coordToPixel(double coord) const;
+	vtl_always_inline double pixelToCoord(double pixel) const;
+	vtl_always_inline int pixelOrientation() const;
+	vtl_always_inline bool rangeReversed() const;
+	vtl_always_inline const QCPRange &range() const;
+	vtl_always_inline double pixelsPerCoord() const;
+private:
+	/* The visible range */
+	QCPRange mRange;
+	/* The coordinate base is at the pixel origin */
+	double base;
+	double origin;
+	/* This is negative if the pixels grow when the coordinates decrease */
+	double ppc;
+	bool reversed;
+};
+
+inline AxisMap::AxisMap():
+	mRange(0, 1), base(0), origin(0), ppc(1), reversed(false)
+{}
+
+inline AxisMap::AxisMap(const QCPAxis *axis):
+	mRange(axis->range()), base(axis->range().lower),
+	origin(axis->coordToPixel(axis->range().lower)),
+	reversed(axis->rangeReversed())
+{
+	ppc = (axis->coordToPixel(mRange.upper) - origin) / mRange.size();
+}
+
+inline AxisMap::AxisMap(const QCPRange &range, double base_, double origin_,
+			double pixelsPerCoord, bool rangeReversed):
+	mRange(range), base(base_), origin(origin_), ppc(pixelsPerCoord),
+	reversed(rangeReversed)
+{}
+
+vtl_always_inline double AxisMap::coordToPixel(double coord) const
+{
+	return origin + (coord - base) * ppc;
+}
+
+vtl_always_inline double AxisMap::pixelToCoord(double pixel) const
+{
+	return base + (pixel - origin) / ppc;
+}
+
+/* Same as QCPAxis::pixelOrientation() */
+vtl_always_inline int AxisMap::pixelOrientation() const
+{
+	return ppc < 0 ? -1 : 1;
+}
+
+vtl_always_inline bool AxisMap::rangeReversed() const
+{
+	return reversed;
+}
+
+vtl_always_inline const QCPRange &AxisMap::range() const
+{
+	return mRange;
+}
+
+vtl_always_inline double AxisMap::pixelsPerCoord() const
+{
+	return ppc;
+}
+
+#endif /* AXISMAP_H */
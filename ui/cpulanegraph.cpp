@@ -0,0 +1,706 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <climits>
+
+#include "analyzer/cputask.h"
+#include "misc/traceshark.h"
+#include "ui/cpulanegraph.h"
+#include "ui/lodgraph.h"
+#include "vtl/compiler.h"
+
+/*
+ * If more runs than this are within the selection tolerance, then all tasks
+ * are tested, since the index would not save much.
+ */
+#define CPULANEGRAPH_MAX_RUNS (64)
+
+/* These are the same as for the QCPErrorBars that were used before */
+const double CpuLaneGraph::WHISKER_WIDTH = 4;
+const double CpuLaneGraph::SYMBOL_GAP = 10;
+
+CpuLaneGraph::CpuLaneGraph(QCPAxis *keyAxis, QCPAxis *valueAxis):
+	QCPAbstractPlottable(keyAxis, valueAxis), showSched(true),
+	showHorizontalDelay(false), showVerticalDelay(false)
+{
+	setPen(QPen(Qt::black, 0));
+	setBrush(Qt::NoBrush);
+	setSelectable(QCP::stSingleData);
+}
+
+/*
+ * Adds a task to the lane and returns its index. The vectors of the task are
+ * used directly by selectTest() and draw(), so the task must exist as long as
+ * the lane exists. The tiles are drawn from copies of them. The tasks
+ * should be added before the lane is added to the TileCache, since every
+ * change of a tiled lane invalidates all tiles.
+ */
+int CpuLaneGraph::addTask(const CPUTask *task, TaskGraph *graph)
+{
+	LaneTask lt;
+	int i;
+
+	lt.task = task;
+	lt.graph = graph;
+	lt.sorted =
+		std::is_sorted(task->schedTimev.constBegin(),
+			       task->schedTimev.constEnd()) &&
+		std::is_sorted(task->delayTimev.constBegin(),
+			       task->delayTimev.constEnd()) &&
+		std::is_sorted(task->preemptedTimev.constBegin(),
+			       task->preemptedTimev.constEnd()) &&
+		std::is_sorted(task->runningTimev.constBegin(),
+			       task->runningTimev.constEnd()) &&
+		std::is_sorted(task->uninterruptibleTimev.constBegin(),
+			       task->uninterruptibleTimev.constEnd());
+	lt.maxDelay = 0;
+	for (i = 0; i < task->delay.size(); i++)
+		lt.maxDelay = qMax(lt.maxDelay, task->delay[i]);
+	tasks.append(lt);
+	index.clear();
+	tileContentChanged();
+	return tasks.size() - 1;
+}
+
+void CpuLaneGraph::setTaskPen(int index, const QPen &pen)
+{
+	tasks[index].pen = pen;
+	tileContentChanged();
+}
+
+void CpuLaneGraph::setShowSched(bool show)
+{
+	showSched = show;
+	tileContentChanged();
+}
+
+void CpuLaneGraph::setShowHorizontalDelay(bool show)
+{
+	showHorizontalDelay = show;
+	tileContentChanged();
+}
+
+void CpuLaneGraph::setShowVerticalDelay(bool show)
+{
+	showVerticalDelay = show;
+	tileContentChanged();
+}
+
+void CpuLaneGraph::setMarkerStyle(marker_t marker,
+				  const QCPScatterStyle &style)
+{
+	markerStyles[marker] = style;
+	tileContentChanged();
+}
+
+bool CpuLaneGraph::isTaskSelected(int index) const
+{
+	return selection().contains(
+		QCPDataSelection(QCPDataRange(index, index + 1)));
+}
+
+void CpuLaneGraph::selectTask(int index)
+{
+	setSelection(QCPDataSelection(QCPDataRange(index, index + 1)));
+}
+
+TaskGraph *CpuLaneGraph::selectedTaskGraph() const
+{
+	int index;
+
+	if (selection().isEmpty())
+		return nullptr;
+	index = selection().dataRange().begin();
+	if (index < 0 || index >= tasks.size())
+		return nullptr;
+	return tasks[index].graph;
+}
+
+QSharedPointer<TileSource> CpuLaneGraph::tileSource() const
+{
+	if (!showSched || tasks.isEmpty() || !realVisibility())
+		return QSharedPointer<TileSource>();
+	return QSharedPointer<TileSource>(new LaneState(this));
+}
+
+int CpuLaneGraph::lowerBound(const QVector<double> &v, double key)
+{
+	return int(std::lower_bound(v.constBegin(), v.constEnd(), key) -
+		   v.constBegin());
+}
+
+int CpuLaneGraph::upperBound(const QVector<double> &v, double key)
+{
+	return int(std::upper_bound(v.constBegin(), v.constEnd(), key) -
+		   v.constBegin());
+}
+
+/*
+ * Returns the pyramid of the scheduling graph, or nullptr if it cannot be used
+ * with the first n points.
+ */
+const vtl::MinMaxPyramid *CpuLaneGraph::schedPyramid(
+	const vtl::MinMaxPyramid &lod, bool sorted, int n)
+{
+	if (!sorted || !lod.isValid() || lod.size() != n)
+		return nullptr;
+	return &lod;
+}
+
+/*
+ * Returns the distance in pixels from pos to the scheduling graph of a task,
+ * or -1 if the graph is not within the selection tolerance in the key
+ * direction.
+ */
+double CpuLaneGraph::schedDistance(const LaneTask &lt, const QPointF &pos)
+	const
+{
+	const CPUTask *task = lt.task;
+	int n = qMin(task->schedTimev.size(), (int) task->schedData.size());
+
+	return LodGraph::stepDistance(
+		AxisMap(mKeyAxis.data()), AxisMap(mValueAxis.data()), pos,
+		mParentPlot->selectionTolerance(), task->schedTimev,
+		[task](int i) { return task->schedValue(i); }, n, lt.sorted,
+		schedPyramid(task->schedLod, lt.sorted, n), task->schedScale(),
+		task->offset);
+}
+
+/* The index is built when it's needed, since most lanes are never clicked */
+void CpuLaneGraph::buildIndex() const
+{
+	int i, n;
+
+	index.clear();
+	unsortedTasks.resize(0);
+	for (i = 0; i < tasks.size(); i++) {
+		const CPUTask *task = tasks[i].task;
+		if (!tasks[i].sorted) {
+			unsortedTasks.append(i);
+			continue;
+		}
+		n = qMin(task->schedTimev.size(), (int) task->schedData.size());
+		index.addTask(i, task->schedTimev, task->schedData, n);
+	}
+	index.build();
+}
+
+/*
+ * Only the scheduling graphs can be selected. If several tasks are equally
+ * close, the one that is drawn last, and thus on top, is chosen.
+ */
+double CpuLaneGraph::selectTest(const QPointF &pos, bool onlySelectable,
+				QVariant *details) const
+{
+	QVector<int> candidates;
+	double d, best, tol, from, to;
+	int i, bestIdx, top;
+
+	if ((onlySelectable && mSelectable == QCP::stNone) || !showSched ||
+	    tasks.isEmpty() || !mKeyAxis || !mValueAxis)
+		return -1;
+
+	if (!mKeyAxis->axisRect()->rect().contains(pos.toPoint()) &&
+	    !mParentPlot->interactions().testFlag(
+		    QCP::iSelectPlottablesBeyondAxisRect))
+		return -1;
+
+	AxisMap keyMap(mKeyAxis.data());
+	tol = mParentPlot->selectionTolerance();
+	from = keyMap.pixelToCoord(pos.x() - tol);
+	to = keyMap.pixelToCoord(pos.x() + tol);
+	if (from > to)
+		qSwap(from, to);
+
+	if (!index.isValid())
+		buildIndex();
+
+	/*
+	 * The candidates are the tasks that run near pos and the task that is
+	 * on top of the floor at pos. If the tasks run too densely there, we
+	 * look at all of them.
+	 */
+	if (index.findRuns(from, to, CPULANEGRAPH_MAX_RUNS, &candidates)) {
+		candidates += unsortedTasks;
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(),
+					     candidates.end()),
+				 candidates.end());
+		top = index.topTask(keyMap.pixelToCoord(pos.x()), candidates);
+		if (top >= 0) {
+			candidates.append(top);
+			std::sort(candidates.begin(), candidates.end());
+		}
+	} else {
+		candidates.resize(tasks.size());
+		for (i = 0; i < tasks.size(); i++)
+			candidates[i] = i;
+	}
+
+	best = -1;
+	bestIdx = -1;
+	for (i = 0; i < candidates.size(); i++) {
+		d = schedDistance(tasks[candidates[i]], pos);
+		if (d >= 0 && (best < 0 || d <= best)) {
+			best = d;
+			bestIdx = candidates[i];
+		}
+	}
+
+	if (bestIdx < 0)
+		return -1;
+	if (details != nullptr)
+		details->setValue(QCPDataSelection(
+					  QCPDataRange(bestIdx, bestIdx + 1)));
+	return best;
+}
+
+static vtl_always_inline void expandRange(QCPRange &range, bool &found,
+					  double v, QCP::SignDomain domain)
+{
+	if ((domain == QCP::sdPositive && v <= 0) ||
+	    (domain == QCP::sdNegative && v >= 0))
+		return;
+	if (!found) {
+		range = QCPRange(v, v);
+		found = true;
+		return;
+	}
+	range.expand(v);
+}
+
+/* Expands band with the values between which a task is drawn */
+static vtl_always_inline void expandBand(QCPRange &band, bool &found,
+					 double offset, double schedScale,
+					 double floorValue, double delayValue,
+					 double verticalDelaySize)
+{
+	expandRange(band, found, offset, QCP::sdBoth);
+	expandRange(band, found, floorValue, QCP::sdBoth);
+	expandRange(band, found, offset + schedScale, QCP::sdBoth);
+	expandRange(band, found, delayValue, QCP::sdBoth);
+	expandRange(band, found, delayValue + verticalDelaySize, QCP::sdBoth);
+}
+
+QCPRange CpuLaneGraph::getKeyRange(bool &foundRange,
+				   QCP::SignDomain inSignDomain) const
+{
+	QCPRange range;
+	int i, j;
+
+	foundRange = false;
+	for (i = 0; i < tasks.size(); i++) {
+		const CPUTask *task = tasks[i].task;
+		for (j = 0; j < task->schedTimev.size(); j++)
+			expandRange(range, foundRange, task->schedTimev[j],
+				    inSignDomain);
+	}
+	return range;
+}
+
+QCPRange CpuLaneGraph::getValueRange(bool &foundRange,
+				     QCP::SignDomain inSignDomain,
+				     const QCPRange &inKeyRange) const
+{
+	bool restrict = inKeyRange != QCPRange();
+	QCPRange range;
+	int i, j, n;
+
+	foundRange = false;
+	for (i = 0; i < tasks.size(); i++) {
+		const CPUTask *task = tasks[i].task;
+		n = qMin(task->schedTimev.size(),
+			 (int) task->schedData.size());
+		for (j = 0; j < n; j++) {
+			if (restrict && !inKeyRange.contains(
+				    task->schedTimev[j]))
+				continue;
+			expandRange(range, foundRange, task->schedValue(j),
+				    inSignDomain);
+		}
+	}
+	return range;
+}
+
+bool CpuLaneGraph::tileBand(QCPRange *band) const
+{
+	bool found = false;
+	int i;
+
+	for (i = 0; i < tasks.size(); i++) {
+		const CPUTask *task = tasks[i].task;
+		expandBand(*band, found, task->offset, task->schedScale(),
+			   task->floorValue(), task->delayValue(),
+			   task->verticalDelaySize());
+	}
+	return found;
+}
+
+void CpuLaneGraph::TaskData::copy(const CPUTask *task)
+{
+	schedTimev = task->schedTimev;
+	schedData = task->schedData;
+	schedLod.share(task->schedLod, schedData);
+	delayTimev = task->delayTimev;
+	delay = task->delay;
+	preemptedTimev = task->preemptedTimev;
+	runningTimev = task->runningTimev;
+	uninterruptibleTimev = task->uninterruptibleTimev;
+	offset = task->offset;
+	schedScale = task->schedScale();
+	floorValue = task->floorValue();
+	delayValue = task->delayValue();
+	verticalDelayFactor = task->verticalDelayFactor();
+	verticalDelaySize = task->verticalDelaySize();
+}
+
+/* This is the same as AbstractTask::schedValue() */
+vtl_always_inline double CpuLaneGraph::TaskData::schedValue(int index) const
+{
+	return schedData.read(index) * schedScale + offset;
+}
+
+/*
+ * The data vector is sized before it's filled, so that the TaskData objects
+ * are never moved and the pyramids can refer to their own schedData.
+ */
+CpuLaneGraph::LaneState::LaneState(const CpuLaneGraph *lane):
+	tasks(lane->tasks), data(lane->tasks.size()), markerPen(lane->mPen),
+	showHorizontalDelay(lane->showHorizontalDelay),
+	showVerticalDelay(lane->showVerticalDelay)
+{
+	const QCustomPlot *plot = lane->parentPlot();
+	bool found = false;
+	int i;
+
+	for (i = 0; i < NR_MARKERS; i++)
+		markerStyles[i] = lane->markerStyles[i];
+	antialiased = useAntialiasing(plot, lane->antialiased(),
+				      QCP::aePlottables);
+	scattersAntialiased = useAntialiasing(plot,
+					      lane->antialiasedScatters(),
+					      QCP::aeScatters);
+	for (i = 0; i < NR_MARKERS; i++) {
+		lane->markerStamps[i].render(markerStyles[i], markerPen,
+					     scattersAntialiased,
+					     plot->bufferDevicePixelRatio());
+		markerStamps[i] = lane->markerStamps[i];
+	}
+
+	for (i = 0; i < tasks.size(); i++) {
+		TaskData &td = data[i];
+		td.copy(tasks.at(i).task);
+		expandBand(band, found, td.offset, td.schedScale,
+			   td.floorValue, td.delayValue, td.verticalDelaySize);
+	}
+}
+
+void CpuLaneGraph::LaneState::drawSched(QCPPainter *painter,
+					const AxisMap &keyMap,
+					const AxisMap &valueMap, int index,
+					const QPen &pen, Buffers *buffers) const
+{
+	const QCPRange &range = keyMap.range();
+	const LaneTask &lt = tasks[index];
+	const TaskData *td = &data[index];
+	int n = qMin(td->schedTimev.size(), (int) td->schedData.size());
+	int a, b;
+
+	if (n == 0)
+		return;
+
+	/* Include one point on each side, so that the lines reach the edges */
+	if (lt.sorted) {
+		a = qMax(lowerBound(td->schedTimev, range.lower) - 1, 0);
+		b = qMin(upperBound(td->schedTimev, range.upper) + 1, n);
+	} else {
+		a = 0;
+		b = n;
+	}
+	if (a >= b)
+		return;
+
+	LodGraph::stepLines(keyMap, valueMap, td->schedTimev,
+			    [td](int i) { return td->schedValue(i); },
+			    schedPyramid(td->schedLod, lt.sorted, n),
+			    td->schedScale, td->offset, a, b,
+			    &buffers->lineData, &buffers->lines);
+
+	painter->setPen(pen);
+	painter->setBrush(Qt::NoBrush);
+	painter->setAntialiasing(antialiased);
+	painter->drawPolyline(buffers->lines.constData(),
+			      buffers->lines.size());
+}
+
+/*
+ * Draws the wakeup latencies like the QCPErrorBars with a dot scatter style
+ * QCPGraph that were used before. The horizontal ones extend to the left of
+ * the wakeup and the vertical ones upwards.
+ */
+void CpuLaneGraph::LaneState::drawDelays(QCPPainter *painter,
+					 const AxisMap &keyMap,
+					 const AxisMap &valueMap, int index,
+					 Buffers *buffers) const
+{
+	const QCPRange &range = keyMap.range();
+	const LaneTask &lt = tasks[index];
+	const TaskData *task = &data[index];
+	const double w = WHISKER_WIDTH * 0.5;
+	const double kgap = SYMBOL_GAP * 0.5 * keyMap.pixelOrientation();
+	const double vgap = SYMBOL_GAP * 0.5 * valueMap.pixelOrientation();
+	const double height = task->delayValue;
+	const double vfactor = task->verticalDelayFactor;
+	const double vsize = task->verticalDelaySize;
+	QVector<QLineF> &backbones = buffers->backbones;
+	QVector<QLineF> &whiskers = buffers->whiskers;
+	QCPScatterStyle dot(QCPScatterStyle::ssDot);
+	double x, y, start, end;
+	int n, a, b, i;
+	int ix, lastX;
+	QPen pen;
+
+	n = qMin(task->delayTimev.size(), task->delay.size());
+	if (n == 0)
+		return;
+
+	if (lt.sorted) {
+		a = lowerBound(task->delayTimev, range.lower);
+		end = range.upper;
+		if (showHorizontalDelay)
+			end += lt.maxDelay;
+		b = qMin(upperBound(task->delayTimev, end), n);
+	} else {
+		a = 0;
+		b = n;
+	}
+	if (a >= b)
+		return;
+
+	backbones.resize(0);
+	whiskers.resize(0);
+	y = valueMap.coordToPixel(height);
+	for (i = a; i < b; i++) {
+		x = keyMap.coordToPixel(task->delayTimev[i]);
+		if (showHorizontalDelay) {
+			start = x - kgap;
+			end = keyMap.coordToPixel(task->delayTimev[i] -
+						  task->delay[i]);
+			if ((start > end) != keyMap.rangeReversed())
+				backbones.append(QLineF(start, y, end, y));
+			whiskers.append(QLineF(end, y - w, end, y + w));
+			whiskers.append(QLineF(x, y - w, x, y + w));
+		}
+		if (showVerticalDelay) {
+			start = y + vgap;
+			end = valueMap.coordToPixel(
+				height + TSMIN(vfactor * task->delay[i],
+					       vsize));
+			if ((start > end) != valueMap.rangeReversed())
+				backbones.append(QLineF(x, start, x, end));
+			whiskers.append(QLineF(x - w, end, x + w, end));
+			whiskers.append(QLineF(x - w, y, x + w, y));
+		}
+	}
+
+	pen = lt.pen;
+	if (pen.capStyle() == Qt::SquareCap)
+		pen.setCapStyle(Qt::FlatCap);
+	painter->setPen(pen);
+	painter->setAntialiasing(false);
+	painter->drawLines(backbones);
+	painter->drawLines(whiskers);
+
+	painter->setAntialiasing(scattersAntialiased);
+	dot.applyTo(painter, lt.pen);
+	lastX = INT_MIN;
+	for (i = a; i < b; i++) {
+		x = keyMap.coordToPixel(task->delayTimev[i]);
+		ix = int(x);
+		if (ix == lastX)
+			continue;
+		dot.drawShape(painter, x, y);
+		lastX = ix;
+	}
+}
+
+/*
+ * All markers of a kind are drawn at the same value. Markers that would be
+ * drawn at the same pixel as the previous are skipped. The stamp of the style
+ * is drawn if the painter allows it.
+ */
+void CpuLaneGraph::LaneState::drawMarkers(QCPPainter *painter,
+					  const AxisMap &keyMap,
+					  const AxisMap &valueMap,
+					  const QVector<double> &timev,
+					  double value, bool sorted,
+					  const QCPScatterStyle &style,
+					  const MarkerStamp &stamp) const
+{
+	const QCPRange &range = keyMap.range();
+	const double y = valueMap.coordToPixel(value);
+	int n = timev.size();
+	int a, b, i;
+	int ix, lastX;
+	bool useStamp;
+	double x;
+
+	if (n == 0 || style.isNone())
+		return;
+
+	if (sorted) {
+		a = lowerBound(timev, range.lower);
+		b = qMin(upperBound(timev, range.upper), n);
+	} else {
+		a = 0;
+		b = n;
+	}
+	if (a >= b)
+		return;
+
+	useStamp = stamp.canDraw(painter);
+	if (!useStamp) {
+		painter->setAntialiasing(scattersAntialiased);
+		style.applyTo(painter, markerPen);
+	}
+	lastX = INT_MIN;
+	for (i = a; i < b; i++) {
+		x = keyMap.coordToPixel(timev[i]);
+		ix = int(x);
+		if (ix == lastX)
+			continue;
+		if (useStamp)
+			stamp.draw(painter, x, y);
+		else
+			style.drawShape(painter, x, y);
+		lastX = ix;
+	}
+}
+
+/*
+ * The tasks are drawn in the order that they were added, each with its
+ * scheduling graph first, then its wakeup latencies and last its markers. This
+ * is the same order as the separate graphs were drawn in before.
+ */
+void CpuLaneGraph::LaneState::drawTile(QCPPainter *painter,
+				       const AxisMap &keyMap,
+				       const AxisMap &valueMap) const
+{
+	const QCPScatterStyle &preempted = markerStyles[MARKER_PREEMPTED];
+	const QCPScatterStyle &running = markerStyles[MARKER_RUNNING];
+	const QCPScatterStyle &unint = markerStyles[MARKER_UNINT];
+	Buffers buffers;
+	double floor;
+	int i;
+
+	if (keyMap.range().size() <= 0 ||
+	    band.upper < valueMap.range().lower ||
+	    band.lower > valueMap.range().upper)
+		return;
+
+	for (i = 0; i < tasks.size(); i++) {
+		const LaneTask &lt = tasks[i];
+		const TaskData *task = &data[i];
+
+		drawSched(painter, keyMap, valueMap, i, lt.pen, &buffers);
+		drawDelays(painter, keyMap, valueMap, i, &buffers);
+		floor = task->floorValue;
+		drawMarkers(painter, keyMap, valueMap, task->preemptedTimev,
+			    floor, lt.sorted, preempted,
+			    markerStamps[MARKER_PREEMPTED]);
+		drawMarkers(painter, keyMap, valueMap, task->runningTimev,
+			    floor, lt.sorted, running,
+			    markerStamps[MARKER_RUNNING]);
+		drawMarkers(painter, keyMap, valueMap,
+			    task->uninterruptibleTimev, floor, lt.sorted,
+			    unint, markerStamps[MARKER_UNINT]);
+	}
+}
+
+/*
+ * The selected task is drawn again on top of the others, with the pen of the
+ * selection decorator.
+ */
+void CpuLaneGraph::draw(QCPPainter *painter)
+{
+	int selectedIdx = -1;
+
+	if (!mKeyAxis || !mValueAxis || !showSched || tasks.isEmpty())
+		return;
+	if (mKeyAxis->range().size() <= 0)
+		return;
+
+	AxisMap keyMap(mKeyAxis.data());
+	AxisMap valueMap(mValueAxis.data());
+	LaneState state(this);
+
+	if (!isTiled())
+		state.drawTile(painter, keyMap, valueMap);
+
+	if (!selection().isEmpty())
+		selectedIdx = selection().dataRange().begin();
+	if (selectedIdx < 0 || selectedIdx >= tasks.size() ||
+	    mSelectionDecorator == nullptr)
+		return;
+	state.drawSched(painter, keyMap, valueMap, selectedIdx,
+			mSelectionDecorator->pen(), &buffers);
+}
+
+void CpuLaneGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect)
+	const
+{
+	applyDefaultAntialiasingHint(painter);
+	painter->setPen(mPen);
+	painter->drawLine(QLineF(rect.left(), rect.center().y(),
+				 rect.right(), rect.center().y()));
+}
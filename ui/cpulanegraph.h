@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPULANEGRAPH_H
+#define CPULANEGRAPH_H
+
+#include <QPen>
+#include <QSharedPointer>
+#include <QVector>
+#include "ui/axismap.h"
+#include "ui/laneindex.h"
+#include "ui/markerstamp.h"
+#include "ui/qcustomplot.h"
+#include "ui/tilecache.h"
+#include "vtl/bitvector.h"
+#include "vtl/minmaxpyramid.h"
+
+class CPUTask;
+class TaskGraph;
+
+/*
+ * A plottable that draws all tasks of a CPU lane, that is their scheduling
+ * step lines, their wakeup latencies and their markers, directly from the
+ * vectors of the CPUTask objects. This is much cheaper than having a number of
+ * QCPGraphs and QCPErrorBars for every task, because QCustomPlot iterates over
+ * all plottables on every replot and every click.
+ *
+ * A task is selected by selecting the data range [index, index + 1), where
+ * index is the value returned by addTask(). The key axis is assumed to be
+ * horizontal.
+ *
+ * When the lane is drawn by a TileCache, draw() only draws the selected task
+ * on top of the tiles.
+ */
+class CpuLaneGraph : public QCPAbstractPlottable, public TilePlottable
+{
+	Q_OBJECT
+public:
+	typedef enum : int {
+		MARKER_PREEMPTED = 0,
+		MARKER_RUNNING,
+		MARKER_UNINT,
+		NR_MARKERS
+	} marker_t;
+	CpuLaneGraph(QCPAxis *keyAxis, QCPAxis *valueAxis);
+	int addTask(const CPUTask *task, TaskGraph *graph);
+	void setTaskPen(int index, const QPen &pen);
+	void setShowSched(bool show);
+	void setShowHorizontalDelay(bool show);
+	void setShowVerticalDelay(bool show);
+	void setMarkerStyle(marker_t marker, const QCPScatterStyle &style);
+	bool isTaskSelected(int index) const;
+	void selectTask(int index);
+	TaskGraph *selectedTaskGraph() const;
+	QSharedPointer<TileSource> tileSource() const Q_DECL_OVERRIDE;
+	bool tileBand(QCPRange *band) const Q_DECL_OVERRIDE;
+	double selectTest(const QPointF &pos, bool onlySelectable,
+			  QVariant *details = nullptr) const Q_DECL_OVERRIDE;
+	QCPRange getKeyRange(bool &foundRange,
+			     QCP::SignDomain inSignDomain = QCP::sdBoth) const
+		Q_DECL_OVERRIDE;
+	QCPRange getValueRange(bool &foundRange,
+			       QCP::SignDomain inSignDomain = QCP::sdBoth,
+			       const QCPRange &inKeyRange = QCPRange()) const
+		Q_DECL_OVERRIDE;
+protected:
+	void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
+	void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+		Q_DECL_OVERRIDE;
+private:
+	class LaneTask {
+	public:
+		const CPUTask *task;
+		TaskGraph *graph;
+		QPen pen;
+		/* If the keys are not sorted we cannot search or sample */
+		bool sorted;
+		/* The longest horizontal delay, it extends left of a point */
+		double maxDelay;
+	};
+	/* These are reused between the tasks when drawing */
+	class Buffers {
+	public:
+		QVector<QCPGraphData> lineData;
+		QVector<QPointF> lines;
+		QVector<QLineF> backbones;
+		QVector<QLineF> whiskers;
+	};
+	/*
+	 * A copy of the vectors and the layout of a task. The vectors are
+	 * implicitly shared with the task, so they are detached if the task
+	 * grows while the copy exists.
+	 */
+	class TaskData {
+	public:
+		void copy(const CPUTask *task);
+		vtl_always_inline double schedValue(int index) const;
+		QVector<double> schedTimev;
+		vtl::BitVector schedData;
+		/* Refers to schedData, so a TaskData must not be moved */
+		vtl::MinMaxPyramid schedLod;
+		QVector<double> delayTimev;
+		QVector<double> delay;
+		QVector<double> preemptedTimev;
+		QVector<double> runningTimev;
+		QVector<double> uninterruptibleTimev;
+		double offset;
+		double schedScale;
+		double floorValue;
+		double delayValue;
+		double verticalDelayFactor;
+		double verticalDelaySize;
+	};
+	/*
+	 * A copy of everything that is needed to draw the lane, so that it can
+	 * be drawn by other threads.
+	 */
+	class LaneState : public TileSource {
+	public:
+		LaneState(const CpuLaneGraph *lane);
+		void drawTile(QCPPainter *painter, const AxisMap &keyMap,
+			      const AxisMap &valueMap) const Q_DECL_OVERRIDE;
+		void drawSched(QCPPainter *painter, const AxisMap &keyMap,
+			       const AxisMap &valueMap, int index,
+			       const QPen &pen, Buffers *buffers) const;
+	private:
+		void drawDelays(QCPPainter *painter, const AxisMap &keyMap,
+				const AxisMap &valueMap, int index,
+				Buffers *buffers) const;
+		void drawMarkers(QCPPainter *painter, const AxisMap &keyMap,
+				 const AxisMap &valueMap,
+				 const QVector<double> &timev, double value,
+				 bool sorted, const QCPScatterStyle &style,
+				 const MarkerStamp &stamp) const;
+		QVector<LaneTask> tasks;
+		QVector<TaskData> data;
+		QCPScatterStyle markerStyles[NR_MARKERS];
+		MarkerStamp markerStamps[NR_MARKERS];
+		QPen markerPen;
+		bool showHorizontalDelay;
+		bool showVerticalDelay;
+		bool antialiased;
+		bool scattersAntialiased;
+		/* The values between which everything is drawn */
+		QCPRange band;
+	};
+	static const vtl::MinMaxPyramid *schedPyramid(
+		const vtl::MinMaxPyramid &lod, bool sorted, int n);
+	double schedDistance(const LaneTask &lt, const QPointF &pos) const;
+	void buildIndex() const;
+	static int lowerBound(const QVector<double> &v, double key);
+	static int upperBound(const QVector<double> &v, double key);
+	QVector<LaneTask> tasks;
+	QCPScatterStyle markerStyles[NR_MARKERS];
+	/* These are copied to the snapshots and only rendered when changed */
+	mutable MarkerStamp markerStamps[NR_MARKERS];
+	bool showSched;
+	bool showHorizontalDelay;
+	bool showVerticalDelay;
+	Buffers buffers;
+	/* The index for selectTest(), the tasks that are not in it */
+	mutable LaneIndex index;
+	mutable QVector<int> unsortedTasks;
+	static const double WHISKER_WIDTH;
+	static const double SYMBOL_GAP;
+};
+
+#endif /* CPULANEGRAPH_H */
@@ -102,12 +102,22 @@ void Cursor::setPosition(const vtl::Time &t)
 	setPosition_(time.toDouble());
 }
 
+/*
+ * If the cursor is on a buffered layer, then only that layer is redrawn. The
+ * rest of the plot is then reused from its buffers.
+ */
 void Cursor::setPosition_(double pos)
 {
+	QCPLayer *cursorLayer = layer();
+
 	start->setCoords(pos, -1000000000);
 	end->setCoords(pos, +1000000000);
-	parentPlot()->replot();
 	position = pos;
+	if (cursorLayer != nullptr &&
+	    cursorLayer->mode() == QCPLayer::lmBuffered)
+		cursorLayer->replot();
+	else
+		parentPlot()->replot(QCustomPlot::rpQueuedReplot);
 }
 
 double Cursor::getPosition()
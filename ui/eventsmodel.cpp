@@ -58,37 +58,46 @@
 #include "ui/eventsmodel.h"
 #include "parser/traceevent.h"
 #include "misc/traceshark.h"
+#include "vtl/rankbitmap.h"
 #include "vtl/tlist.h"
 
 
 EventsModel::EventsModel(QObject *parent):
 	QAbstractTableModel(parent), has_flag_field(false), events(nullptr),
-	eventsPtrs(nullptr)
+	selection(nullptr), nrEvents(-1)
 {}
 
 EventsModel::EventsModel(vtl::TList<TraceEvent> *e, QObject *parent):
 	QAbstractTableModel(parent), has_flag_field(false), events(e),
-	eventsPtrs(nullptr)
+	selection(nullptr), nrEvents(-1)
 {}
 
-void EventsModel::setEvents(vtl::TList<TraceEvent> *e)
+/*
+ * If nr is non-negative, then only the first nr events are shown. This is
+ * used when the list is still being appended to by the parser.
+ */
+void EventsModel::setEvents(vtl::TList<TraceEvent> *e, int nr)
 {
 	events = e;
-	eventsPtrs = nullptr;
+	selection = nullptr;
+	nrEvents = nr;
 	checkFlagField();
 }
 
-void EventsModel::setEvents(vtl::TList<const TraceEvent*> *e)
+void EventsModel::setEvents(vtl::TList<TraceEvent> *e,
+			    const vtl::RankBitmap *sel)
 {
-	events = nullptr;
-	eventsPtrs = e;
+	events = e;
+	selection = sel;
+	nrEvents = -1;
 	checkFlagField();
 }
 
 void EventsModel::clear()
 {
 	events = nullptr;
-	eventsPtrs = nullptr;
+	selection = nullptr;
+	nrEvents = -1;
 	checkFlagField();
 }
 
@@ -151,7 +160,7 @@ QVariant EventsModel::data(const QModelIndex &index, int role) const
 		column_t column = int_to_column(col);
 		int size;
 
-		if (events == nullptr && eventsPtrs == nullptr)
+		if (events == nullptr)
 			return QVariant();
 		size = getSize();
 		if ( row >= size || row < 0)
@@ -253,20 +262,91 @@ void EventsModel::endResetModel()
 	QAbstractTableModel::endResetModel();
 }
 
+/*
+ * These are used instead of a reset when the filters are changed, so that the
+ * views keep their selection and current event. beginFilterUpdate() must be
+ * called before the filtered events are changed and endFilterUpdate() after
+ * the new events have been set. The persistent indices are moved to the rows
+ * of the same events, or invalidated if their events were filtered out.
+ */
+void EventsModel::beginFilterUpdate()
+{
+	int i, s;
+
+	emit layoutAboutToBeChanged();
+	filterPersistent = persistentIndexList();
+	s = filterPersistent.size();
+	filterPersistentEvents.resize(s);
+	for (i = 0; i < s; i++)
+		filterPersistentEvents[i] =
+			eventIndexAt(filterPersistent[i].row());
+}
+
+void EventsModel::endFilterUpdate()
+{
+	QModelIndexList to;
+	const QModelIndex *from;
+	int i, s, row;
+
+	s = filterPersistent.size();
+	to.reserve(s);
+	for (i = 0; i < s; i++) {
+		from = &filterPersistent.at(i);
+		row = rowOfEventIndex(filterPersistentEvents[i]);
+		if (row >= 0)
+			to.append(index(row, from->column()));
+		else
+			to.append(QModelIndex());
+	}
+	changePersistentIndexList(filterPersistent, to);
+	filterPersistent.clear();
+	filterPersistentEvents.clear();
+	emit layoutChanged();
+}
+
 const TraceEvent* EventsModel::getEventAt(int index) const
 {
-	if (events != nullptr)
-		return &events->at(index);
-	if (eventsPtrs != nullptr)
-		return eventsPtrs->at(index);
-	return nullptr;
+	if (events == nullptr)
+		return nullptr;
+	if (selection != nullptr)
+		return &events->at(selection->select(index));
+	return &events->at(index);
+}
+
+/* Returns the index of the event at row, or -1 if there is no such row */
+eventidx_t EventsModel::eventIndexAt(int row) const
+{
+	if (events == nullptr || row < 0 || row >= getSize())
+		return -1;
+	if (selection != nullptr)
+		return selection->select(row);
+	return row;
+}
+
+/* Returns the row of the event, or -1 if it is not shown */
+int EventsModel::rowOfEventIndex(eventidx_t idx) const
+{
+	eventidx_t row;
+
+	if (events == nullptr || idx < 0)
+		return -1;
+	if (selection != nullptr) {
+		if (idx >= selection->size() || !selection->test(idx))
+			return -1;
+		row = selection->rank(idx);
+	} else {
+		row = idx;
+	}
+	return row < getSize() ? (int) row : -1;
 }
 
+/* Qt model rows are int, so only the first INT_MAX events can be shown */
 int EventsModel::getSize() const
 {
-	if (events != nullptr)
-		return events->size();
-	if (eventsPtrs != nullptr)
-		return eventsPtrs->size();
-	return 0;
+	if (events == nullptr)
+		return 0;
+	if (selection != nullptr)
+		return (int) qMin(selection->count(), (int64_t) INT_MAX);
+	return nrEvents >= 0 ? nrEvents :
+		(int) qMin(events->size(), (int64_t) INT_MAX);
 }
@@ -55,11 +55,14 @@
 #define EVENTSMODEL_H
 
 #include <QAbstractTableModel>
+#include <QVector>
+#include "misc/types.h"
 #include "vtl/compiler.h"
 
 class TraceEvent;
 namespace vtl {
 	template<class T> class TList;
+	class RankBitmap;
 }
 
 class EventsModel : public QAbstractTableModel
@@ -78,8 +81,9 @@ public:
 	} column_t;
 	EventsModel(QObject *parent = 0);
 	EventsModel(vtl::TList<TraceEvent> *e, QObject *parent = 0);
-	void setEvents(vtl::TList<TraceEvent> *e);
-	void setEvents(vtl::TList<const TraceEvent*> *e);
+	void setEvents(vtl::TList<TraceEvent> *e, int nr = -1);
+	void setEvents(vtl::TList<TraceEvent> *e,
+		       const vtl::RankBitmap *sel);
 	void clear();
 	int rowCount(const QModelIndex &parent) const;
 	int columnCount(const QModelIndex &parent) const;
@@ -90,14 +94,24 @@ public:
 			    int role) const;
 	void beginResetModel();
 	void endResetModel();
+	void beginFilterUpdate();
+	void endFilterUpdate();
 	Qt::ItemFlags flags(const QModelIndex &index) const;
 	vtl_always_inline column_t int_to_column(int i) const;
 	vtl_always_inline int column_to_int(column_t c) const;
 private:
 	bool has_flag_field;
 	vtl::TList<TraceEvent> *events;
-	vtl::TList<const TraceEvent*> *eventsPtrs;
+	/* If not null, only the events that are set in selection are shown */
+	const vtl::RankBitmap *selection;
+	/* If non-negative, only this many events of events are shown */
+	int nrEvents;
+	/* The persistent indices and their events during a filter update */
+	QModelIndexList filterPersistent;
+	QVector<eventidx_t> filterPersistentEvents;
 	const TraceEvent* getEventAt(int index) const;
+	eventidx_t eventIndexAt(int row) const;
+	int rowOfEventIndex(eventidx_t idx) const;
 	int getSize() const;
 	void checkFlagField(void);
 };
@@ -52,6 +52,7 @@
 
 #include <QTableView>
 #include <cmath>
+#include "vtl/rankbitmap.h"
 #include "vtl/tlist.h"
 #include "ui/eventsmodel.h"
 #include "ui/eventswidget.h"
@@ -61,7 +62,8 @@
 
 EventsWidget::EventsWidget(QWidget *parent):
 	QDockWidget(tr("Events"), parent), events(nullptr),
-	eventsPtrs(nullptr), saveScrollTime(false), selectedEvent(nullptr)
+	selection(nullptr), nrEvents(-1), saveScrollTime(false),
+	selectedEvent(nullptr)
 {
 	tableView = new TableView(this, TableView::TABLE_SINGLEROWSELECT);
 	eventsModel = new EventsModel(tableView);
@@ -79,8 +81,8 @@ EventsWidget::EventsWidget(QWidget *parent):
 }
 
 EventsWidget::EventsWidget(vtl::TList<TraceEvent> *e, QWidget *parent):
-	QDockWidget(parent), eventsPtrs(nullptr), saveScrollTime(false),
-	selectedEvent(nullptr)
+	QDockWidget(parent), selection(nullptr), nrEvents(-1),
+	saveScrollTime(false), selectedEvent(nullptr)
 {
 	tableView = new TableView(this, TableView::TABLE_SINGLEROWSELECT);
 	eventsModel = new EventsModel(e, tableView);
@@ -102,25 +104,29 @@ EventsWidget::~EventsWidget()
 {
 }
 
-void EventsWidget::setEvents(vtl::TList<TraceEvent> *e)
+void EventsWidget::setEvents(vtl::TList<TraceEvent> *e, int nr)
 {
-	eventsModel->setEvents(e);
+	eventsModel->setEvents(e, nr);
 	events = e;
-	eventsPtrs = nullptr;
+	selection = nullptr;
+	nrEvents = nr;
 }
 
-void EventsWidget::setEvents(vtl::TList<const TraceEvent*> *e)
+void EventsWidget::setEvents(vtl::TList<TraceEvent> *e,
+			     const vtl::RankBitmap *sel)
 {
-	eventsModel->setEvents(e);
-	events = nullptr;
-	eventsPtrs = e;
+	eventsModel->setEvents(e, sel);
+	events = e;
+	selection = sel;
+	nrEvents = -1;
 }
 
 void EventsWidget::clear()
 {
 	eventsModel->clear();
 	events = nullptr;
-	eventsPtrs = nullptr;
+	selection = nullptr;
+	nrEvents = -1;
 }
 
 void EventsWidget::clearScrollTime()
@@ -132,7 +138,7 @@ void EventsWidget::beginResetModel()
 {
 	eventsModel->beginResetModel();
 	events = nullptr;
-	eventsPtrs = nullptr;
+	selection = nullptr;
 }
 
 void EventsWidget::endResetModel()
@@ -141,9 +147,19 @@ void EventsWidget::endResetModel()
 	resizeColumnsToContents();
 }
 
+void EventsWidget::beginFilterUpdate()
+{
+	eventsModel->beginFilterUpdate();
+}
+
+void EventsWidget::endFilterUpdate()
+{
+	eventsModel->endFilterUpdate();
+}
+
 void EventsWidget::scrollTo(const vtl::Time &time)
 {
-	if (events != nullptr || eventsPtrs != nullptr) {
+	if (events != nullptr) {
 		int n = findBestMatch(time);
 		tableView->selectRow(n);
 		resizeColumnsToContents();
@@ -152,12 +168,12 @@ void EventsWidget::scrollTo(const vtl::Time &time)
 	}
 }
 
-void EventsWidget::scrollTo(int n)
+void EventsWidget::scrollTo(eventidx_t n)
 {
-	if (n < 0 || (events == nullptr && eventsPtrs == nullptr))
+	if (n < 0 || events == nullptr)
 		return;
-	unsigned int index = (unsigned int) n;
-	if (index < getSize()) {
+	if (n < getSize()) {
+		unsigned int index = (unsigned int) n;
 		tableView->selectRow(index);
 		resizeColumnsToContents();
 		scrollTime = getEventAt(index)->time;
@@ -283,11 +299,7 @@ const TraceEvent *EventsWidget::getSelectedEvent()
 			goto out;
 	}
 
-	if (events != nullptr) {
-		event = &events->at(row);
-	} else if (eventsPtrs != nullptr) {
-		event = eventsPtrs->at(row);
-	}
+	event = getEventAt(row);
 
 out:
 	return event;
@@ -309,20 +321,21 @@ void EventsWidget::show()
 
 const TraceEvent* EventsWidget::getEventAt(int index) const
 {
-	if (events != nullptr)
-		return &events->at(index);
-	if (eventsPtrs != nullptr)
-		return eventsPtrs->at(index);
-	return nullptr;
+	if (events == nullptr)
+		return nullptr;
+	if (selection != nullptr)
+		return &events->at(selection->select(index));
+	return &events->at(index);
 }
 
 unsigned int EventsWidget::getSize() const
 {
-	if (events != nullptr)
-		return events->size();
-	if (eventsPtrs != nullptr)
-		return eventsPtrs->size();
-	return 0;
+	if (events == nullptr)
+		return 0;
+	if (selection != nullptr)
+		return (int) qMin(selection->count(), (int64_t) INT_MAX);
+	return nrEvents >= 0 ? nrEvents :
+		(int) qMin(events->size(), (int64_t) INT_MAX);
 }
 
 vtl::Time EventsWidget::getSavedScroll()
@@ -55,6 +55,7 @@
 
 #include <QDockWidget>
 #include "misc/traceshark.h"
+#include "misc/types.h"
 #include "vtl/time.h"
 #include "ui/eventsmodel.h"
 
@@ -63,6 +64,7 @@ class EventsModel;
 class TraceEvent;
 namespace vtl {
 	template<class T> class TList;
+	class RankBitmap;
 }
 
 class EventsWidget : public QDockWidget
@@ -72,15 +74,18 @@ public:
 	EventsWidget(QWidget *parent = 0);
 	EventsWidget(vtl::TList<TraceEvent> *e, QWidget *parent = 0);
 	virtual ~EventsWidget();
-	void setEvents(vtl::TList<TraceEvent> *e);
-	void setEvents(vtl::TList<const TraceEvent*> *e);
+	void setEvents(vtl::TList<TraceEvent> *e, int nr = -1);
+	void setEvents(vtl::TList<TraceEvent> *e,
+		       const vtl::RankBitmap *sel);
 	void clear();
 	void clearScrollTime();
 	void beginResetModel();
 	void endResetModel();
+	void beginFilterUpdate();
+	void endFilterUpdate();
 	void resizeColumnsToContents();
 	void scrollTo(const vtl::Time &time);
-	void scrollTo(int n);
+	void scrollTo(eventidx_t n);
 	void scrollToSaved();
 	vtl::Time getSavedScroll();
 	const TraceEvent *getSelectedEvent();
@@ -98,7 +103,9 @@ private:
 	TableView *tableView;
 	EventsModel *eventsModel;
 	vtl::TList<TraceEvent> *events;
-	vtl::TList<const TraceEvent*> *eventsPtrs;
+	/* If not null, only the events that are set in selection are shown */
+	const vtl::RankBitmap *selection;
+	int nrEvents;
 	bool saveScrollTime;
 	vtl::Time scrollTime;
 	const TraceEvent *selectedEvent;
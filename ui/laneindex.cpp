@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "ui/laneindex.h"
+#include "vtl/bitvector.h"
+
+LaneIndex::LaneIndex():
+	treeSize(0), valid(false)
+{}
+
+void LaneIndex::clear()
+{
+	runs.clear();
+	maxEnd.clear();
+	spans.clear();
+	coords.clear();
+	nodes.clear();
+	treeSize = 0;
+	valid = false;
+}
+
+bool LaneIndex::isValid() const
+{
+	return valid;
+}
+
+/*
+ * Adds the first n points of a step left graph. The keys must be sorted. The
+ * index needs to be built with build() after all tasks have been added.
+ */
+void LaneIndex::addTask(int task, const QVector<double> &keys,
+			const vtl::BitVector &sched, int n)
+{
+	Run run;
+	Span span;
+	int i;
+
+	if (n < 2)
+		return;
+
+	span.first = keys[0];
+	span.last = keys[n - 1];
+	span.task = task;
+	spans.append(span);
+
+	run.task = task;
+	i = 0;
+	while (i < n - 1) {
+		if (!sched.readbool(i)) {
+			i++;
+			continue;
+		}
+		/* The value of point i is drawn until point i + 1 */
+		run.start = keys[i];
+		do {
+			i++;
+		} while (i < n - 1 && sched.readbool(i));
+		run.end = keys[i];
+		runs.append(run);
+	}
+}
+
+void LaneIndex::build()
+{
+	int size, i, l, r;
+	double m;
+
+	std::sort(runs.begin(), runs.end(),
+		  [](const Run &a, const Run &b) { return a.start < b.start; });
+	maxEnd.resize(runs.size());
+	m = 0;
+	for (i = 0; i < runs.size(); i++) {
+		m = i == 0 ? runs[i].end : qMax(m, runs[i].end);
+		maxEnd[i] = m;
+	}
+
+	coords.resize(0);
+	for (const Span &span : spans) {
+		coords.append(span.first);
+		coords.append(span.last);
+	}
+	std::sort(coords.begin(), coords.end());
+	coords.erase(std::unique(coords.begin(), coords.end()), coords.end());
+
+	/*
+	 * Leaf i is the interval [coords[i], coords[i + 1]). The spans are
+	 * added in ascending task order, so the lists of the nodes stay sorted.
+	 */
+	for (size = 1; size < coords.size() - 1; size *= 2)
+		;
+	nodes.clear();
+	nodes.resize(2 * size);
+	std::sort(spans.begin(), spans.end(),
+		  [](const Span &a, const Span &b) { return a.task < b.task; });
+	for (const Span &span : spans) {
+		l = int(std::lower_bound(coords.constBegin(), coords.constEnd(),
+					 span.first) - coords.constBegin());
+		r = int(std::lower_bound(coords.constBegin(), coords.constEnd(),
+					 span.last) - coords.constBegin());
+		for (l += size, r += size; l < r; l /= 2, r /= 2) {
+			if (l & 1)
+				nodes[l++].append(span.task);
+			if (r & 1)
+				nodes[--r].append(span.task);
+		}
+	}
+	treeSize = size;
+	valid = true;
+}
+
+/*
+ * Finds the tasks that have a run that overlaps [from, to]. Returns false if
+ * there are more than maxRuns such runs, in which case the caller should look
+ * at all tasks instead. The task numbers are sorted and unique.
+ */
+bool LaneIndex::findRuns(double from, double to, int maxRuns,
+			 QVector<int> *tasks) const
+{
+	int i, found = 0;
+
+	tasks->resize(0);
+	i = int(std::upper_bound(runs.constBegin(), runs.constEnd(), to,
+				 [](double key, const Run &run) {
+					 return key < run.start;
+				 }) - runs.constBegin()) - 1;
+	for (; i >= 0 && maxEnd[i] >= from; i--) {
+		if (runs[i].end < from)
+			continue;
+		if (++found > maxRuns)
+			return false;
+		tasks->append(runs[i].task);
+	}
+	std::sort(tasks->begin(), tasks->end());
+	tasks->erase(std::unique(tasks->begin(), tasks->end()), tasks->end());
+	return true;
+}
+
+/*
+ * Returns the task with the highest number whose span contains key and which
+ * is not in excluded, or -1 if there is none. The excluded vector must be
+ * sorted.
+ */
+int LaneIndex::topTask(double key, const QVector<int> &excluded) const
+{
+	int best = -1;
+	int leaf, i, j;
+
+	leaf = int(std::upper_bound(coords.constBegin(), coords.constEnd(),
+				    key) - coords.constBegin()) - 1;
+	if (leaf < 0 || leaf >= coords.size() - 1)
+		return -1;
+
+	for (i = leaf + treeSize; i >= 1; i /= 2) {
+		const QVector<int> &list = nodes[i];
+		for (j = list.size() - 1; j >= 0 && list[j] > best; j--) {
+			if (!std::binary_search(excluded.constBegin(),
+						excluded.constEnd(), list[j])) {
+				best = list[j];
+				break;
+			}
+		}
+	}
+	return best;
+}
@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LANEINDEX_H
+#define LANEINDEX_H
+
+#include <QVector>
+
+namespace vtl {
+	class BitVector;
+}
+
+/*
+ * A spatial index of the scheduling graphs of a CPU lane, which makes it
+ * possible to find the tasks under the mouse without looking at every task.
+ *
+ * Only one task runs on a CPU at a time, so the intervals where the graphs are
+ * high are kept in a single vector that is sorted by time. The graphs of all
+ * other tasks are at the floor, where the task that was added last is on top.
+ * The spans of the tasks are kept in a segment tree, so that the topmost task
+ * at a given time can be found in O(log(n)) time.
+ */
+class LaneIndex {
+public:
+	LaneIndex();
+	void clear();
+	bool isValid() const;
+	void addTask(int task, const QVector<double> &keys,
+		     const vtl::BitVector &sched, int n);
+	void build();
+	bool findRuns(double from, double to, int maxRuns,
+		      QVector<int> *tasks) const;
+	int topTask(double key, const QVector<int> &excluded) const;
+private:
+	/* An interval where the graph of a task is high */
+	class Run {
+	public:
+		double start;
+		double end;
+		int task;
+	};
+	class Span {
+	public:
+		double first;
+		double last;
+		int task;
+	};
+	QVector<Run> runs;
+	/* The largest end of the runs up to and including an index */
+	QVector<double> maxEnd;
+	QVector<Span> spans;
+	/* The sorted endpoints of the spans */
+	QVector<double> coords;
+	/* The number of leaves of the tree, a power of two */
+	int treeSize;
+	/* Each node has the tasks that span it, in ascending order */
+	QVector<QVector<int>> nodes;
+	bool valid;
+};
+
+#endif /* LANEINDEX_H */
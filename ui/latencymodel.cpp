@@ -184,19 +184,21 @@ const Latency* LatencyModel::rowToLatency(int index) const
 	return nullptr;
 }
 
+/* Qt model rows are int, so only the first INT_MAX latencies can be shown */
 int LatencyModel::getSize() const
 {
 	if (latencies != nullptr)
-		return latencies->size();
+		return (int) qMin(latencies->size(), (int64_t) INT_MAX);
 	return 0;
 }
 
 
-QString LatencyModel::placeToPct(unsigned int place) const
+/* The places are of all latencies, not only of those that fit in the rows */
+QString LatencyModel::placeToPct(int64_t place) const
 {
 	uint64_t pct = 10000UL;
-	const int size = getSize();
-	const unsigned int usize = size > 1 ? size - 1 : 1;
+	const int64_t size = latencies != nullptr ? latencies->size() : 0;
+	const uint64_t usize = size > 1 ? size - 1 : 1;
 	char buf[16];
 	int bufsize = arraylen(buf);
 	int r;
@@ -96,7 +96,7 @@ public:
 	vtl_always_inline enum Latency::Type getLatencyType() const;
 private:
 	int getSize() const;
-	QString placeToPct(unsigned int place) const;
+	QString placeToPct(int64_t place) const;
 	enum Latency::Type latency_type;
 	vtl::TList<Latency> *latencies;
 	TraceAnalyzer *analyzer;
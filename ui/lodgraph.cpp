@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "ui/lodgraph.h"
+
+LodGraph::LodGraph(QCPAxis *keyAxis, QCPAxis *valueAxis):
+	QCPGraph(keyAxis, valueAxis), pyramid(nullptr), pyramidScale(1),
+	pyramidOffset(0)
+{}
+
+/*
+ * The lod pyramid must have been built from data v, such that values are
+ * lodScale * v + lodOffset. It's only used if the keys are sorted, because
+ * otherwise the order of the data in the graph will not be the same as in
+ * values.
+ */
+void LodGraph::setData(const QVector<double> &keys,
+		       const QVector<double> &values,
+		       const vtl::MinMaxPyramid *lod, double lodScale,
+		       double lodOffset)
+{
+	bool sorted = std::is_sorted(keys.constBegin(), keys.constEnd());
+
+	QCPGraph::setData(keys, values, sorted);
+	pyramid = sorted ? lod : nullptr;
+	pyramidScale = lodScale;
+	pyramidOffset = lodOffset;
+}
+
+/* Sampling is only worth it if there are at least two points per pixel */
+bool LodGraph::useSampling(const AxisMap &keyAxis, double firstKey,
+			   double lastKey, int nrPoints)
+{
+	double keyPixelSpan = qAbs(keyAxis.coordToPixel(firstKey) -
+				   keyAxis.coordToPixel(lastKey));
+
+	return (double) nrPoints >= 2 * keyPixelSpan + 2;
+}
+
+void LodGraph::getOptimizedLineData(
+	QVector<QCPGraphData> *lineData,
+	const QCPGraphDataContainer::const_iterator &begin,
+	const QCPGraphDataContainer::const_iterator &end) const
+{
+	QCPAxis *keyAxis = mKeyAxis.data();
+	QCPGraphDataContainer::const_iterator first;
+
+	if (lineData == nullptr || begin == end)
+		return;
+
+	if (keyAxis == nullptr || !mAdaptiveSampling || pyramid == nullptr ||
+	    keyAxis->scaleType() != QCPAxis::stLinear ||
+	    !pyramid->isValid() || pyramid->size() != mDataContainer->size() ||
+	    !useSampling(AxisMap(keyAxis), begin->key, (end - 1)->key,
+			 int(end - begin))) {
+		QCPGraph::getOptimizedLineData(lineData, begin, end);
+		return;
+	}
+
+	first = mDataContainer->constBegin();
+	sampleSteps(AxisMap(keyAxis),
+		    [first](int i) { return first[i].key; },
+		    [first](int i) { return first[i].value; },
+		    pyramid, pyramidScale, pyramidOffset, int(begin - first),
+		    int(end - first), lineData);
+}
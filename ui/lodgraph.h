@@ -0,0 +1,343 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LODGRAPH_H
+#define LODGRAPH_H
+
+#include <QPointF>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include "ui/axismap.h"
+#include "ui/qcustomplot.h"
+#include "vtl/minmaxpyramid.h"
+
+/*
+ * A step graph that uses a MinMaxPyramid of its values for the adaptive
+ * sampling, so that the cost of drawing it depends on the width of the plot
+ * in pixels instead of on the number of visible points. When zoomed in so far
+ * that there are few points per pixel, the raw data is drawn as usual.
+ */
+class LodGraph : public QCPGraph
+{
+	Q_OBJECT
+public:
+	LodGraph(QCPAxis *keyAxis, QCPAxis *valueAxis);
+	void setData(const QVector<double> &keys,
+		     const QVector<double> &values,
+		     const vtl::MinMaxPyramid *lod, double lodScale = 1,
+		     double lodOffset = 0);
+	static bool useSampling(const AxisMap &keyAxis, double firstKey,
+				double lastKey, int nrPoints);
+	template<typename KeyAt, typename ValueAt>
+	static void sampleSteps(const AxisMap &keyAxis, const KeyAt &keyAt,
+				const ValueAt &valueAt,
+				const vtl::MinMaxPyramid *pyramid,
+				double lodScale, double lodOffset,
+				int begin, int end,
+				QVector<QCPGraphData> *lineData);
+	template<typename ValueAt>
+	static void stepLines(const AxisMap &keyAxis,
+			      const AxisMap &valueAxis,
+			      const QVector<double> &keys,
+			      const ValueAt &valueAt,
+			      const vtl::MinMaxPyramid *pyramid,
+			      double lodScale, double lodOffset,
+			      int begin, int end,
+			      QVector<QCPGraphData> *lineData,
+			      QVector<QPointF> *lines);
+	template<typename ValueAt>
+	static double stepDistance(const AxisMap &keyAxis,
+				   const AxisMap &valueAxis,
+				   const QPointF &pos, double tolerance,
+				   const QVector<double> &keys,
+				   const ValueAt &valueAt, int n, bool sorted,
+				   const vtl::MinMaxPyramid *pyramid,
+				   double lodScale, double lodOffset);
+protected:
+	void getOptimizedLineData(
+		QVector<QCPGraphData> *lineData,
+		const QCPGraphDataContainer::const_iterator &begin,
+		const QCPGraphDataContainer::const_iterator &end) const
+		Q_DECL_OVERRIDE;
+private:
+	template<typename KeyAt>
+	static int findIntervalEnd(const KeyAt &keyAt, int i, int end,
+				   double limit);
+	const vtl::MinMaxPyramid *pyramid;
+	double pyramidScale;
+	double pyramidOffset;
+};
+
+/*
+ * Returns the first index from i that has a key that is not less than limit,
+ * or end. The index i is always skipped. The search gallops forward so that
+ * it's cheap when there are only a few points in the interval.
+ */
+template<typename KeyAt>
+int LodGraph::findIntervalEnd(const KeyAt &keyAt, int i, int end,
+			      double limit)
+{
+	int lo = i + 1;
+	int hi, mid;
+	int step = 1;
+
+	if (lo == end || keyAt(lo) >= limit)
+		return lo;
+
+	while (true) {
+		hi = (end - lo > step) ? lo + step : end;
+		if (hi == end || keyAt(hi) >= limit)
+			break;
+		lo = hi;
+		step *= 2;
+	}
+
+	/* Now keyAt(lo) < limit and hi is either end or keyAt(hi) >= limit */
+	lo++;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (keyAt(mid) < limit)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/*
+ * This does the same adaptive sampling as QCPGraph but instead of visiting
+ * every point in [begin, end), it jumps to the end of each pixel interval and
+ * asks the pyramid for the minimum and maximum values in the interval. The
+ * keys must be sorted and the values must be lodScale * v + lodOffset, where
+ * v is the data that the pyramid was built from.
+ */
+template<typename KeyAt, typename ValueAt>
+void LodGraph::sampleSteps(const AxisMap &keyAxis, const KeyAt &keyAt,
+			   const ValueAt &valueAt,
+			   const vtl::MinMaxPyramid *pyramid,
+			   double lodScale, double lodOffset,
+			   int begin, int end,
+			   QVector<QCPGraphData> *lineData)
+{
+	const int reversedFactor = keyAxis.pixelOrientation();
+	const int reversedRound = reversedFactor == -1 ? 1 : 0;
+	double startKey, lastEndKey, keyEpsilon;
+	double minValue, maxValue;
+	int changes;
+	int i, next;
+
+	lastEndKey = keyAxis.pixelToCoord(
+		int(keyAxis.coordToPixel(keyAt(begin)) + reversedRound));
+
+	for (i = begin; i < end; i = next) {
+		startKey = keyAxis.pixelToCoord(
+			int(keyAxis.coordToPixel(keyAt(i)) + reversedRound));
+		keyEpsilon = qAbs(startKey - keyAxis.pixelToCoord(
+				     keyAxis.coordToPixel(startKey) +
+				     1.0 * reversedFactor));
+		next = findIntervalEnd(keyAt, i, end, startKey + keyEpsilon);
+		if (next - i < 2) {
+			lineData->append(QCPGraphData(keyAt(i), valueAt(i)));
+			lastEndKey = keyAt(i);
+			continue;
+		}
+		pyramid->query(i, next, minValue, maxValue, changes);
+		minValue = minValue * lodScale + lodOffset;
+		maxValue = maxValue * lodScale + lodOffset;
+		if (minValue > maxValue)
+			std::swap(minValue, maxValue);
+		/* A flat interval is drawn like a single point */
+		if (changes == 0) {
+			lineData->append(QCPGraphData(keyAt(i), valueAt(i)));
+			lastEndKey = keyAt(next - 1);
+			continue;
+		}
+		if (lastEndKey < startKey - keyEpsilon)
+			lineData->append(QCPGraphData(
+				startKey + keyEpsilon * 0.2, valueAt(i)));
+		lineData->append(QCPGraphData(startKey + keyEpsilon * 0.25,
+					      minValue));
+		lineData->append(QCPGraphData(startKey + keyEpsilon * 0.75,
+					      maxValue));
+		if (next != end && keyAt(next) > startKey + keyEpsilon * 2)
+			lineData->append(QCPGraphData(
+				startKey + keyEpsilon * 0.8,
+				valueAt(next - 1)));
+		lastEndKey = keyAt(next - 1);
+	}
+}
+
+/*
+ * Computes the pixel polyline of a step left graph of the points in
+ * [begin, end), which must not be empty. The range is sampled with
+ * sampleSteps() if pyramid is not nullptr and there are many points per pixel,
+ * so the pyramid must only be given if the keys are sorted. The key axis is
+ * assumed to be horizontal.
+ */
+template<typename ValueAt>
+void LodGraph::stepLines(const AxisMap &keyAxis, const AxisMap &valueAxis,
+			 const QVector<double> &keys, const ValueAt &valueAt,
+			 const vtl::MinMaxPyramid *pyramid,
+			 double lodScale, double lodOffset,
+			 int begin, int end,
+			 QVector<QCPGraphData> *lineData,
+			 QVector<QPointF> *lines)
+{
+	const double *k = keys.constData();
+	double x, y, lastY;
+	int i;
+
+	lineData->resize(0);
+	if (pyramid != nullptr &&
+	    useSampling(keyAxis, k[begin], k[end - 1], end - begin)) {
+		sampleSteps(keyAxis, [k](int j) { return k[j]; }, valueAt,
+			    pyramid, lodScale, lodOffset, begin, end,
+			    lineData);
+	} else {
+		for (i = begin; i < end; i++)
+			lineData->append(QCPGraphData(k[i], valueAt(i)));
+	}
+
+	/* This is what QCPGraph does for lsStepLeft */
+	lines->resize(lineData->size() * 2);
+	lastY = valueAxis.coordToPixel(lineData->at(0).value);
+	for (i = 0; i < lineData->size(); i++) {
+		x = keyAxis.coordToPixel(lineData->at(i).key);
+		y = valueAxis.coordToPixel(lineData->at(i).value);
+		(*lines)[2 * i] = QPointF(x, lastY);
+		(*lines)[2 * i + 1] = QPointF(x, y);
+		lastY = y;
+	}
+}
+
+/* Above this many segments, stepDistance() uses the pyramid */
+#define LODGRAPH_MAX_EXACT_SEGMENTS (32)
+
+/*
+ * Returns the distance in pixels from pos to the step left graph of the first
+ * n points, or -1 if the graph is not within tolerance pixels of pos in the
+ * key direction. The pyramid is used in the same way as in stepLines(), when
+ * there are many transitions near pos, because then the graph looks like a
+ * vertical bar between the minimum and maximum value.
+ */
+template<typename ValueAt>
+double LodGraph::stepDistance(const AxisMap &keyAxis,
+			      const AxisMap &valueAxis,
+			      const QPointF &pos, double tolerance,
+			      const QVector<double> &keys,
+			      const ValueAt &valueAt, int n, bool sorted,
+			      const vtl::MinMaxPyramid *pyramid,
+			      double lodScale, double lodOffset)
+{
+	const double *k = keys.constData();
+	double k1, k2, y1, y2, d, best;
+	double minValue, maxValue;
+	QCPVector2D p(pos), p0, p1, p2;
+	int a, b, j, changes;
+
+	if (n == 0)
+		return -1;
+
+	k1 = keyAxis.pixelToCoord(pos.x() - tolerance);
+	k2 = keyAxis.pixelToCoord(pos.x() + tolerance);
+	if (k1 > k2)
+		std::swap(k1, k2);
+
+	if (sorted) {
+		if (k2 < k[0] || k1 > k[n - 1])
+			return -1;
+		/* The last point before k1 and the first point after k2 */
+		a = int(std::upper_bound(k, k + n, k1) - k) - 1;
+		a = qMax(a, 0);
+		b = int(std::lower_bound(k, k + n, k2) - k);
+		b = qMin(b, n - 1);
+	} else {
+		a = 0;
+		b = n - 1;
+	}
+
+	if (a == b)
+		return (p - QCPVector2D(keyAxis.coordToPixel(k[a]),
+					valueAxis.coordToPixel(valueAt(a))))
+			.length();
+
+	if (sorted && pyramid != nullptr &&
+	    b - a > LODGRAPH_MAX_EXACT_SEGMENTS) {
+		pyramid->query(a, b + 1, minValue, maxValue, changes);
+		y1 = valueAxis.coordToPixel(minValue * lodScale + lodOffset);
+		y2 = valueAxis.coordToPixel(maxValue * lodScale + lodOffset);
+		if (y1 > y2)
+			std::swap(y1, y2);
+		if (pos.y() < y1)
+			return y1 - pos.y();
+		if (pos.y() > y2)
+			return pos.y() - y2;
+		return 0;
+	}
+
+	best = -1;
+	for (j = a; j < b; j++) {
+		p0 = QCPVector2D(keyAxis.coordToPixel(k[j]),
+				 valueAxis.coordToPixel(valueAt(j)));
+		p1 = QCPVector2D(keyAxis.coordToPixel(k[j + 1]), p0.y());
+		p2 = QCPVector2D(p1.x(),
+				 valueAxis.coordToPixel(valueAt(j + 1)));
+		d = qMin(p.distanceSquaredToLine(p0, p1),
+			 p.distanceSquaredToLine(p1, p2));
+		if (best < 0 || d < best)
+			best = d;
+	}
+	return std::sqrt(best);
+}
+
+#endif /* LODGRAPH_H */
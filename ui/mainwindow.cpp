@@ -50,6 +50,7 @@
  *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <climits>
 #include <cstdio>
 #include <cstring>
 #include <utility>
@@ -58,13 +59,17 @@
 #include <QColorDialog>
 #include <QDateTime>
 #include <QList>
+#include <QProgressBar>
 #include <QScrollBar>
 #include <QVBoxLayout>
 #include <QToolBar>
+#include <QToolButton>
 
+#include "ui/cpulanegraph.h"
 #include "ui/cursor.h"
 #include "ui/eventinfodialog.h"
 #include "ui/eventswidget.h"
+#include "analyzer/analyzerjobs.h"
 #include "analyzer/traceanalyzer.h"
 #include "ui/errordialog.h"
 #include "ui/graphenabledialog.h"
@@ -72,12 +77,15 @@
 #include "ui/latencywidget.h"
 #include "ui/licensedialog.h"
 #include "ui/mainwindow.h"
+#include "ui/migrationgraph.h"
 #include "ui/migrationline.h"
 #include "ui/regexdialog.h"
+#include "ui/stepgraph.h"
 #include "ui/taskgraph.h"
 #include "ui/taskrangeallocator.h"
 #include "ui/taskselectdialog.h"
 #include "ui/tasktoolbar.h"
+#include "ui/tilecache.h"
 #include "ui/eventselectdialog.h"
 #include "ui/cpuselectdialog.h"
 #include "parser/traceevent.h"
@@ -90,6 +98,7 @@
 #include "misc/settingstore.h"
 #include "misc/statefile.h"
 #include "misc/traceshark.h"
+#include "threads/jobrunner.h"
 #include "threads/workqueue.h"
 #include "threads/workitem.h"
 #include "ui/qcustomplot.h"
@@ -248,6 +257,14 @@ const double MainWindow::refDpiY = 96;
 
 const double MainWindow::migrateSectionOffset = 250;
 
+/*
+ * When opening a trace, we show a preview after this many events have been
+ * processed, and then again each time that the number of processed events has
+ * grown by previewGrowthFactor, until the whole trace has been processed.
+ */
+const int MainWindow::previewNrEvents = 300000;
+const int MainWindow::previewGrowthFactor = 8;
+
 const QString MainWindow::RUNNING_NAME = tr("is runnable");
 const QString MainWindow::PREEMPTED_NAME = tr("was preempted");
 const QString MainWindow::UNINT_NAME = tr("uninterruptible");
@@ -301,6 +318,12 @@ MainWindow::MainWindow():
 	loadSettings();
 
 	analyzer = new TraceAnalyzer(settingStore);
+	/*
+	 * The filtering is done by the jobRunner, so that the GUI stays
+	 * responsive while it is in progress.
+	 */
+	analyzer->setDeferFilters(true);
+	jobRunner = new JobRunner(this);
 
 	infoWidget = new InfoWidget(this);
 	infoWidget->setAllowedAreas(Qt::TopDockWidgetArea |
@@ -311,6 +334,11 @@ MainWindow::MainWindow():
 	createToolBars();
 	createMenus();
 	createStatusBar();
+	tsconnect(jobRunner, jobFinished(BackgroundJob *), this,
+		  jobFinished(BackgroundJob *));
+	tsconnect(jobRunner, progressChanged(int), this, jobProgress(int));
+	tsconnect(jobRunner, busyChanged(bool), this, jobBusyChanged(bool));
+	tsconnect(jobCancelButton, clicked(), this, cancelJobs());
 
 	plotWidget = new QWidget(this);
 	plotLayout = new QHBoxLayout(plotWidget);
@@ -365,9 +393,21 @@ void MainWindow::createTracePlot()
 
 	tracePlot->addLayer(cursorLayerName, mainLayer, QCustomPlot::limAbove);
 	cursorLayer = tracePlot->layer(cursorLayerName);
+	/*
+	 * The cursor layer gets a paint buffer of its own, so that moving a
+	 * cursor only needs to redraw the cursors.
+	 */
+	cursorLayer->setMode(QCPLayer::lmBuffered);
 
 	tracePlot->setCurrentLayer(mainLayerName);
 
+	/*
+	 * This needs to be created before the plottables, so that the lanes
+	 * are drawn below the unified graphs, like when they are not tiled.
+	 */
+	tileCache = new TileCache(tracePlot, tracePlot->xAxis,
+				  tracePlot->yAxis);
+
 	tracePlot->setAutoAddPlottableToLegend(false);
 	tracePlot->hide();
 	plotLayout->addWidget(tracePlot);
@@ -376,7 +416,6 @@ void MainWindow::createTracePlot()
 				   QCP::iSelectAxes | QCP::iSelectLegend |
 				   QCP::iSelectPlottables);
 
-	analyzer->setQCustomPlot(tracePlot);
 }
 
 void MainWindow::createScrollBar()
@@ -434,6 +473,8 @@ MainWindow::~MainWindow()
 {
 	int i;
 
+	jobRunner->cancelAll();
+	jobRunner->waitIdle();
 	if (analyzer->isOpen())
 		closeTrace();
 	delete analyzer;
@@ -557,9 +598,6 @@ void MainWindow::openFile(const QString &name)
 					       analyzer->getNrCPUs());
 		statsLimitedDialog->endResetModel();
 
-		schedLatencyWidget->setAnalyzer(analyzer);
-		wakeupLatencyWidget->setAnalyzer(analyzer);
-
 		showTrace();
 		showt = QDateTime::currentDateTimeUtc().toMSecsSinceEpoch();
 
@@ -615,14 +653,67 @@ void MainWindow::processTrace()
 {
 	const QMap<int, QColor> &cmap = stateFile->getColorMap();
 	bool usercolors;
+	bool done;
+	bool preview = false;
+	eventidx_t nrEvents = previewNrEvents;
+
+	usercolors = analyzer->processTracePartial(cmap, nrEvents, done);
+	while (!done) {
+		startTime = analyzer->getStartTime().toDouble();
+		endTime = analyzer->getEndTime().toDouble();
+		showPreview();
+		preview = true;
+		/*
+		 * Once another step would overflow, the last round processes
+		 * the rest of the trace.
+		 */
+		if (nrEvents > INT64_MAX / previewGrowthFactor)
+			nrEvents = INT64_MAX;
+		else
+			nrEvents *= previewGrowthFactor;
+		usercolors = analyzer->processTracePartial(cmap, nrEvents,
+							   done);
+	}
 
-	usercolors = analyzer->processTrace(cmap);
+	if (preview)
+		clearPlot();
 	startTime = analyzer->getStartTime().toDouble();
 	endTime = analyzer->getEndTime().toDouble();
 	if (usercolors)
 		setResetTaskColorEnabled(true);
 }
 
+/*
+ * This function shows what has been processed of a trace that is still being
+ * loaded. User input is not processed because the trace actions are not
+ * enabled until the whole trace has been processed.
+ */
+void MainWindow::showPreview()
+{
+	clearPlot();
+	computeLayout();
+
+	eventsWidget->beginResetModel();
+	eventsWidget->setEvents(analyzer->events,
+				(int) qMin(analyzer->getNrProcessedEvents(),
+					   (eventidx_t) INT_MAX));
+	eventsWidget->endResetModel();
+
+	taskSelectDialog->beginResetModel();
+	taskSelectDialog->setTaskMap(&analyzer->taskMap,
+				     analyzer->getNrCPUs());
+	taskSelectDialog->endResetModel();
+
+	cpuSelectDialog->beginResetModel();
+	cpuSelectDialog->setNrCPUs(analyzer->getNrCPUs());
+	cpuSelectDialog->endResetModel();
+
+	rescaleTrace();
+	showTrace();
+	tracePlot->show();
+	QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+}
+
 void MainWindow::computeLayout()
 {
 	unsigned int cpu;
@@ -637,6 +728,7 @@ void MainWindow::computeLayout()
 	nrCPUs = analyzer->getNrCPUs();
 	ticks.resize(0);
 	tickLabels.resize(0);
+	laneOffsets.resize(0);
 
 	if (analyzer->enableMigrations()) {
 		offset += migrateSectionOffset;
@@ -673,6 +765,7 @@ void MainWindow::computeLayout()
 		for (cpu = 0; cpu < nrCPUs; cpu++) {
 			analyzer->setSchedOffset(cpu, offset);
 			analyzer->setSchedScale(cpu, schedHeight);
+			laneOffsets.append(offset);
 			label = QString("cpu") + QString::number(cpu);
 			ticks.append(offset);
 			tickLabels.append(label);
@@ -713,6 +806,8 @@ void MainWindow::rescaleTrace()
 void MainWindow::computeStats()
 {
 	analyzer->doStats();
+	/* The latency widgets are set up when the sorting has completed */
+	jobRunner->submit(new LatencySortJob(analyzer));
 }
 
 void MainWindow::clearPlot()
@@ -720,7 +815,10 @@ void MainWindow::clearPlot()
 	cursors[TShark::RED_CURSOR] = nullptr;
 	cursors[TShark::BLUE_CURSOR] = nullptr;
 	tracePlot->clearItems();
+	/* The tiles may be rendered from the data of the plottables */
+	tileCache->clear();
 	tracePlot->clearPlottables();
+	cpuLanes.clear();
 	tracePlot->hide();
 	scrollBar->hide();
 	TaskGraph::clearMap();
@@ -748,6 +846,18 @@ void MainWindow::showTrace()
 	yaxisTicker->setTickVectorLabels(tickLabels);
 	tracePlot->yAxis->setTicks(true);
 
+	/* All migration, fork and exit arrows are drawn by a single graph */
+	if (analyzer->enableMigrations()) {
+		MigrationGraph *graph = new MigrationGraph(tracePlot->xAxis,
+							   tracePlot->yAxis);
+		graph->setPen(QPen(Qt::black, settingStore->getValue(
+					   Setting::MIGRATION_WIDTH).intv()));
+		graph->setName(QString(tr("migrations")));
+		graph->setData(&analyzer->migrationArrows);
+		graph->setScale(analyzer->getMigrationUnit(),
+				analyzer->getMigrationOffset());
+		tileCache->addSource(graph);
+	}
 
 	if (!settingStore->getValue(Setting::SHOW_CPUFREQ_GRAPHS).boolv() &&
 	    !settingStore->getValue(Setting::SHOW_CPUIDLE_GRAPHS).boolv())
@@ -758,7 +868,7 @@ void MainWindow::showTrace()
 		QPen pen = QPen();
 		QPen penF = QPen();
 
-		QCPGraph *graph;
+		StepGraph *graph;
 		QString name;
 		QCPScatterStyle style;
 
@@ -768,8 +878,8 @@ void MainWindow::showTrace()
 				Setting::IDLE_LINE_WIDTH).intv();
 			const double adjsize = adjustScatterSize(CPUIDLE_SIZE,
 								 lwidth);
-			graph = tracePlot->addGraph(tracePlot->xAxis,
-						    tracePlot->yAxis);
+			graph = new StepGraph(tracePlot->xAxis,
+					      tracePlot->yAxis);
 			graph->setSelectable(QCP::stNone);
 			name = QString(tr("cpuidle")) + QString::number(cpu);
 			style = QCPScatterStyle(CPUIDLE_SHAPE, adjsize);
@@ -780,16 +890,18 @@ void MainWindow::showTrace()
 			pen.setColor(Qt::green);
 			graph->setPen(pen);
 			graph->setName(name);
-			graph->setAdaptiveSampling(true);
-			graph->setLineStyle(QCPGraph::lsStepLeft);
-			graph->setData(analyzer->cpuIdle[cpu].timev,
-				       analyzer->cpuIdle[cpu].scaledData);
+			graph->setData(&analyzer->cpuIdle[cpu].timev,
+				       &analyzer->cpuIdle[cpu].data,
+				       &analyzer->cpuIdle[cpu].lod);
+			graph->setScale(analyzer->cpuIdle[cpu].scale,
+					analyzer->cpuIdle[cpu].offset);
+			tileCache->addSource(graph);
 		}
 
 		if (settingStore->getValue(Setting::SHOW_CPUFREQ_GRAPHS)
 		    .boolv()) {
-			graph = tracePlot->addGraph(tracePlot->xAxis,
-						    tracePlot->yAxis);
+			graph = new StepGraph(tracePlot->xAxis,
+					      tracePlot->yAxis);
 			graph->setSelectable(QCP::stNone);
 			name = QString(tr("cpufreq")) + QString::number(cpu);
 			penF.setColor(Qt::blue);
@@ -798,39 +910,81 @@ void MainWindow::showTrace()
 				      .intv());
 			graph->setPen(penF);
 			graph->setName(name);
-			graph->setAdaptiveSampling(true);
-			graph->setLineStyle(QCPGraph::lsStepLeft);
-			graph->setData(analyzer->cpuFreq[cpu].timev,
-				       analyzer->cpuFreq[cpu].scaledData);
+			graph->setData(&analyzer->cpuFreq[cpu].timev,
+				       &analyzer->cpuFreq[cpu].data,
+				       &analyzer->cpuFreq[cpu].lod);
+			graph->setScale(analyzer->cpuFreq[cpu].scale,
+					analyzer->cpuFreq[cpu].offset);
+			tileCache->addSource(graph);
 		}
 	}
 
 skipIdleFreqGraphs:
 
-	/* Show scheduling graphs */
-	for (cpu = 0; cpu <= analyzer->getMaxCPU(); cpu++) {
-		DEFINE_CPUTASKMAP_ITERATOR(iter) = analyzer->
-			cpuTaskMaps[cpu].begin();
-		while(iter != analyzer->cpuTaskMaps[cpu].end()) {
-			CPUTask &task = iter.value();
-			iter++;
-
-			addSchedGraph(task, cpu);
-			if (settingStore->getValue(Setting::SHOW_SCHED_GRAPHS)
-			    .boolv())
-			{
-				addHorizontalWakeupGraph(task);
-				addWakeupGraph(task);
-				addPreemptedGraph(task);
-				addStillRunningGraph(task);
-				addUninterruptibleGraph(task);
-			}
-		}
-	}
+	/*
+	 * Show scheduling graphs. All tasks of a CPU are drawn by a single
+	 * CpuLaneGraph, so that we don't end up with thousands of plottables.
+	 * Only the lanes that are near the visible range are created here, the
+	 * others are created by updateLanes() when they are scrolled into view.
+	 */
+	cpuLanes.fill(nullptr, analyzer->getMaxCPU() + 1);
+	updateLanes();
 
 	tracePlot->replot();
 }
 
+/*
+ * Creates the lane of a CPU, unless it already exists. This needs to be
+ * called before using the graph of a CPUTask, since it's nullptr until the
+ * lane has been created.
+ */
+void MainWindow::populateLane(unsigned int cpu)
+{
+	CpuLaneGraph *lane;
+
+	if (cpu >= (unsigned int) cpuLanes.size() || cpuLanes[cpu] != nullptr)
+		return;
+
+	lane = addCpuLane(cpu);
+	cpuLanes[cpu] = lane;
+	DEFINE_CPUTASKMAP_ITERATOR(iter) = analyzer->cpuTaskMaps[cpu].begin();
+	while(iter != analyzer->cpuTaskMaps[cpu].end()) {
+		CPUTask &task = iter.value();
+		iter++;
+
+		addSchedGraph(task, cpu, lane);
+	}
+	/*
+	 * The lane is given to the tile cache when it's complete, so that only
+	 * the tiles of its band are invalidated and only once.
+	 */
+	tileCache->addSource(lane);
+}
+
+/*
+ * Creates the lanes that are within the visible range, or within one screen
+ * height of it. Lanes are never removed before the plot is cleared, since
+ * their graphs may be selected or in the legend.
+ */
+void MainWindow::updateLanes()
+{
+	const QCPRange &range = tracePlot->yAxis->range();
+	const double margin = range.size() + schedSpacing;
+	unsigned int cpu;
+	double low;
+
+	for (cpu = 0; cpu < (unsigned int) cpuLanes.size() &&
+		     cpu < (unsigned int) laneOffsets.size(); cpu++) {
+		if (cpuLanes[cpu] != nullptr)
+			continue;
+		low = laneOffsets[cpu];
+		if (low + schedHeight < range.lower - margin ||
+		    low > range.upper + margin)
+			continue;
+		populateLane(cpu);
+	}
+}
+
 /*
  * The purpose of this function is to calculate how much the QCPScatterStyle
  * size should be increased, if we have a large line width.
@@ -945,138 +1099,62 @@ void MainWindow::setupCursors_(vtl::Time redtime, const double &red,
 	scrollTo(redtime);
 }
 
-void MainWindow::addSchedGraph(CPUTask &cpuTask, unsigned int cpu)
-{
-	/* Add scheduling graph */
-	TaskGraph *graph = new TaskGraph(tracePlot, cpu,
-					 TaskGraph::GRAPH_CPUGRAPH);
-	QColor color = analyzer->getTaskColor(cpuTask.pid);
-	Task *task = analyzer->findTask(cpuTask.pid);
-	QPen pen = QPen();
-
-	pen.setColor(color);
-	pen.setWidth(settingStore->getValue(Setting::LINE_WIDTH).intv());
-	graph->setPen(pen);
-	graph->setTask(task);
-	if (settingStore->getValue(Setting::SHOW_SCHED_GRAPHS).boolv())
-		graph->setData(cpuTask.schedTimev, cpuTask.scaledSchedData);
-	/*
-	 * Save a pointer to the graph object in the task. The destructor of
-	 * AbstractClass will delete this when it is destroyed.
-	 */
-	cpuTask.graph = graph;
-}
-
-void MainWindow::addHorizontalWakeupGraph(CPUTask &task)
-{
-	if (!settingStore->getValue(Setting::HORIZONTAL_LATENCY).boolv())
-		return;
-
-	/* Add wakeup graph on top of scheduling */
-	QCPGraph *graph = tracePlot->addGraph(tracePlot->xAxis,
-					      tracePlot->yAxis);
-	QCPScatterStyle style = QCPScatterStyle(QCPScatterStyle::ssDot);
-	QColor color = analyzer->getTaskColor(task.pid);
-	QPen pen = QPen();
-	QCPErrorBars *errorBars = new QCPErrorBars(tracePlot->xAxis,
-						   tracePlot->yAxis);
-	errorBars->setAntialiased(false);
-	pen.setColor(color);
-	pen.setWidth(settingStore->getValue(Setting::LINE_WIDTH).intv());
-	style.setPen(pen);
-	graph->setScatterStyle(style);
-	graph->setLineStyle(QCPGraph::lsNone);
-	graph->setAdaptiveSampling(true);
-	graph->setData(task.delayTimev, task.delayHeight);
-	errorBars->setData(task.delay, task.delayZero);
-	errorBars->setErrorType(QCPErrorBars::etKeyError);
-	errorBars->setPen(pen);
-	errorBars->setWhiskerWidth(4);
-	errorBars->setDataPlottable(graph);
-	task.horizontalDelayBars = errorBars;
-	/* errorBars->setSymbolGap(0); */
-}
-
-void MainWindow::addWakeupGraph(CPUTask &task)
+QCPScatterStyle MainWindow::accessoryStyle(
+	QCPScatterStyle::ScatterShape sshape, double size, const QColor &color)
 {
-	if (!settingStore->getValue(Setting::VERTICAL_LATENCY).boolv())
-		return;
-
-	/* Add wakeup graph on top of scheduling */
-	QCPGraph *graph = tracePlot->addGraph(tracePlot->xAxis,
-					      tracePlot->yAxis);
-	QCPScatterStyle style = QCPScatterStyle(QCPScatterStyle::ssDot);
-	QColor color = analyzer->getTaskColor(task.pid);
-	QPen pen = QPen();
-	QCPErrorBars *errorBars = new QCPErrorBars(tracePlot->xAxis,
-						   tracePlot->yAxis);
-	errorBars->setAntialiased(false);
-
-	pen.setColor(color);
-	pen.setWidth(settingStore->getValue(Setting::LINE_WIDTH).intv());
-	style.setPen(pen);
-	graph->setScatterStyle(style);
-	graph->setLineStyle(QCPGraph::lsNone);
-	graph->setAdaptiveSampling(true);
-	graph->setData(task.delayTimev, task.delayHeight);
-	errorBars->setData(task.delayZero, task.verticalDelay);
-	errorBars->setErrorType(QCPErrorBars::etValueError);
-	errorBars->setPen(pen);
-	errorBars->setWhiskerWidth(4);
-	errorBars->setDataPlottable(graph);
-	task.verticalDelayBars = errorBars;
-}
-
-void MainWindow::addGenericAccessoryGraph(const QString &name,
-					  const QVector<double> &timev,
-					  const QVector<double> &scaledData,
-					  QCPScatterStyle::ScatterShape sshape,
-					  double size,
-					  const QColor &color)
-{
-	if (timev.size() == 0)
-		return;
 	const int lwidth = settingStore->getValue(Setting::LINE_WIDTH).intv();
 	const double adjsize = adjustScatterSize(size, lwidth);
-	/* Add still running graph on top of the other two...*/
-	QCPGraph *graph = tracePlot->addGraph(tracePlot->xAxis,
-					      tracePlot->yAxis);
-	graph->setName(name);
 	QCPScatterStyle style = QCPScatterStyle(sshape, adjsize);
 	QPen pen = QPen();
 
 	pen.setColor(color);
 	pen.setWidth(lwidth);
 	style.setPen(pen);
-	graph->setScatterStyle(style);
-	graph->setLineStyle(QCPGraph::lsNone);
-	graph->setAdaptiveSampling(true);
-	graph->setData(timev, scaledData);
+	return style;
 }
 
-void MainWindow::addPreemptedGraph(CPUTask &task)
+CpuLaneGraph *MainWindow::addCpuLane(unsigned int cpu)
 {
-	addGenericAccessoryGraph(PREEMPTED_NAME, task.preemptedTimev,
-				 task.scaledPreemptedData,
-				 PREEMPTED_SHAPE, PREEMPTED_SIZE,
-				 PREEMPTED_COLOR);
-}
+	CpuLaneGraph *lane = new CpuLaneGraph(tracePlot->xAxis,
+					      tracePlot->yAxis);
 
-void MainWindow::addStillRunningGraph(CPUTask &task)
-{
-	addGenericAccessoryGraph(RUNNING_NAME, task.runningTimev,
-				 task.scaledRunningData,
-				 RUNNING_SHAPE, RUNNING_SIZE,
-				 RUNNING_COLOR);
-}
+	lane->setName(QString(tr("cpu")) + QString::number(cpu));
+	lane->setShowSched(settingStore->getValue(Setting::SHOW_SCHED_GRAPHS)
+			   .boolv());
+	lane->setShowHorizontalDelay(
+		settingStore->getValue(Setting::HORIZONTAL_LATENCY).boolv());
+	lane->setShowVerticalDelay(
+		settingStore->getValue(Setting::VERTICAL_LATENCY).boolv());
+	lane->setMarkerStyle(CpuLaneGraph::MARKER_PREEMPTED,
+			     accessoryStyle(PREEMPTED_SHAPE, PREEMPTED_SIZE,
+					    PREEMPTED_COLOR));
+	lane->setMarkerStyle(CpuLaneGraph::MARKER_RUNNING,
+			     accessoryStyle(RUNNING_SHAPE, RUNNING_SIZE,
+					    RUNNING_COLOR));
+	lane->setMarkerStyle(CpuLaneGraph::MARKER_UNINT,
+			     accessoryStyle(UNINT_SHAPE, UNINT_SIZE,
+					    UNINT_COLOR));
+	return lane;
+}
+
+void MainWindow::addSchedGraph(CPUTask &cpuTask, unsigned int cpu,
+			       CpuLaneGraph *lane)
+{
+	/* Add the task to the scheduling lane of the CPU */
+	TaskGraph *graph = new TaskGraph(lane, &cpuTask, cpu);
+	QColor color = analyzer->getTaskColor(cpuTask.pid);
+	Task *task = analyzer->findTask(cpuTask.pid);
+	QPen pen = QPen();
 
-void MainWindow::addUninterruptibleGraph(CPUTask &task)
-{
-	addGenericAccessoryGraph(UNINT_NAME,
-				 task.uninterruptibleTimev,
-				 task.scaledUninterruptibleData,
-				 UNINT_SHAPE, UNINT_SIZE,
-				 UNINT_COLOR);
+	pen.setColor(color);
+	pen.setWidth(settingStore->getValue(Setting::LINE_WIDTH).intv());
+	graph->setPen(pen);
+	graph->setTask(task);
+	/*
+	 * Save a pointer to the graph object in the task. The destructor of
+	 * AbstractClass will delete this when it is destroyed.
+	 */
+	cpuTask.graph = graph;
 }
 
 /*
@@ -1183,6 +1261,8 @@ void MainWindow::closeTrace()
 	stateFile->clear();
 
 	startt = QDateTime::currentDateTimeUtc().toMSecsSinceEpoch();
+	jobRunner->cancelAll();
+	jobRunner->waitIdle();
 	resetFilters();
 
 	eventsWidget->beginResetModel();
@@ -1561,11 +1641,12 @@ void MainWindow::scrollBarChanged(int value)
 	newrange.upper = value * quantum + low;
 	newrange.lower = newrange.upper - zrange.size();
 	tracePlot->yAxis->setRange(newrange);
-	tracePlot->replot();
+	tracePlot->queueReplot();
 }
 
 void MainWindow::yAxisChanged(QCPRange /*range*/)
 {
+	updateLanes();
 	if (!scrollBarUpdate)
 		configureScrollBar();
 }
@@ -1722,7 +1803,7 @@ void MainWindow::showLatency(const Latency *latency)
 		 * If a filter is enabled we need to try to find the index in
 		 * analyzer->filteredEvents
 		 */
-		int filterIndex;
+		eventidx_t filterIndex;
 		if (analyzer->findFilteredEvent(latency->runnable_idx,
 						&filterIndex)
 		    != nullptr)
@@ -2150,6 +2231,18 @@ void MainWindow::createStatusBar()
 	statusStrings[STATUS_ERROR] = new QString(tr("An error has occurred"));
 
 	setStatus(STATUS_NOFILE);
+
+	jobProgressBar = new QProgressBar();
+	jobProgressBar->setRange(0, 1000);
+	jobProgressBar->setMaximumWidth(200);
+	jobProgressBar->hide();
+	statusBar()->addPermanentWidget(jobProgressBar);
+
+	jobCancelButton = new QToolButton();
+	jobCancelButton->setText(tr("Cancel"));
+	jobCancelButton->setToolTip(tr("Cancel the ongoing operation"));
+	jobCancelButton->hide();
+	statusBar()->addPermanentWidget(jobCancelButton);
 }
 
 void MainWindow::createDialogs()
@@ -2448,17 +2541,64 @@ void MainWindow::addTaskToLegend(int pid)
 	if (cpuTask == nullptr)
 		return;
 
+	populateLane(cpu);
+	if (cpuTask->graph == nullptr)
+		return;
 	taskToolBar->addTaskGraphToLegend(cpuTask->graph);
 }
 
 void MainWindow::setEventsWidgetEvents()
 {
 	if (analyzer->isFiltered())
-		eventsWidget->setEvents(&analyzer->filteredEvents);
+		eventsWidget->setEvents(analyzer->events,
+					&analyzer->filteredEvents);
 	else
 		eventsWidget->setEvents(analyzer->events);
 }
 
+/*
+ * Cancels the filtering that may be in progress and waits for it to stop, so
+ * that the filters of the analyzer can be changed. The other jobs don't read
+ * the filters, an export of events uses a copy of the filteredEvents, so they
+ * are left to run.
+ */
+void MainWindow::stopFilterJob()
+{
+	jobRunner->cancel(BackgroundJob::JOB_FILTER);
+	jobRunner->waitIdle(BackgroundJob::JOB_FILTER);
+}
+
+/*
+ * Must be called before the filters of the analyzer are changed, and be
+ * followed by a call to filtersChanged(). It waits for the filter job and
+ * tells the eventsWidget that the filtered events are about to change.
+ */
+void MainWindow::beginFilterChange()
+{
+	stopFilterJob();
+	eventsWidget->beginFilterUpdate();
+}
+
+/*
+ * Must be called after the filters of the analyzer have been changed. If the
+ * analyzer has deferred the filtering, then a job is started and the
+ * eventsWidget is updated when it has completed, otherwise it's done here.
+ */
+void MainWindow::filtersChanged(const vtl::Time &saved)
+{
+	if (analyzer->isFilterPending()) {
+		/* The events of the eventsWidget have not changed yet */
+		eventsWidget->endFilterUpdate();
+		filterJobScroll = saved;
+		jobRunner->submit(new FilterEventsJob(analyzer));
+	} else {
+		setEventsWidgetEvents();
+		eventsWidget->endFilterUpdate();
+		scrollTo(saved);
+	}
+	updateResetFiltersEnabled();
+}
+
 void MainWindow::scrollTo(const vtl::Time &time)
 {
 	vtl::Time start, end;
@@ -2499,12 +2639,9 @@ void MainWindow::timeFilter(void)
 	vtl::Time tmin = vtl::Time::fromDouble(min);
 	vtl::Time tmax = vtl::Time::fromDouble(max);
 
-	eventsWidget->beginResetModel();
+	beginFilterChange();
 	analyzer->createTimeFilter(tmin, tmax, false);
-	setEventsWidgetEvents();
-	eventsWidget->endResetModel();
-	scrollTo(saved);
-	updateResetFiltersEnabled();
+	filtersChanged(saved);
 }
 
 void MainWindow::createEventCPUFilter(const TraceEvent &event)
@@ -2536,36 +2673,27 @@ void MainWindow::createPidFilter(QMap<int, int> &map,
 {
 	vtl::Time saved = eventsWidget->getSavedScroll();
 
-	eventsWidget->beginResetModel();
+	beginFilterChange();
 	analyzer->createPidFilter(map, orlogic, inclusive);
-	setEventsWidgetEvents();
-	eventsWidget->endResetModel();
-	scrollTo(saved);
-	updateResetFiltersEnabled();
+	filtersChanged(saved);
 }
 
 void MainWindow::createCPUFilter(QMap<unsigned, unsigned> &map, bool orlogic)
 {
 	vtl::Time saved = eventsWidget->getSavedScroll();
 
-	eventsWidget->beginResetModel();
+	beginFilterChange();
 	analyzer->createCPUFilter(map, orlogic);
-	setEventsWidgetEvents();
-	eventsWidget->endResetModel();
-	scrollTo(saved);
-	updateResetFiltersEnabled();
+	filtersChanged(saved);
 }
 
 void MainWindow::createEventFilter(QMap<event_t, event_t> &map, bool orlogic)
 {
 	vtl::Time saved = eventsWidget->getSavedScroll();
 
-	eventsWidget->beginResetModel();
+	beginFilterChange();
 	analyzer->createEventFilter(map, orlogic);
-	setEventsWidgetEvents();
-	eventsWidget->endResetModel();
-	scrollTo(saved);
-	updateResetFiltersEnabled();
+	filtersChanged(saved);
 }
 
 void MainWindow::createRegexFilter(RegexFilter &regexFilter, bool orlogic)
@@ -2573,12 +2701,14 @@ void MainWindow::createRegexFilter(RegexFilter &regexFilter, bool orlogic)
 	vtl::Time saved = eventsWidget->getSavedScroll();
 	int ts_errno;
 
-	eventsWidget->beginResetModel();
+	/*
+	 * A new regex supersedes the one that is being processed, if any, so
+	 * that the user doesn't need to wait for the regexes that were
+	 * replaced while they were edited.
+	 */
+	beginFilterChange();
 	ts_errno = analyzer->createRegexFilter(regexFilter, orlogic);
-	setEventsWidgetEvents();
-	eventsWidget->endResetModel();
-	scrollTo(saved);
-	updateResetFiltersEnabled();
+	filtersChanged(saved);
 	if (ts_errno != 0)
 		vtl::warn(ts_errno, "Failed to compile regex");
 }
@@ -2611,12 +2741,9 @@ void MainWindow::resetFilter(FilterState::filter_t filter)
 		return;
 
 	saved = eventsWidget->getSavedScroll();
-	eventsWidget->beginResetModel();
+	beginFilterChange();
 	analyzer->disableFilter(filter);
-	setEventsWidgetEvents();
-	eventsWidget->endResetModel();
-	scrollTo(saved);
-	updateResetFiltersEnabled();
+	filtersChanged(saved);
 }
 
 void MainWindow::resetFilters()
@@ -2634,19 +2761,15 @@ void MainWindow::resetFilters()
 		saved = eventsWidget->getSavedScroll();
 	}
 
-	eventsWidget->beginResetModel();
+	beginFilterChange();
 	analyzer->disableAllFilters();
-	setEventsWidgetEvents();
-	eventsWidget->endResetModel();
-	scrollTo(saved);
-	updateResetFiltersEnabled();
+	filtersChanged(saved);
 }
 
 void MainWindow::exportEvents(TraceAnalyzer::exporttype_t export_type)
 {
 	QStringList fileNameList;
 	QString fileName;
-	int ts_errno;
 	QString caption;
 
 	if (analyzer->events->size() <= 0) {
@@ -2679,11 +2802,11 @@ void MainWindow::exportEvents(TraceAnalyzer::exporttype_t export_type)
 
 	TShark::checkSuffix(&fileName, ASC_SUFFIX, TXT_SUFFIX);
 
-	if (!analyzer->exportTraceFile(fileName.toLocal8Bit().data(),
-				       &ts_errno, export_type)) {
-		vtl::warn(ts_errno, "Failed to export trace to %s",
-			  fileName.toLocal8Bit().data());
-	}
+	/* The export needs the filtered events to be up to date */
+	if (analyzer->isFilterPending())
+		jobRunner->waitIdle();
+	jobRunner->submit(new ExportEventsJob(analyzer, fileName.toLocal8Bit(),
+					      export_type));
 }
 
 void MainWindow::exportCPUTriggered()
@@ -2713,7 +2836,6 @@ void MainWindow::exportLatencies(TraceAnalyzer::exportformat_t format,
 {
 	QString caption;
 	QString fileName;
-	int ts_errno;
 	QString selected;
 	QString filter;
 	TraceAnalyzer::exportformat_t override_fmt = format;
@@ -2793,12 +2915,9 @@ void MainWindow::exportLatencies(TraceAnalyzer::exportformat_t format,
 		}
 	}
 
-	if (!analyzer->exportLatencies(override_fmt, type,
-				       fileName.toLocal8Bit().data(),
-				       &ts_errno))
-		vtl::warn(ts_errno, "Failed to export latencies to %s",
-			  fileName.toLocal8Bit().data());
-
+	jobRunner->submit(new ExportLatenciesJob(analyzer,
+						 fileName.toLocal8Bit(),
+						 override_fmt, type));
 }
 
 void MainWindow::consumeSettings()
@@ -2925,15 +3044,25 @@ void MainWindow::consumeFilterSettings()
 {
 	bool inclusive =
 		settingStore->getValue(Setting::EVENT_PID_FLT_INCL_ON).boolv();
-	if (analyzer->updatePidFilter(inclusive))
-		/*
-		 * When this function is called, the focus is often on the
-		 * graphEnableDialog widget but the user still might be
-		 * expecting to see an immediate update of the eventsWidget,
-		 * therefore we call repaint() here. Unfortunately, it doesn't
-		 * help to call update().
-		 */
-		eventsWidget->repaint();
+
+	beginFilterChange();
+	if (!analyzer->updatePidFilter(inclusive)) {
+		eventsWidget->endFilterUpdate();
+		return;
+	}
+	if (analyzer->isFilterPending()) {
+		filtersChanged(eventsWidget->getSavedScroll());
+		return;
+	}
+	setEventsWidgetEvents();
+	eventsWidget->endFilterUpdate();
+	/*
+	 * When this function is called, the focus is often on the
+	 * graphEnableDialog widget but the user still might be expecting to
+	 * see an immediate update of the eventsWidget, therefore we call
+	 * repaint() here. Unfortunately, it doesn't help to call update().
+	 */
+	eventsWidget->repaint();
 }
 
 void MainWindow::consumeSizeChange()
@@ -2982,6 +3111,8 @@ void MainWindow::addTaskGraph(int pid)
 		if (cpuTask != nullptr)
 			break;
 	}
+	if (cpuTask != nullptr)
+		populateLane(cpu);
 	if (cpuTask == nullptr || cpuTask->graph == nullptr) {
 		taskRangeAllocator->putTaskRange(taskRange);
 		return;
@@ -3006,7 +3137,8 @@ void MainWindow::addTaskGraph(int pid)
 	task->doScalePreempted();
 	task->doScaleUnint();
 
-	taskGraph->setData(task->schedTimev, task->scaledSchedData);
+	taskGraph->setData(task->schedTimev, task->scaledSchedData,
+			   &task->schedLod, task->schedScale(), task->offset);
 	task->graph = taskGraph;
 
 	/* Add the horizontal wakeup graph as well */
@@ -3063,20 +3195,13 @@ void MainWindow::addAccessoryTaskGraph(QCPGraph **graphPtr,
 {
 	/* Add the still running graph on top of the other two... */
 	QCPGraph *graph;
-	QPen pen;
-	const int lwidth = settingStore->getValue(Setting::LINE_WIDTH).intv();
-	const double adjsize = adjustScatterSize(size, lwidth);
-	QCPScatterStyle style = QCPScatterStyle(sshape, adjsize);
 	if (timev.size() <= 0) {
 		*graphPtr = nullptr;
 		return;
 	}
 	graph = tracePlot->addGraph(tracePlot->xAxis, tracePlot->yAxis);
 	graph->setName(name);
-	pen.setColor(color);
-	pen.setWidth(settingStore->getValue(Setting::LINE_WIDTH).intv());
-	style.setPen(pen);
-	graph->setScatterStyle(style);
+	graph->setScatterStyle(accessoryStyle(sshape, size, color));
 	graph->setLineStyle(QCPGraph::lsNone);
 	graph->setAdaptiveSampling(true);
 	graph->setData(timev, scaledData);
@@ -3108,7 +3233,6 @@ void MainWindow::addUninterruptibleTaskGraph(Task *task)
 void MainWindow::removeTaskGraph(int pid)
 {
 	Task *task = analyzer->findRealTask(pid);
-	QCPGraph *qcpGraph;
 
 	if (task == nullptr) {
 		setTaskGraphClearActionEnabled(
@@ -3117,8 +3241,7 @@ void MainWindow::removeTaskGraph(int pid)
 	}
 
 	if (task->graph != nullptr) {
-		qcpGraph = task->graph->getQCPGraph();
-		if (qcpGraph != nullptr && qcpGraph->selected() &&
+		if (task->graph->isSelected() &&
 		    taskToolBar->getPid() == task->pid)
 			taskToolBar->removeTaskGraph();
 		task->graph->destroy();
@@ -3162,7 +3285,6 @@ void MainWindow::clearTaskGraphsTriggered()
 	TaskRange r;
 	int pid;
 	Task *task;
-	QCPGraph *qcpGraph;
 	TaskRangeAllocator::iterator iter;
 
 	for (iter = taskRangeAllocator->begin();
@@ -3177,8 +3299,7 @@ void MainWindow::clearTaskGraphsTriggered()
 		if (task->graph == nullptr)
 			continue;
 
-		qcpGraph = task->graph->getQCPGraph();
-		if (qcpGraph != nullptr && qcpGraph->selected() &&
+		if (task->graph->isSelected() &&
 		    taskToolBar->getPid() == task->pid)
 			taskToolBar->removeTaskGraph();
 		task->graph->destroy();
@@ -3243,22 +3364,26 @@ void MainWindow::updateAddToLegendAction()
 TaskGraph *MainWindow::selectedGraph()
 {
 	TaskGraph *graph = nullptr;
-	QCPGraph *qcpGraph = nullptr;
+	QCPGraph *qcpGraph;
+	CpuLaneGraph *lane;
 	QCPAbstractPlottable *plottable;
 	QList<QCPAbstractPlottable*> plist = tracePlot->selectedPlottables();
 	QList<QCPAbstractPlottable*>::const_iterator iter;
 
 	for (iter = plist.begin(); iter != plist.end(); iter++) {
 		plottable = *iter;
+		lane = qobject_cast<CpuLaneGraph *>(plottable);
+		if (lane != nullptr) {
+			graph = lane->selectedTaskGraph();
+			continue;
+		}
 		qcpGraph = qobject_cast<QCPGraph *>(plottable);
 		if (qcpGraph == nullptr)
 			continue;
 		graph = TaskGraph::fromQCPGraph(qcpGraph);
-		if (graph == nullptr)
-			continue;
 	}
 
-	if (qcpGraph == nullptr || !qcpGraph->selected())
+	if (graph == nullptr || !graph->isSelected())
 		return nullptr;
 	return graph;
 }
@@ -3368,11 +3493,8 @@ void MainWindow::showStatsTimeLimited()
 		statsLimitedDialog->hide();
 		return;
 	}
-	statsLimitedDialog->beginResetModel();
-	analyzer->doLimitedStats();
-	statsLimitedDialog->setTaskMap(&analyzer->taskMap,
-				       analyzer->getNrCPUs());
-	statsLimitedDialog->endResetModel();
+	/* The dialog is updated when the job has completed */
+	jobRunner->submit(new LimitedStatsJob(analyzer));
 	statsLimitedDialog->show();
 	if (dockWidgetArea(statsLimitedDialog) == Qt::NoDockWidgetArea)
 		addDockWidget(Qt::RightDockWidgetArea, statsLimitedDialog);
@@ -3468,8 +3590,8 @@ void MainWindow::showWakeupOrWaking(int pid, event_t wakevent)
 {
 	int activeIdx = infoWidget->getCursorIdx();
 	int inactiveIdx;
-	int wakeUpIndex;
-	int schedIndex;
+	eventidx_t wakeUpIndex;
+	eventidx_t schedIndex;
 
 	if (activeIdx != TShark::RED_CURSOR &&
 	    activeIdx != TShark::BLUE_CURSOR) {
@@ -3527,7 +3649,7 @@ void MainWindow::showWakeupOrWaking(int pid, event_t wakevent)
 		 * If a filter is enabled we need to try to find the index in
 		 * analyzer->filteredEvents
 		 */
-		int filterIndex;
+		eventidx_t filterIndex;
 		if (analyzer->findFilteredEvent(wakeUpIndex, &filterIndex)
 		    != nullptr)
 			eventsWidget->scrollTo(filterIndex);
@@ -3542,7 +3664,7 @@ void MainWindow::showWakeupOrWaking(int pid, event_t wakevent)
 void MainWindow::showWaking(const TraceEvent *wakeupevent)
 {
 	int activeIdx = infoWidget->getCursorIdx();
-	int wakingIndex;
+	eventidx_t wakingIndex;
 
 	if (activeIdx != TShark::RED_CURSOR &&
 	    activeIdx != TShark::BLUE_CURSOR) {
@@ -3571,7 +3693,7 @@ void MainWindow::showWaking(const TraceEvent *wakeupevent)
 		 * If a filter is enabled we need to try to find the index in
 		 * analyzer->filteredEvents
 		 */
-		int filterIndex;
+		eventidx_t filterIndex;
 		if (analyzer->findFilteredEvent(wakingIndex, &filterIndex)
 		    != nullptr)
 			eventsWidget->scrollTo(filterIndex);
@@ -3585,24 +3707,95 @@ void MainWindow::showWaking(const TraceEvent *wakeupevent)
 
 void MainWindow::checkStatsTimeLimited()
 {
-	if (statsLimitedDialog->isVisible()) {
+	/*
+	 * If the cursors move while the stats are being computed, then the
+	 * new job supersedes the old one.
+	 */
+	if (statsLimitedDialog->isVisible())
+		jobRunner->submit(new LimitedStatsJob(analyzer));
+}
+
+void MainWindow::jobFinished(BackgroundJob *job)
+{
+	FilterEventsJob *filterJob;
+	LimitedStatsJob *statsJob;
+	ExportEventsJob *eventsJob;
+	ExportLatenciesJob *latenciesJob;
+
+	switch (job->kind) {
+	case BackgroundJob::JOB_FILTER:
+		filterJob = static_cast<FilterEventsJob*>(job);
+		eventsWidget->beginResetModel();
+		analyzer->commitFilteredEvents(filterJob->filteredEvents);
+		setEventsWidgetEvents();
+		eventsWidget->endResetModel();
+		scrollTo(filterJobScroll);
+		updateResetFiltersEnabled();
+		break;
+	case BackgroundJob::JOB_STATS_LIMITED:
+		statsJob = static_cast<LimitedStatsJob*>(job);
 		statsLimitedDialog->beginResetModel();
-		analyzer->doLimitedStats();
+		analyzer->commitLimitedStats(statsJob->stats);
 		statsLimitedDialog->setTaskMap(&analyzer->taskMap,
 					       analyzer->getNrCPUs());
 		statsLimitedDialog->endResetModel();
+		break;
+	case BackgroundJob::JOB_LATENCY_SORT:
+		schedLatencyWidget->setAnalyzer(analyzer);
+		wakeupLatencyWidget->setAnalyzer(analyzer);
+		break;
+	case BackgroundJob::JOB_EXPORT_EVENTS:
+		eventsJob = static_cast<ExportEventsJob*>(job);
+		if (!eventsJob->ok)
+			vtl::warn(eventsJob->ts_errno,
+				  "Failed to export trace to %s",
+				  eventsJob->fileName.constData());
+		break;
+	case BackgroundJob::JOB_EXPORT_LATENCIES:
+		latenciesJob = static_cast<ExportLatenciesJob*>(job);
+		if (!latenciesJob->ok)
+			vtl::warn(latenciesJob->ts_errno,
+				  "Failed to export latencies to %s",
+				  latenciesJob->fileName.constData());
+		break;
+	default:
+		break;
 	}
 }
 
-bool MainWindow::selectQCPGraph(QCPGraph *graph)
+void MainWindow::jobProgress(int permille)
 {
-	int end = graph->dataCount() - 1;
-	if (end < 0)
-		return false;
-	QCPDataRange wholeRange(0,  end);
-	QCPDataSelection wholeSelection(wholeRange);
-	graph->setSelection(std::move(wholeSelection));
-	return true;
+	/* An empty range makes the progress bar show that we are busy */
+	if (permille < 0) {
+		jobProgressBar->setRange(0, 0);
+	} else {
+		jobProgressBar->setRange(0, 1000);
+		jobProgressBar->setValue(permille);
+	}
+}
+
+void MainWindow::jobBusyChanged(bool busy)
+{
+	jobProgressBar->setRange(0, 0);
+	jobProgressBar->setVisible(busy);
+	jobCancelButton->setVisible(busy);
+}
+
+/*
+ * Cancels the jobs that the user has asked for. The sorting of the latencies
+ * is needed by the latency widgets, so it's left to complete.
+ */
+void MainWindow::cancelJobs()
+{
+	jobRunner->cancel(BackgroundJob::JOB_FILTER);
+	jobRunner->cancel(BackgroundJob::JOB_STATS_LIMITED);
+	jobRunner->cancel(BackgroundJob::JOB_EXPORT_EVENTS);
+	jobRunner->cancel(BackgroundJob::JOB_EXPORT_LATENCIES);
+	jobRunner->waitIdle();
+
+	/* If the filtering was canceled, go back to the unfiltered events */
+	if (analyzer->isFilterPending())
+		resetFilters();
 }
 
 /* Add a unified task graph for the currently selected task */
@@ -3617,12 +3810,12 @@ void MainWindow::selectTaskByPid(int pid, const unsigned int *preferred_cpu,
 {
 	Task *task;
 	int realpid;
-	QCPGraph *qcpGraph;
 	CPUTask *cpuTask;
 	TaskGraph *graph = nullptr;
 	unsigned int cpu;
 	int maxSize;
 	CPUTask *maxTask;
+	unsigned int maxCpu;
 
 	/* Deselect the selected task */
 	tracePlot->deselectAll();
@@ -3655,10 +3848,7 @@ void MainWindow::selectTaskByPid(int pid, const unsigned int *preferred_cpu,
 
 	if (task->graph == nullptr)
 		goto do_cpugraph;
-	qcpGraph = task->graph->getQCPGraph();
-	if (qcpGraph == nullptr)
-		goto do_cpugraph;
-	selectQCPGraph(qcpGraph);
+	task->graph->select();
 	graph = task->graph;
 	goto out;
 
@@ -3671,19 +3861,25 @@ do_cpugraph:
 	if (preferred_cpu == nullptr) {
 		maxTask = nullptr;
 		maxSize = -1;
+		maxCpu = 0;
 		for (cpu = 0; cpu < analyzer->getNrCPUs(); cpu++) {
 			cpuTask = analyzer->findCPUTask(realpid, cpu);
 			if (cpuTask != nullptr) {
 				if (cpuTask->schedTimev.size() > maxSize) {
 					maxSize = cpuTask->schedTimev.size();
 					maxTask = cpuTask;
+					maxCpu = cpu;
 				}
 			}
 		}
 		cpuTask = maxTask;
+		cpu = maxCpu;
 	} else {
-		cpuTask = analyzer->findCPUTask(realpid, *preferred_cpu);
+		cpu = *preferred_cpu;
+		cpuTask = analyzer->findCPUTask(realpid, cpu);
 	}
+	if (cpuTask != nullptr)
+		populateLane(cpu);
 	/*
 	 * If we can't find what we expected we give up but don't warn the
 	 * user. There is probably yet another case of tasks that has a global
@@ -3691,22 +3887,11 @@ do_cpugraph:
 	 */
 	if (cpuTask == nullptr || cpuTask->graph == nullptr)
 		goto out;
-	qcpGraph = cpuTask->graph->getQCPGraph();
-	/*
-	 * I would still expect all per CPU tasks that exists to have a QCP
-	 * graph, so in this case we warn the user
-	 */
-	if (qcpGraph == nullptr) {
-		oops_warnx();
-		goto out;
-	}
 
-	selectQCPGraph(qcpGraph);
+	cpuTask->graph->select();
 
 	/* Finally update the TaskToolBar to reflect the change in selection */
-	graph = TaskGraph::fromQCPGraph(qcpGraph);
-	if (graph == nullptr)
-		oops_warnx();
+	graph = cpuTask->graph;
 
 out:
 	if (graph != nullptr) {
@@ -3908,7 +4093,7 @@ void MainWindow::findSleepTriggered()
 {
 	int activeIdx = infoWidget->getCursorIdx();
 	int pid = taskToolBar->getPid();
-	int schedIndex;
+	eventidx_t schedIndex;
 
 	if (pid == 0)
 		return;
@@ -3946,7 +4131,7 @@ void MainWindow::findSleepTriggered()
 		 * If a filter is enabled we need to try to find the index in
 		 * analyzer->filteredEvents
 		 */
-		int filterIndex;
+		eventidx_t filterIndex;
 		if (analyzer->findFilteredEvent(schedIndex, &filterIndex)
 		    != nullptr)
 			eventsWidget->scrollTo(filterIndex);
@@ -3971,12 +4156,10 @@ void MainWindow::taskFilter()
 	QMap<int, int> map;
 	map[pid] = pid;
 
-	eventsWidget->beginResetModel();
+
+	beginFilterChange();
 	analyzer->createPidFilter(map, false, true);
-	setEventsWidgetEvents();
-	eventsWidget->endResetModel();
-	scrollTo(saved);
-	updateResetFiltersEnabled();
+	filtersChanged(saved);
 }
 
 /* Filter on the currently selected task */
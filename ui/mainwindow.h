@@ -93,16 +93,21 @@ class QMenu;
 class QPlainTextEdit;
 class QMessageBox;
 class QMouseEvent;
+class QProgressBar;
 class QScrollBar;
 class QToolBar;
+class QToolButton;
 class QVBoxLayhout;
 QT_END_NAMESPACE
 
 class TraceAnalyzer;
+class BackgroundJob;
 class EventsWidget;
 class InfoWidget;
+class JobRunner;
 class Cursor;
 class CPUTask;
+class CpuLaneGraph;
 class ErrorDialog;
 class GraphEnableDialog;
 class LatencyWidget;
@@ -119,6 +124,7 @@ class RegexFilter;
 class SettingStore;
 class StateFile;
 class TaskToolBar;
+class TileCache;
 class TracePlot;
 class TraceEvent;
 class TaskRangeAllocator;
@@ -237,6 +243,10 @@ private slots:
 	void eventPIDTriggered();
 	void eventMoveBlueTriggered();
 	void eventMoveRedTriggered();
+	void jobFinished(BackgroundJob *job);
+	void jobProgress(int permille);
+	void jobBusyChanged(bool busy);
+	void cancelJobs();
 
 private:
 	typedef enum : int {
@@ -277,6 +287,7 @@ private:
 
 	/* Functions for opening and processing a trace*/
 	void processTrace();
+	void showPreview();
 	void computeLayout();
 	void computeStats();
 	void rescaleTrace();
@@ -295,18 +306,13 @@ private:
 	void setupCursors_(vtl::Time redtime, const double &red,
 			   vtl::Time bluetime, const double &blue);
 	void updateResetFiltersEnabled();
-	void addSchedGraph(CPUTask &task, unsigned int cpu);
-	void addHorizontalWakeupGraph(CPUTask &task);
-	void addWakeupGraph(CPUTask &task);
-	void addPreemptedGraph(CPUTask &task);
-	void addStillRunningGraph(CPUTask &task);
-	void addUninterruptibleGraph(CPUTask &task);
-	void addGenericAccessoryGraph(const QString &name,
-				      const QVector<double> &timev,
-				      const QVector<double> &scaledData,
-				      QCPScatterStyle::ScatterShape sshape,
-				      double size,
-				      const QColor &color);
+	QCPScatterStyle accessoryStyle(QCPScatterStyle::ScatterShape sshape,
+				       double size, const QColor &color);
+	CpuLaneGraph *addCpuLane(unsigned int cpu);
+	void populateLane(unsigned int cpu);
+	void updateLanes();
+	void addSchedGraph(CPUTask &task, unsigned int cpu,
+			   CpuLaneGraph *lane);
 	void addAccessoryTaskGraph(QCPGraph **graphPtr, const QString &name,
 				   const QVector<double> &timev,
 				   const QVector<double> &scaledData,
@@ -328,13 +334,15 @@ private:
 	void setEventActionsEnabled(bool e);
 	void setResetTaskColorEnabled(bool e);
 	void setEventsWidgetEvents();
+	void stopFilterJob();
+	void beginFilterChange();
+	void filtersChanged(const vtl::Time &saved);
 	void scrollTo(const vtl::Time &time);
 	void exportLatencies(TraceAnalyzer::exportformat_t format,
 			     TraceAnalyzer::latencytype_t type);
 	void handleLegendGraphDoubleClick(QCPGraph *legendGraph);
 	void handleWakeUpChanged(bool selected);
 	void checkStatsTimeLimited();
-	bool selectQCPGraph(QCPGraph *graph);
 	void selectTaskByPid(int pid, const unsigned int *preferred_cpu,
 			     preference_t preference);
 	bool isOpenGLEnabled();
@@ -345,6 +353,7 @@ private:
 	TaskGraph *selectedGraph();
 
 	TracePlot *tracePlot;
+	TileCache *tileCache;
 	QScrollBar *scrollBar;
 	bool scrollBarUpdate;
 	YAxisTicker *yaxisTicker;
@@ -368,6 +377,8 @@ private:
 
 	QLabel *statusLabel;
 	QString *statusStrings[STATUS_NR];
+	QProgressBar *jobProgressBar;
+	QToolButton *jobCancelButton;
 
 	QAction *openAction;
 	QAction *closeAction;
@@ -418,6 +429,9 @@ private:
 	QAction *taskFilterLimitedAction;
 
 	TraceAnalyzer *analyzer;
+	JobRunner *jobRunner;
+	/* Where to scroll the eventsWidget when the filtering has completed */
+	vtl::Time filterJobScroll;
 
 	ErrorDialog *errorDialog;
 	LicenseDialog *licenseDialog;
@@ -447,6 +461,8 @@ private:
 	 */
 
 	static const double migrateSectionOffset;
+	static const int previewNrEvents;
+	static const int previewGrowthFactor;
 
 	static const QString RUNNING_NAME;
 	static const QString PREEMPTED_NAME;
@@ -491,6 +507,9 @@ private:
 	double endTime;
 	QVector<double> ticks;
 	QVector<QString> tickLabels;
+	/* The lanes are created when they come close to the visible range */
+	QVector<CpuLaneGraph*> cpuLanes;
+	QVector<double> laneOffsets;
 	Cursor *cursors[TShark::NR_CURSORS];
 	SettingStore *settingStore;
 	bool filterActive;
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <QPaintDevice>
+#include <QTransform>
+
+#include "ui/markerstamp.h"
+
+static qreal deviceRatio(const QPaintDevice *device)
+{
+#if defined(QCP_DEVICEPIXELRATIO_FLOAT)
+	return device->devicePixelRatioF();
+#elif defined(QCP_DEVICEPIXELRATIO_SUPPORTED)
+	return device->devicePixelRatio();
+#else
+	Q_UNUSED(device);
+	return 1;
+#endif
+}
+
+MarkerStamp::MarkerStamp():
+	antialiased(false), ratio(1), center(0)
+{}
+
+/* The pixmap and the custom path of the styles cannot be compared */
+bool MarkerStamp::sameStyle(const QCPScatterStyle &a,
+			    const QCPScatterStyle &b)
+{
+	return a.shape() == b.shape() && a.size() == b.size() &&
+		a.isPenDefined() == b.isPenDefined() && a.pen() == b.pen() &&
+		a.brush() == b.brush() &&
+		a.shape() != QCPScatterStyle::ssPixmap &&
+		a.shape() != QCPScatterStyle::ssCustom;
+}
+
+/*
+ * Renders the shape of the style, with the default pen if the style has no
+ * pen of its own, like QCPScatterStyle::applyTo() does. The image is made
+ * large enough for the shape and the width of the pen, with the shape in the
+ * middle.
+ */
+void MarkerStamp::render(const QCPScatterStyle &style_,
+			 const QPen &defaultPen_, bool antialiased_,
+			 qreal ratio_)
+{
+	QPen pen = style_.isPenDefined() ? style_.pen() : defaultPen_;
+	double extent;
+	int size;
+
+#ifndef QCP_DEVICEPIXELRATIO_SUPPORTED
+	ratio_ = 1;
+#endif
+	if (!image.isNull() && sameStyle(style, style_) &&
+	    defaultPen == defaultPen_ && antialiased == antialiased_ &&
+	    ratio == ratio_)
+		return;
+
+	image = QImage();
+	style = style_;
+	defaultPen = defaultPen_;
+	antialiased = antialiased_;
+	ratio = ratio_;
+	if (style.isNone() || ratio <= 0)
+		return;
+	extent = style.size() + qMax(pen.widthF(), (qreal) 1) + 2;
+	if (style.shape() == QCPScatterStyle::ssPixmap)
+		extent = qMax(extent, (double) qMax(style.pixmap().width(),
+						    style.pixmap().height()));
+	size = qCeil(extent * ratio);
+	/* An odd number of pixels, so that the center is a pixel center */
+	size |= 1;
+	center = size / ratio / 2;
+
+	image = QImage(size, size, QImage::Format_ARGB32_Premultiplied);
+#ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
+	image.setDevicePixelRatio(ratio);
+#endif
+	image.fill(Qt::transparent);
+
+	QCPPainter painter(&image);
+	painter.setAntialiasing(antialiased);
+	style.applyTo(&painter, defaultPen);
+	style.drawShape(&painter, center, center);
+}
+
+bool MarkerStamp::canDraw(const QCPPainter *painter) const
+{
+	const QPaintDevice *device = painter->device();
+
+	if (image.isNull() || device == nullptr ||
+	    painter->modes().testFlag(QCPPainter::pmVectorized) ||
+	    painter->transform().type() > QTransform::TxTranslate)
+		return false;
+	return qFuzzyCompare(deviceRatio(device), ratio);
+}
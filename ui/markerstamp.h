@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MARKERSTAMP_H
+#define MARKERSTAMP_H
+
+#include <QImage>
+#include <QPen>
+#include "ui/qcustomplot.h"
+#include "vtl/compiler.h"
+
+/*
+ * A scatter shape that is rendered once to an image, which is then drawn at
+ * every point instead of drawing the shape again. A QImage is used rather than
+ * a QPixmap because the TileCache draws from worker threads.
+ *
+ * The stamp can only be used with a painter that paints to pixels with the
+ * same device pixel ratio as the stamp and without scaling, otherwise the
+ * shape should be drawn with the QCPScatterStyle, see canDraw(). A stamp is
+ * only rendered again if the arguments of render() have changed, so it can be
+ * kept by a plottable and copied to every snapshot.
+ */
+class MarkerStamp {
+public:
+	MarkerStamp();
+	void render(const QCPScatterStyle &style, const QPen &defaultPen,
+		    bool antialiased, qreal ratio);
+	bool canDraw(const QCPPainter *painter) const;
+	vtl_always_inline void draw(QCPPainter *painter, double x,
+				    double y) const;
+private:
+	static bool sameStyle(const QCPScatterStyle &a,
+			      const QCPScatterStyle &b);
+	QImage image;
+	QCPScatterStyle style;
+	QPen defaultPen;
+	bool antialiased;
+	qreal ratio;
+	/* The distance from the corner of the image to the shape center */
+	double center;
+};
+
+vtl_always_inline void MarkerStamp::draw(QCPPainter *painter, double x,
+					 double y) const
+{
+	painter->drawImage(QPointF(x - center, y - center), image);
+}
+
+#endif /* MARKERSTAMP_H */
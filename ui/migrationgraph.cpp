@@ -0,0 +1,300 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "ui/migrationgraph.h"
+#include "vtl/compiler.h"
+
+/*
+ * If there are more visible arrows than this many per pixel column, then at
+ * most this many arrows with different CPUs are drawn in every column, and at
+ * most MIGRATIONGRAPH_MAX_SCAN arrows of a column are looked at.
+ */
+#define MIGRATIONGRAPH_MAX_PER_PIXEL (4)
+#define MIGRATIONGRAPH_MAX_SCAN (16)
+
+/* These are the defaults of the QCPLineEnding that was used before */
+const double MigrationGraph::ARROW_WIDTH = 8;
+const double MigrationGraph::ARROW_LENGTH = 10;
+
+static vtl_always_inline bool arrowBefore(const MigrationArrow &arrow,
+					  double time)
+{
+	return arrow.time < time;
+}
+
+MigrationGraph::MigrationGraph(QCPAxis *keyAxis, QCPAxis *valueAxis):
+	QCPAbstractPlottable(keyAxis, valueAxis), arrowv(nullptr), unit(1),
+	offset(0), maxCPU(-1)
+{
+	setPen(QPen(Qt::black, 1));
+	setBrush(Qt::NoBrush);
+	setSelectable(QCP::stNone);
+}
+
+/*
+ * The vector is used directly when drawing, so it must not be changed as long
+ * as this graph exists. It must be sorted by time.
+ */
+void MigrationGraph::setData(const QVector<MigrationArrow> *arrows)
+{
+	int i;
+
+	arrowv = arrows;
+	maxCPU = -1;
+	for (i = 0; i < arrows->size(); i++) {
+		const MigrationArrow &arrow = arrows->at(i);
+		maxCPU = qMax(maxCPU, (int) qMax(arrow.oldcpu, arrow.newcpu));
+	}
+	tileContentChanged();
+}
+
+void MigrationGraph::setScale(double unit_, double offset_)
+{
+	unit = unit_;
+	offset = offset_;
+	tileContentChanged();
+}
+
+QSharedPointer<TileSource> MigrationGraph::tileSource() const
+{
+	if (arrowv == nullptr || arrowv->isEmpty() || !realVisibility())
+		return QSharedPointer<TileSource>();
+	return QSharedPointer<TileSource>(new ArrowState(this));
+}
+
+int MigrationGraph::lowerBound(const QVector<MigrationArrow> *v, double key)
+{
+	return int(std::lower_bound(v->constBegin(), v->constEnd(), key,
+				    arrowBefore) - v->constBegin());
+}
+
+QCPRange MigrationGraph::valueBand() const
+{
+	return QCPRange(offset, offset + (maxCPU + 1) * unit);
+}
+
+double MigrationGraph::selectTest(const QPointF &/*pos*/,
+				  bool /*onlySelectable*/,
+				  QVariant * /*details*/) const
+{
+	return -1;
+}
+
+QCPRange MigrationGraph::getKeyRange(bool &foundRange,
+				     QCP::SignDomain inSignDomain) const
+{
+	QCPRange range;
+	int i;
+
+	foundRange = false;
+	if (arrowv == nullptr)
+		return range;
+	for (i = 0; i < arrowv->size(); i++) {
+		double t = arrowv->at(i).time;
+		if ((inSignDomain == QCP::sdPositive && t <= 0) ||
+		    (inSignDomain == QCP::sdNegative && t >= 0))
+			continue;
+		/* The arrows are sorted */
+		if (!foundRange)
+			range.lower = t;
+		range.upper = t;
+		foundRange = true;
+	}
+	return range;
+}
+
+QCPRange MigrationGraph::getValueRange(bool &foundRange,
+				       QCP::SignDomain /*inSignDomain*/,
+				       const QCPRange &/*inKeyRange*/) const
+{
+	foundRange = arrowv != nullptr && !arrowv->isEmpty();
+	return valueBand();
+}
+
+MigrationGraph::ArrowState::ArrowState(const MigrationGraph *graph):
+	arrowv(graph->arrowv), unit(graph->unit), offset(graph->offset),
+	width(graph->mPen.widthF()), band(graph->valueBand())
+{
+	antialiased = useAntialiasing(graph->parentPlot(),
+				      graph->antialiased(), QCP::aeItems);
+}
+
+/*
+ * Draws an arrow in the same way as a QCPItemLine with a QCPLineEnding of the
+ * esFlatArrow style. The pen and the brush are only changed if the color
+ * differs from the previous arrow.
+ */
+vtl_always_inline
+void MigrationGraph::ArrowState::drawArrow(QCPPainter *painter,
+					   const AxisMap &keyMap,
+					   const AxisMap &valueMap,
+					   const MigrationArrow &arrow,
+					   QRgb *color) const
+{
+	double x = keyMap.coordToPixel(arrow.time);
+	double start = valueMap.coordToPixel(offset + (arrow.oldcpu + 1) *
+					     unit);
+	double end = valueMap.coordToPixel(offset + (arrow.newcpu + 1) *
+					   unit);
+	double base;
+
+	if (start == end)
+		return;
+	if (arrow.color != *color) {
+		QPen pen = painter->pen();
+		*color = arrow.color;
+		pen.setColor(QColor(arrow.color));
+		painter->setPen(pen);
+		painter->setBrush(QBrush(pen.color(), Qt::SolidPattern));
+	}
+	base = end > start ? end - ARROW_LENGTH : end + ARROW_LENGTH;
+	const QPointF head[3] = { QPointF(x, end),
+				  QPointF(x + ARROW_WIDTH / 2, base),
+				  QPointF(x - ARROW_WIDTH / 2, base) };
+	painter->drawLine(QLineF(x, start, x, end));
+	painter->drawConvexPolygon(head, 3);
+}
+
+void MigrationGraph::ArrowState::drawTile(QCPPainter *painter,
+					  const AxisMap &keyMap,
+					  const AxisMap &valueMap) const
+{
+	const QCPRange &range = keyMap.range();
+	const MigrationArrow *arrows = arrowv->constData();
+	qint16 drawn[MIGRATIONGRAPH_MAX_PER_PIXEL][2];
+	double ppc = qAbs(keyMap.pixelsPerCoord());
+	double margin, lower, upper, colEnd;
+	int first, last, i, j, k, n, next, scanEnd, nrDrawn;
+	QRgb color;
+	QPen pen;
+
+	if (range.size() <= 0 || ppc <= 0 ||
+	    band.upper < valueMap.range().lower ||
+	    band.lower > valueMap.range().upper)
+		return;
+
+	/* The arrow heads and the pen reach a few pixels to the sides */
+	margin = (ARROW_WIDTH / 2 + width + 1) / ppc;
+	lower = range.lower - margin;
+	upper = range.upper + margin;
+	first = lowerBound(arrowv, lower);
+	last = lowerBound(arrowv, upper);
+	n = last - first;
+	if (n <= 0)
+		return;
+
+	color = arrows[first].color;
+	pen = QPen(QColor(color), width);
+	pen.setJoinStyle(Qt::MiterJoin);
+	painter->setPen(pen);
+	painter->setBrush(QBrush(pen.color(), Qt::SolidPattern));
+	painter->setAntialiasing(antialiased);
+
+	if (n <= (upper - lower) * ppc * MIGRATIONGRAPH_MAX_PER_PIXEL) {
+		for (i = first; i < last; i++)
+			drawArrow(painter, keyMap, valueMap, arrows[i],
+				  &color);
+		return;
+	}
+
+	/*
+	 * The arrows in a pixel column are drawn on top of each other, so
+	 * only the first arrows with different CPUs are drawn.
+	 */
+	for (i = first; i < last; i = next) {
+		colEnd = lower + (std::floor((arrows[i].time - lower) * ppc) +
+				  1) / ppc;
+		next = int(std::lower_bound(arrows + i, arrows + last, colEnd,
+					    arrowBefore) - arrows);
+		next = qMax(next, i + 1);
+		scanEnd = qMin(next, i + MIGRATIONGRAPH_MAX_SCAN);
+		nrDrawn = 0;
+		for (j = i; j < scanEnd &&
+			     nrDrawn < MIGRATIONGRAPH_MAX_PER_PIXEL; j++) {
+			const MigrationArrow &arrow = arrows[j];
+			for (k = 0; k < nrDrawn; k++) {
+				if (drawn[k][0] == arrow.oldcpu &&
+				    drawn[k][1] == arrow.newcpu)
+					break;
+			}
+			if (k < nrDrawn)
+				continue;
+			drawn[nrDrawn][0] = arrow.oldcpu;
+			drawn[nrDrawn][1] = arrow.newcpu;
+			nrDrawn++;
+			drawArrow(painter, keyMap, valueMap, arrow, &color);
+		}
+	}
+}
+
+void MigrationGraph::draw(QCPPainter *painter)
+{
+	if (!mKeyAxis || !mValueAxis || arrowv == nullptr ||
+	    arrowv->isEmpty() || isTiled())
+		return;
+
+	ArrowState state(this);
+	state.drawTile(painter, AxisMap(mKeyAxis.data()),
+		       AxisMap(mValueAxis.data()));
+}
+
+void MigrationGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect)
+	const
+{
+	applyDefaultAntialiasingHint(painter);
+	painter->setPen(mPen);
+	painter->drawLine(QLineF(rect.center().x(), rect.bottom(),
+				 rect.center().x(), rect.top()));
+}
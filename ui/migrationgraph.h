@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MIGRATIONGRAPH_H
+#define MIGRATIONGRAPH_H
+
+#include <QSharedPointer>
+#include <QVector>
+#include "analyzer/migration.h"
+#include "ui/axismap.h"
+#include "ui/qcustomplot.h"
+#include "ui/tilecache.h"
+
+/*
+ * A plottable that draws all migration, fork and exit arrows from a vector of
+ * MigrationArrow that is sorted by time. Only the arrows that are in the
+ * visible range are drawn. If there are so many of them that they would
+ * overlap anyway, then only a few distinct arrows are drawn for every pixel
+ * column. This replaces one QCPItemLine per migration, which QCustomPlot
+ * would have to iterate over on every replot and every click.
+ *
+ * An arrow from CPU a to CPU b is drawn from the value (a + 1) * unit + offset
+ * to (b + 1) * unit + offset, so CPU -1, the fork/exit line, is at the offset.
+ * The arrows are drawn with the width of the pen but with their own colors.
+ * The graph cannot be selected. The key axis is assumed to be horizontal.
+ */
+class MigrationGraph : public QCPAbstractPlottable, public TilePlottable
+{
+	Q_OBJECT
+public:
+	MigrationGraph(QCPAxis *keyAxis, QCPAxis *valueAxis);
+	void setData(const QVector<MigrationArrow> *arrows);
+	void setScale(double unit, double offset);
+	QSharedPointer<TileSource> tileSource() const Q_DECL_OVERRIDE;
+	double selectTest(const QPointF &pos, bool onlySelectable,
+			  QVariant *details = nullptr) const Q_DECL_OVERRIDE;
+	QCPRange getKeyRange(bool &foundRange,
+			     QCP::SignDomain inSignDomain = QCP::sdBoth) const
+		Q_DECL_OVERRIDE;
+	QCPRange getValueRange(bool &foundRange,
+			       QCP::SignDomain inSignDomain = QCP::sdBoth,
+			       const QCPRange &inKeyRange = QCPRange()) const
+		Q_DECL_OVERRIDE;
+protected:
+	void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
+	void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+		Q_DECL_OVERRIDE;
+private:
+	/* A copy of what is needed to draw the arrows from other threads */
+	class ArrowState : public TileSource {
+	public:
+		ArrowState(const MigrationGraph *graph);
+		void drawTile(QCPPainter *painter, const AxisMap &keyMap,
+			      const AxisMap &valueMap) const Q_DECL_OVERRIDE;
+	private:
+		vtl_always_inline void drawArrow(QCPPainter *painter,
+						 const AxisMap &keyMap,
+						 const AxisMap &valueMap,
+						 const MigrationArrow &arrow,
+						 QRgb *color) const;
+		const QVector<MigrationArrow> *arrowv;
+		double unit;
+		double offset;
+		double width;
+		bool antialiased;
+		/* The values between which the arrows are drawn */
+		QCPRange band;
+	};
+	static int lowerBound(const QVector<MigrationArrow> *v, double key);
+	QCPRange valueBand() const;
+	const QVector<MigrationArrow> *arrowv;
+	double unit;
+	double offset;
+	int maxCPU;
+	static const double ARROW_WIDTH;
+	static const double ARROW_LENGTH;
+};
+
+#endif /* MIGRATIONGRAPH_H */
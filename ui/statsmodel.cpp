@@ -52,7 +52,7 @@
 
 #include <QFile>
 
-#include "vtl/avltree.h"
+#include "vtl/pidmap.h"
 #include "vtl/heapsort.h"
 #include "vtl/tlist.h"
 
@@ -64,7 +64,7 @@ StatsModel::StatsModel(QObject *parent):
 	AbstractTaskModel(parent)
 {}
 
-void StatsModel::setTaskMap(vtl::AVLTree<int, TaskHandle> *map,
+void StatsModel::setTaskMap(vtl::PidMap<TaskHandle> *map,
 			    unsigned int nrcpus)
 {
 	vtl::Time delta = getDeltaTime();
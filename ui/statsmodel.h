@@ -54,7 +54,7 @@
 #define _STATSMODEL_H
 
 #include "abstracttaskmodel.h"
-#include "vtl/avltree.h"
+#include "vtl/pidmap.h"
 #include "misc/traceshark.h"
 
 class StatsModel : public AbstractTaskModel
@@ -62,7 +62,7 @@ class StatsModel : public AbstractTaskModel
 	Q_OBJECT
 public:
 	StatsModel(QObject *parent = 0);
-	void setTaskMap(vtl::AVLTree<int, TaskHandle> *map,
+	void setTaskMap(vtl::PidMap<TaskHandle> *map,
 			unsigned int nrcpus);
 	int rowCount(const QModelIndex &parent) const;
 	int columnCount(const QModelIndex &parent) const;
@@ -0,0 +1,370 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+
+#include "ui/lodgraph.h"
+#include "ui/stepgraph.h"
+
+StepGraph::StepGraph(QCPAxis *keyAxis, QCPAxis *valueAxis):
+	QCPAbstractPlottable(keyAxis, valueAxis), keyv(nullptr),
+	valuev(nullptr), pyramid(nullptr), sorted(false), valueScale(1),
+	valueOffset(0)
+{
+	setPen(QPen(Qt::black, 0));
+	setBrush(Qt::NoBrush);
+}
+
+/*
+ * The vectors are used directly when drawing, so they must not be destroyed as
+ * long as this graph exists. The pyramid is only used if the keys are sorted.
+ */
+void StepGraph::setData(const QVector<double> *keys,
+			const QVector<double> *values,
+			const vtl::MinMaxPyramid *lod)
+{
+	keyv = keys;
+	valuev = values;
+	sorted = std::is_sorted(keys->constBegin(), keys->constEnd());
+	pyramid = sorted ? lod : nullptr;
+	tileContentChanged();
+}
+
+void StepGraph::setScale(double scale, double offset)
+{
+	valueScale = scale;
+	valueOffset = offset;
+	tileContentChanged();
+}
+
+void StepGraph::setScatterStyle(const QCPScatterStyle &style)
+{
+	scatterStyle = style;
+	tileContentChanged();
+}
+
+QSharedPointer<TileSource> StepGraph::tileSource() const
+{
+	if (dataSize() == 0 || !realVisibility())
+		return QSharedPointer<TileSource>();
+	GraphState *state = new GraphState(this);
+	state->findBand();
+	return QSharedPointer<TileSource>(state);
+}
+
+int StepGraph::dataSize() const
+{
+	if (keyv == nullptr || valuev == nullptr)
+		return 0;
+	return qMin(keyv->size(), valuev->size());
+}
+
+/* The vectors may have grown since the pyramid was built */
+const vtl::MinMaxPyramid *StepGraph::usablePyramid() const
+{
+	if (pyramid == nullptr || !pyramid->isValid() ||
+	    pyramid->size() != dataSize())
+		return nullptr;
+	return pyramid;
+}
+
+double StepGraph::selectTest(const QPointF &pos, bool onlySelectable,
+			     QVariant *details) const
+{
+	const double *v;
+	double d;
+	int n = dataSize();
+
+	if ((onlySelectable && mSelectable == QCP::stNone) || n == 0 ||
+	    !mKeyAxis || !mValueAxis)
+		return -1;
+
+	if (!mKeyAxis->axisRect()->rect().contains(pos.toPoint()) &&
+	    !mParentPlot->interactions().testFlag(
+		    QCP::iSelectPlottablesBeyondAxisRect))
+		return -1;
+
+	v = valuev->constData();
+	d = LodGraph::stepDistance(
+		AxisMap(mKeyAxis.data()), AxisMap(mValueAxis.data()), pos,
+		mParentPlot->selectionTolerance(), *keyv,
+		[v, this](int i) { return v[i] * valueScale + valueOffset; },
+		n, sorted, usablePyramid(), valueScale, valueOffset);
+	if (d >= 0 && details != nullptr)
+		details->setValue(QCPDataSelection(QCPDataRange(0, n)));
+	return d;
+}
+
+QCPRange StepGraph::getKeyRange(bool &foundRange,
+				QCP::SignDomain inSignDomain) const
+{
+	QCPRange range;
+	double k;
+	int n = dataSize();
+	int i;
+
+	foundRange = false;
+	for (i = 0; i < n; i++) {
+		k = keyv->at(i);
+		if ((inSignDomain == QCP::sdPositive && k <= 0) ||
+		    (inSignDomain == QCP::sdNegative && k >= 0))
+			continue;
+		if (!foundRange) {
+			range = QCPRange(k, k);
+			foundRange = true;
+		} else {
+			range.expand(k);
+		}
+	}
+	return range;
+}
+
+QCPRange StepGraph::getValueRange(bool &foundRange,
+				  QCP::SignDomain inSignDomain,
+				  const QCPRange &inKeyRange) const
+{
+	bool restrict = inKeyRange != QCPRange();
+	QCPRange range;
+	double v;
+	int n = dataSize();
+	int i;
+
+	foundRange = false;
+	for (i = 0; i < n; i++) {
+		if (restrict && !inKeyRange.contains(keyv->at(i)))
+			continue;
+		v = valuev->at(i) * valueScale + valueOffset;
+		if ((inSignDomain == QCP::sdPositive && v <= 0) ||
+		    (inSignDomain == QCP::sdNegative && v >= 0))
+			continue;
+		if (!foundRange) {
+			range = QCPRange(v, v);
+			foundRange = true;
+		} else {
+			range.expand(v);
+		}
+	}
+	return range;
+}
+
+StepGraph::GraphState::GraphState(const StepGraph *graph):
+	pyramid(nullptr), size(graph->dataSize()), sorted(graph->sorted),
+	valueScale(graph->valueScale), valueOffset(graph->valueOffset),
+	scatterStyle(graph->scatterStyle), pen(graph->mPen),
+	band(-DBL_MAX, DBL_MAX)
+{
+	const QCustomPlot *plot = graph->parentPlot();
+	const vtl::MinMaxPyramid *usable = graph->usablePyramid();
+
+	if (size > 0) {
+		keyv = *graph->keyv;
+		valuev = *graph->valuev;
+	}
+	if (usable != nullptr) {
+		lod.share(*usable, valuev);
+		if (lod.isValid())
+			pyramid = &lod;
+	}
+
+	antialiased = useAntialiasing(plot, graph->antialiased(),
+				      QCP::aePlottables);
+	scattersAntialiased = useAntialiasing(plot,
+					      graph->antialiasedScatters(),
+					      QCP::aeScatters);
+	graph->scatterStamp.render(scatterStyle, pen, scattersAntialiased,
+				   plot->bufferDevicePixelRatio());
+	scatterStamp = graph->scatterStamp;
+}
+
+/*
+ * Finds the values between which the graph is drawn, so that the tiles that
+ * are above or below it can be skipped quickly.
+ */
+void StepGraph::GraphState::findBand()
+{
+	double min, max;
+	int changes;
+
+	if (size == 0)
+		return;
+	if (pyramid != nullptr) {
+		pyramid->query(0, size, min, max, changes);
+	} else {
+		const double *v = valuev.constData();
+		min = *std::min_element(v, v + size);
+		max = *std::max_element(v, v + size);
+	}
+	band = QCPRange(min * valueScale + valueOffset,
+			max * valueScale + valueOffset);
+	band.normalize();
+}
+
+void StepGraph::GraphState::drawGraph(QCPPainter *painter,
+				      const AxisMap &keyMap,
+				      const AxisMap &valueMap,
+				      const QPen &linePen,
+				      Buffers *buffers) const
+{
+	const QCPRange &range = keyMap.range();
+	const QVector<QCPGraphData> &lineData = buffers->lineData;
+	const double *k;
+	const double *v;
+	int n = size;
+	int a, b, i;
+	int ix, iy, lastX, lastY;
+	bool useStamp;
+	double x, y;
+
+	if (n == 0 || range.size() <= 0)
+		return;
+	if (band.upper < valueMap.range().lower ||
+	    band.lower > valueMap.range().upper)
+		return;
+
+	/* Include one point on each side, so that the lines reach the edges */
+	k = keyv.constData();
+	if (sorted) {
+		a = int(std::lower_bound(k, k + n, range.lower) - k) - 1;
+		a = qMax(a, 0);
+		b = int(std::upper_bound(k, k + n, range.upper) - k) + 1;
+		b = qMin(b, n);
+	} else {
+		a = 0;
+		b = n;
+	}
+	if (a >= b)
+		return;
+
+	v = valuev.constData();
+	LodGraph::stepLines(
+		keyMap, valueMap, keyv,
+		[v, this](int i) { return v[i] * valueScale + valueOffset; },
+		pyramid, valueScale, valueOffset, a, b, &buffers->lineData,
+		&buffers->lines);
+
+	painter->setPen(linePen);
+	painter->setBrush(Qt::NoBrush);
+	painter->setAntialiasing(antialiased);
+	painter->drawPolyline(buffers->lines.constData(),
+			      buffers->lines.size());
+
+	if (scatterStyle.isNone())
+		return;
+
+	/*
+	 * The scatters are drawn at the points of the line, so when the line
+	 * has been sampled, they are drawn at the sampled points.
+	 */
+	useStamp = scatterStamp.canDraw(painter);
+	if (!useStamp) {
+		painter->setAntialiasing(scattersAntialiased);
+		scatterStyle.applyTo(painter, pen);
+	}
+	lastX = INT_MIN;
+	lastY = INT_MIN;
+	for (i = 0; i < lineData.size(); i++) {
+		x = keyMap.coordToPixel(lineData[i].key);
+		y = valueMap.coordToPixel(lineData[i].value);
+		ix = int(x);
+		iy = int(y);
+		if (ix == lastX && iy == lastY)
+			continue;
+		if (useStamp)
+			scatterStamp.draw(painter, x, y);
+		else
+			scatterStyle.drawShape(painter, x, y);
+		lastX = ix;
+		lastY = iy;
+	}
+}
+
+void StepGraph::GraphState::drawTile(QCPPainter *painter,
+				     const AxisMap &keyMap,
+				     const AxisMap &valueMap) const
+{
+	Buffers buffers;
+
+	drawGraph(painter, keyMap, valueMap, pen, &buffers);
+}
+
+void StepGraph::draw(QCPPainter *painter)
+{
+	bool drawSelected = selected() && mSelectionDecorator != nullptr;
+
+	if (!mKeyAxis || !mValueAxis || dataSize() == 0)
+		return;
+	if (mKeyAxis->range().size() <= 0)
+		return;
+	if (isTiled() && !drawSelected)
+		return;
+
+	GraphState state(this);
+	state.drawGraph(painter, AxisMap(mKeyAxis.data()),
+			AxisMap(mValueAxis.data()),
+			drawSelected ? mSelectionDecorator->pen() : mPen,
+			&buffers);
+}
+
+void StepGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+{
+	applyDefaultAntialiasingHint(painter);
+	painter->setPen(mPen);
+	painter->drawLine(QLineF(rect.left(), rect.center().y(),
+				 rect.right(), rect.center().y()));
+	if (!scatterStyle.isNone()) {
+		applyScattersAntialiasingHint(painter);
+		scatterStyle.applyTo(painter, mPen);
+		scatterStyle.drawShape(painter, rect.center());
+	}
+}
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef STEPGRAPH_H
+#define STEPGRAPH_H
+
+#include <QPen>
+#include <QSharedPointer>
+#include <QVector>
+#include "ui/axismap.h"
+#include "ui/markerstamp.h"
+#include "ui/qcustomplot.h"
+#include "ui/tilecache.h"
+#include "vtl/minmaxpyramid.h"
+
+/*
+ * A step graph that draws vectors owned by someone else, typically the
+ * analyzer, without copying them into a QCPGraphDataContainer. The values are
+ * drawn as value * scale + offset, so changing the layout only requires a new
+ * call to setScale(). The pyramid, if any, must have been built from the
+ * unscaled values. The key axis is assumed to be horizontal.
+ *
+ * When the graph is drawn by a TileCache, draw() only draws it if it's
+ * selected.
+ */
+class StepGraph : public QCPAbstractPlottable, public TilePlottable
+{
+	Q_OBJECT
+public:
+	StepGraph(QCPAxis *keyAxis, QCPAxis *valueAxis);
+	void setData(const QVector<double> *keys,
+		     const QVector<double> *values,
+		     const vtl::MinMaxPyramid *lod);
+	void setScale(double scale, double offset);
+	void setScatterStyle(const QCPScatterStyle &style);
+	QSharedPointer<TileSource> tileSource() const Q_DECL_OVERRIDE;
+	double selectTest(const QPointF &pos, bool onlySelectable,
+			  QVariant *details = nullptr) const Q_DECL_OVERRIDE;
+	QCPRange getKeyRange(bool &foundRange,
+			     QCP::SignDomain inSignDomain = QCP::sdBoth) const
+		Q_DECL_OVERRIDE;
+	QCPRange getValueRange(bool &foundRange,
+			       QCP::SignDomain inSignDomain = QCP::sdBoth,
+			       const QCPRange &inKeyRange = QCPRange()) const
+		Q_DECL_OVERRIDE;
+protected:
+	void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
+	void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+		Q_DECL_OVERRIDE;
+private:
+	class Buffers {
+	public:
+		QVector<QCPGraphData> lineData;
+		QVector<QPointF> lines;
+	};
+	/*
+	 * A copy of what is needed to draw the graph from other threads. The
+	 * vectors are implicitly shared with the owner, so they are detached
+	 * if the owner appends to them while the snapshot exists.
+	 */
+	class GraphState : public TileSource {
+	public:
+		GraphState(const StepGraph *graph);
+		void findBand();
+		void drawTile(QCPPainter *painter, const AxisMap &keyMap,
+			      const AxisMap &valueMap) const Q_DECL_OVERRIDE;
+		void drawGraph(QCPPainter *painter, const AxisMap &keyMap,
+			       const AxisMap &valueMap, const QPen &pen,
+			       Buffers *buffers) const;
+	private:
+		QVector<double> keyv;
+		QVector<double> valuev;
+		vtl::MinMaxPyramid lod;
+		const vtl::MinMaxPyramid *pyramid;
+		int size;
+		bool sorted;
+		double valueScale;
+		double valueOffset;
+		QCPScatterStyle scatterStyle;
+		MarkerStamp scatterStamp;
+		QPen pen;
+		bool antialiased;
+		bool scattersAntialiased;
+		/* The values between which the graph is drawn */
+		QCPRange band;
+	};
+	int dataSize() const;
+	const vtl::MinMaxPyramid *usablePyramid() const;
+	const QVector<double> *keyv;
+	const QVector<double> *valuev;
+	const vtl::MinMaxPyramid *pyramid;
+	bool sorted;
+	double valueScale;
+	double valueOffset;
+	QCPScatterStyle scatterStyle;
+	/* This is copied to the snapshots and only rendered when changed */
+	mutable MarkerStamp scatterStamp;
+	/* These are reused between calls to draw() */
+	Buffers buffers;
+};
+
+#endif /* STEPGRAPH_H */
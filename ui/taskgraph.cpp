@@ -50,6 +50,8 @@
  *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "ui/cpulanegraph.h"
+#include "ui/lodgraph.h"
 #include "ui/qcustomplot.h"
 #include "ui/taskgraph.h"
 #include "analyzer/task.h"
@@ -58,15 +60,26 @@ QMap<QCPGraph *, TaskGraph *> TaskGraph::graphDir;
 
 TaskGraph::TaskGraph(QCustomPlot *parent, unsigned int cpu_,
 		     enum GraphType g):
-	plot(parent), task(nullptr), taskGraph(nullptr), cpu(cpu_),
-	graph_type(g)
+	plot(parent), task(nullptr), taskGraph(nullptr), legendGraph(nullptr),
+	lane(nullptr), laneIndex(-1), cpu(cpu_), graph_type(g)
 {
-	graph = parent->addGraph(parent->xAxis, parent->yAxis);
+	graph = new LodGraph(parent->xAxis, parent->yAxis);
 	graphDir[graph] = this;
 	graph->setAdaptiveSampling(true);
 	graph->setLineStyle(QCPGraph::lsStepLeft);
-	legendGraph = parent->addGraph(parent->xAxis, parent->yAxis);
-	graphDir[legendGraph] = this;
+}
+
+/*
+ * Creates a per CPU graph that is drawn by lane, which uses the vectors of
+ * cpuTask directly, so there is no need to call setData().
+ */
+TaskGraph::TaskGraph(CpuLaneGraph *lane_, const CPUTask *cpuTask,
+		     unsigned int cpu_):
+	plot(lane_->parentPlot()), task(nullptr), taskGraph(nullptr),
+	graph(nullptr), legendGraph(nullptr), lane(lane_), cpu(cpu_),
+	graph_type(GRAPH_CPUGRAPH)
+{
+	laneIndex = lane->addTask(cpuTask, this);
 }
 
 TaskGraph::~TaskGraph()
@@ -75,19 +88,25 @@ TaskGraph::~TaskGraph()
 
 void TaskGraph::destroy()
 {
-	plot->removeGraph(graph);
-	plot->removeGraph(legendGraph);
-	graphDir.remove(graph);
-	graphDir.remove(legendGraph);
+	if (graph != nullptr) {
+		plot->removeGraph(graph);
+		graphDir.remove(graph);
+	}
+	if (legendGraph != nullptr) {
+		plot->removeGraph(legendGraph);
+		graphDir.remove(legendGraph);
+	}
 	delete this;
 }
 
 void TaskGraph::setTask(Task *newTask)
 {
-	QString name = *newTask->displayName;
+	name = *newTask->displayName;
 	name += QString(":") + QString::number(newTask->pid);
-	graph->setName(name);
-	legendGraph->setName(name);
+	if (graph != nullptr)
+		graph->setName(name);
+	if (legendGraph != nullptr)
+		legendGraph->setName(name);
 	task = newTask;
 }	
 
@@ -98,20 +117,32 @@ Task *TaskGraph::getTask()
 
 void TaskGraph::setPen(const QPen &pen)
 {
-	graph->setPen(pen);
+	if (graph != nullptr)
+		graph->setPen(pen);
+	if (lane != nullptr)
+		lane->setTaskPen(laneIndex, pen);
 
-	QPen legendPen(pen);
+	legendPen = pen;
 	legendPen.setWidth(5);
-	legendGraph->setPen(legendPen);
+	if (legendGraph != nullptr)
+		legendGraph->setPen(legendPen);
 }
 
 bool TaskGraph::addToLegend()
 {
+	if (legendGraph == nullptr) {
+		legendGraph = plot->addGraph(plot->xAxis, plot->yAxis);
+		legendGraph->setName(name);
+		legendGraph->setPen(legendPen);
+		graphDir[legendGraph] = this;
+	}
 	return legendGraph->addToLegend();
 }
 
 bool TaskGraph::removeFromLegend() const
 {
+	if (legendGraph == nullptr)
+		return false;
 	return legendGraph->removeFromLegend();
 }
 
@@ -127,9 +158,11 @@ void TaskGraph::setTaskGraphForLegend(TaskGraph *legendTaskGraph)
 
 void TaskGraph::setData(const QVector<double > &keys,
 			const QVector<double> &values,
-			bool alreadySorted)
+			const vtl::MinMaxPyramid *lod, double lodScale,
+			double lodOffset)
 {
-	graph->setData(keys, values, alreadySorted);
+	if (graph != nullptr)
+		graph->setData(keys, values, lod, lodScale, lodOffset);
 }
 
 TaskGraph *TaskGraph::fromQCPGraph(QCPGraph *g)
@@ -145,11 +178,42 @@ void TaskGraph::clearMap()
 	graphDir.clear();
 }
 
+/* Returns nullptr if the graph is drawn by a CpuLaneGraph */
 QCPGraph *TaskGraph::getQCPGraph()
 {
 	return graph;
 }
 
+QCustomPlot *TaskGraph::getPlot()
+{
+	return plot;
+}
+
+bool TaskGraph::isSelected() const
+{
+	if (lane != nullptr)
+		return lane->isTaskSelected(laneIndex);
+	return graph->selected();
+}
+
+bool TaskGraph::select()
+{
+	int end;
+
+	if (lane != nullptr) {
+		lane->selectTask(laneIndex);
+		return true;
+	}
+
+	end = graph->dataCount() - 1;
+	if (end < 0)
+		return false;
+	QCPDataRange wholeRange(0,  end);
+	QCPDataSelection wholeSelection(wholeRange);
+	graph->setSelection(std::move(wholeSelection));
+	return true;
+}
+
 unsigned int TaskGraph::getCPU()
 {
 	return cpu;
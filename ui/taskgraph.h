@@ -53,15 +53,23 @@
 #ifndef TASKGRAPH_H
 #define TASKGRAPH_H
 
+#include <QPen>
 #include <QString>
 #include <QVector>
 #include <QMap>
 
+class CPUTask;
+class CpuLaneGraph;
 class LegendGraph;
+class LodGraph;
 class Task;
 class QCustomPlot;
 class QCPGraph;
 
+namespace vtl {
+	class MinMaxPyramid;
+}
+
 class TaskGraph
 {
 public:
@@ -70,6 +78,8 @@ public:
 		GRAPH_UNIFIED
 	};
 	TaskGraph(QCustomPlot *parent, unsigned int cpu_, enum GraphType g);
+	TaskGraph(CpuLaneGraph *lane_, const CPUTask *cpuTask,
+		  unsigned int cpu_);
 	virtual ~TaskGraph();
 	void destroy();
 	void setTask(Task *newTask);
@@ -81,10 +91,14 @@ public:
 	bool removeFromLegend() const;
 	void setData(const QVector<double > &keys,
 		     const QVector<double> &values,
-		     bool alreadySorted = false);
+		     const vtl::MinMaxPyramid *lod = nullptr,
+		     double lodScale = 1, double lodOffset = 0);
 	static TaskGraph *fromQCPGraph(QCPGraph *g);
 	static void clearMap();
 	QCPGraph *getQCPGraph();
+	QCustomPlot *getPlot();
+	bool isSelected() const;
+	bool select();
 	unsigned int getCPU();
 	int getPid();
 	enum TaskGraph::GraphType getGraphType();
@@ -92,8 +106,14 @@ private:
 	QCustomPlot *plot;
 	Task *task;
 	TaskGraph *taskGraph;
-	QCPGraph *graph;
+	/* This is nullptr if the graph is drawn by a CpuLaneGraph */
+	LodGraph *graph;
+	/* This is created when the graph is added to the legend */
 	QCPGraph *legendGraph;
+	CpuLaneGraph *lane;
+	int laneIndex;
+	QString name;
+	QPen legendPen;
 	unsigned int cpu;
 	enum GraphType graph_type;
 	static QMap<QCPGraph *, TaskGraph *> graphDir;
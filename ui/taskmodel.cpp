@@ -52,7 +52,7 @@
 
 #include <QFile>
 
-#include "vtl/avltree.h"
+#include "vtl/pidmap.h"
 #include "vtl/heapsort.h"
 #include "vtl/tlist.h"
 
@@ -64,7 +64,7 @@ TaskModel::TaskModel(QObject *parent):
 	AbstractTaskModel(parent)
 {}
 
-void TaskModel::setTaskMap(vtl::AVLTree<int, TaskHandle> *map,
+void TaskModel::setTaskMap(vtl::PidMap<TaskHandle> *map,
 			   unsigned int /*nrcpus*/)
 {
 	taskList->clear();
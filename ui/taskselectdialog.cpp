@@ -61,7 +61,7 @@
 #include <QHBoxLayout>
 #include <QWidget>
 
-#include "vtl/avltree.h"
+#include "vtl/pidmap.h"
 #include "vtl/error.h"
 
 #include "ui/taskselectdialog.h"
@@ -201,7 +201,7 @@ TaskSelectDialog::~TaskSelectDialog()
 	delete indexMap;
 }
 
-void TaskSelectDialog::setTaskMap(vtl::AVLTree<int, TaskHandle> *map,
+void TaskSelectDialog::setTaskMap(vtl::PidMap<TaskHandle> *map,
 				  unsigned int nrcpus)
 {
 	taskModel->setTaskMap(map, nrcpus);
@@ -57,7 +57,7 @@
 #include <QString>
 
 #include "analyzer/task.h"
-#include "vtl/avltree.h"
+#include "vtl/pidmap.h"
 
 QT_BEGIN_NAMESPACE
 class QCheckBox;
@@ -82,7 +82,7 @@ public:
 	TaskSelectDialog(QWidget *parent, const QString &title,
 			 enum TaskSelectType type);
 	~TaskSelectDialog();
-	void setTaskMap(vtl::AVLTree<int, TaskHandle> *map,
+	void setTaskMap(vtl::PidMap<TaskHandle> *map,
 			unsigned int nrcpus);
 	void beginResetModel();
 	void endResetModel();
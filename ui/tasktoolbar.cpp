@@ -183,15 +183,12 @@ void TaskToolBar::clearLegend()
 {
 	bool before, after;
 	QCustomPlot *plot = nullptr;
-	QObject *obj;
 	DEFINE_PIDMAP_ITERATOR(iter) = legendPidMap.begin();
 	while(iter != legendPidMap.end()) {
 		TaskGraph *graph = iter.value();
 		graph->removeFromLegend();
-		if (plot == nullptr) {
-			obj = graph->getQCPGraph()->parent();
-			plot = qobject_cast<QCustomPlot *>(obj);
-		}
+		if (plot == nullptr)
+			plot = graph->getPlot();
 		iter++;
 	}
 	if (plot != nullptr)
@@ -207,7 +204,7 @@ bool TaskToolBar::checkGraphSelection()
 {
 	if (taskGraph == nullptr)
 		return false;
-	if (taskGraph->getQCPGraph()->selected())
+	if (taskGraph->isSelected())
 		return false;
 	removeTaskGraph();
 	return true;
@@ -0,0 +1,692 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <QHash>
+#include <QMetaObject>
+#include <QThread>
+#include <QtMath>
+
+#include <cmath>
+
+#include "ui/tilecache.h"
+#include "misc/traceshark.h"
+#include "vtl/compiler.h"
+
+/* The width and height of a tile in pixels */
+#define TILECACHE_SIZE (256)
+/* The tiles that are kept in memory, in KiB */
+#define TILECACHE_MAX_KB (128 * 1024)
+/*
+ * Things that are a few pixels outside of a tile, such as the scatters, may
+ * extend into it. So the tiles are drawn with a margin.
+ */
+#define TILECACHE_MARGIN (16)
+#define TILECACHE_MAX_THREADS (4)
+/* The number of zoom levels per doubling of the scale */
+#define TILECACHE_LEVEL_STEPS (1 << 20)
+
+TileSource::~TileSource()
+{}
+
+TilePlottable::TilePlottable():
+	tileCache(nullptr)
+{}
+
+TilePlottable::~TilePlottable()
+{
+	if (tileCache != nullptr)
+		tileCache->removeSource(this);
+}
+
+/*
+ * If the plottable only draws between two values, then this returns true and
+ * sets band to them, so that adding the plottable only invalidates the tiles
+ * between them.
+ */
+bool TilePlottable::tileBand(QCPRange * /* band */) const
+{
+	return false;
+}
+
+bool TilePlottable::isTiled() const
+{
+	return tileCache != nullptr;
+}
+
+void TilePlottable::tileContentChanged()
+{
+	if (tileCache != nullptr)
+		tileCache->invalidate();
+}
+
+/*
+ * This does the same as QCPLayerable::applyAntialiasingHint() but returns
+ * the result, so that it can be stored in a snapshot.
+ */
+bool TilePlottable::useAntialiasing(const QCustomPlot *plot, bool local,
+				    QCP::AntialiasedElement element)
+{
+	if (plot != nullptr) {
+		if (plot->notAntialiasedElements().testFlag(element))
+			return false;
+		if (plot->antialiasedElements().testFlag(element))
+			return true;
+	}
+	return local;
+}
+
+bool TileCache::TileKey::operator==(const TileKey &other) const
+{
+	return x == other.x && y == other.y && keyLevel == other.keyLevel &&
+		valueLevel == other.valueLevel;
+}
+
+TILECACHE_HASH_T qHash(const TileCache::TileKey &key,
+		       TILECACHE_HASH_T seed)
+{
+	TILECACHE_HASH_T h = qHash(key.x, seed);
+
+	h = h * 31 + qHash(key.y, seed);
+	h = h * 31 + qHash(key.keyLevel, seed);
+	return h * 31 + qHash(key.valueLevel, seed);
+}
+
+TileCache::TileCache(QCustomPlot *plot, QCPAxis *keyAxis_,
+		     QCPAxis *valueAxis_):
+	QCPLayerable(plot), keyAxis(keyAxis_), valueAxis(valueAxis_),
+	snapshotsValid(false), cache(TILECACHE_MAX_KB), generation(0),
+	running(0), exiting(false)
+{
+	int i;
+
+	nrThreads = QThread::idealThreadCount() - 1;
+	nrThreads = TSMAX(nrThreads, 1);
+	nrThreads = TSMIN(nrThreads, TILECACHE_MAX_THREADS);
+	threads = new WorkThread<TileCache>[nrThreads]();
+	for (i = 0; i < nrThreads; i++) {
+		threads[i].setObjFn(this, &TileCache::threadLoop);
+		threads[i].start();
+	}
+}
+
+TileCache::~TileCache()
+{
+	int i;
+
+	mutex.lock();
+	exiting = true;
+	cancel_();
+	workCond.wakeAll();
+	mutex.unlock();
+	for (i = 0; i < nrThreads; i++)
+		threads[i].wait();
+	delete[] threads;
+	qDeleteAll(finished);
+	for (i = 0; i < plottables.size(); i++)
+		plottables[i]->tileCache = nullptr;
+}
+
+void TileCache::addSource(TilePlottable *source)
+{
+	QCPRange band;
+
+	source->tileCache = this;
+	plottables.append(source);
+	if (source->tileBand(&band))
+		invalidateBand(band);
+	else
+		invalidate();
+}
+
+void TileCache::removeSource(TilePlottable *source)
+{
+	source->tileCache = nullptr;
+	plottables.removeAll(source);
+	invalidate();
+}
+
+/*
+ * This removes all plottables. The snapshots may refer to the data of the
+ * plottables, so we wait for the tiles that are being rendered.
+ */
+void TileCache::clear()
+{
+	int i;
+
+	mutex.lock();
+	cancel_();
+	while (running > 0)
+		doneCond.wait(&mutex);
+	qDeleteAll(finished);
+	finished.clear();
+	mutex.unlock();
+
+	for (i = 0; i < plottables.size(); i++)
+		plottables[i]->tileCache = nullptr;
+	plottables.clear();
+	snapshots.clear();
+	snapshotsValid = false;
+	cache.clear();
+	lastTiles.clear();
+	wanted.clear();
+}
+
+/*
+ * This should be called when any of the plottables draws something else than
+ * before. The tiles of the last frame are kept, so that they can be shown
+ * until the new ones arrive.
+ */
+void TileCache::invalidate()
+{
+	mutex.lock();
+	cancel_();
+	mutex.unlock();
+	snapshotsValid = false;
+	cache.clear();
+	wanted.clear();
+}
+
+static vtl_always_inline bool rangesOverlap(const QCPRange &a,
+					    const QCPRange &b)
+{
+	return a.lower <= b.upper && b.lower <= a.upper;
+}
+
+/*
+ * This is used when something is drawn between the values of band, where
+ * nothing was drawn before. Only the tiles that overlap band are dropped,
+ * the other tiles and the jobs for them stay valid.
+ */
+void TileCache::invalidateBand(const QCPRange &band)
+{
+	AxisMap valueMap(valueAxis);
+	const double ppc = valueMap.pixelsPerCoord();
+	QList<TileJob*>::iterator iter;
+	double scale;
+
+	if (ppc == 0 || !std::isfinite(ppc)) {
+		invalidate();
+		return;
+	}
+
+	mutex.lock();
+	iter = queue.begin();
+	while (iter != queue.end()) {
+		TileJob *job = *iter;
+		if (rangesOverlap(tileRange(job->key.y, job->valueScale),
+				  band)) {
+			pending.remove(job->key);
+			delete job;
+			iter = queue.erase(iter);
+		} else
+			iter++;
+	}
+	/* The tiles that are being rendered are dropped when they finish */
+	for (TileJob *job : rendering) {
+		if (rangesOverlap(tileRange(job->key.y, job->valueScale),
+				  band)) {
+			job->stale = true;
+			pending.remove(job->key);
+		}
+	}
+	for (TileJob *job : finished) {
+		if (rangesOverlap(tileRange(job->key.y, job->valueScale),
+				  band))
+			job->stale = true;
+	}
+	mutex.unlock();
+
+	snapshotsValid = false;
+	for (const TileKey &key : cache.keys()) {
+		scale = levelScale(key.valueLevel, ppc);
+		if (rangesOverlap(tileRange(key.y, scale), band))
+			cache.remove(key);
+	}
+}
+
+void TileCache::applyDefaultAntialiasingHint(QCPPainter *painter) const
+{
+	/* The tiles must be blitted at exact pixel positions */
+	painter->setAntialiasing(false);
+}
+
+QRect TileCache::clipRect() const
+{
+	if (keyAxis != nullptr)
+		return keyAxis->axisRect()->rect();
+	return QRect();
+}
+
+void TileCache::draw(QCPPainter *painter)
+{
+	QList<QPair<TileKey, QImage>> frameTiles;
+	QList<TileKey> missing;
+	QList<TileKey> requested;
+	QRegion missingRegion;
+	qint64 x, y, x0, x1, y0, y1;
+	qreal ratio;
+	QRect r;
+	Grid grid;
+
+	if (plottables.isEmpty())
+		return;
+
+	if (keyAxis->scaleType() != QCPAxis::stLinear ||
+	    valueAxis->scaleType() != QCPAxis::stLinear ||
+	    painter->modes().testFlag(QCPPainter::pmVectorized) ||
+	    painter->modes().testFlag(QCPPainter::pmNoCaching)) {
+		drawDirect(painter);
+		return;
+	}
+
+	AxisMap keyMap(keyAxis);
+	AxisMap valueMap(valueAxis);
+	if (keyMap.pixelsPerCoord() == 0 || valueMap.pixelsPerCoord() == 0 ||
+	    !std::isfinite(keyMap.pixelsPerCoord()) ||
+	    !std::isfinite(valueMap.pixelsPerCoord()))
+		return;
+
+	updateSnapshots();
+	if (snapshots.isEmpty())
+		return;
+
+	r = clipRect();
+	if (r.isEmpty())
+		return;
+
+	grid = makeGrid(keyMap, valueMap);
+	x0 = (qint64) std::floor((r.left() - grid.sx) / TILECACHE_SIZE);
+	x1 = (qint64) std::floor((r.right() - grid.sx) / TILECACHE_SIZE);
+	y0 = (qint64) std::floor((r.top() - grid.sy) / TILECACHE_SIZE);
+	y1 = (qint64) std::floor((r.bottom() - grid.sy) / TILECACHE_SIZE);
+	ratio = mParentPlot->bufferDevicePixelRatio();
+
+	for (y = y0; y <= y1; y++) {
+		for (x = x0; x <= x1; x++) {
+			TileKey key = { grid.keyLevel, grid.valueLevel, x, y };
+			QImage *image = cache.object(key);
+			if (image != nullptr) {
+				painter->drawImage(tileRect(grid, x, y)
+						   .topLeft(), *image);
+				frameTiles.append(QPair<TileKey, QImage>(
+							  key, *image));
+			} else {
+				missing.append(key);
+				missingRegion += tileRect(grid, x, y);
+			}
+		}
+	}
+
+	/*
+	 * If there is nothing to show in the meantime, then we wait for the
+	 * tiles, so that we never show a frame with holes in it.
+	 */
+	if (!missing.isEmpty() && lastTiles.isEmpty()) {
+		request(missing, grid, ratio);
+		waitFor(missing);
+		collect();
+		for (const TileKey &key : missing) {
+			QImage *image = cache.object(key);
+			if (image == nullptr)
+				continue;
+			painter->drawImage(tileRect(grid, key.x, key.y)
+					   .topLeft(), *image);
+			frameTiles.append(QPair<TileKey, QImage>(key, *image));
+		}
+		missing.clear();
+	}
+
+	if (!missing.isEmpty())
+		drawFallback(painter, grid, missingRegion);
+
+	/* Visible tiles first, then the tiles around the visible area */
+	requested = missing;
+	for (y = y0 - 1; y <= y1 + 1; y++) {
+		for (x = x0 - 1; x <= x1 + 1; x++) {
+			if (x >= x0 && x <= x1 && y >= y0 && y <= y1)
+				continue;
+			TileKey key = { grid.keyLevel, grid.valueLevel, x, y };
+			if (!cache.contains(key))
+				requested.append(key);
+		}
+	}
+	request(requested, grid, ratio);
+
+	wanted.clear();
+	for (const TileKey &key : missing)
+		wanted.insert(key);
+	if (missing.isEmpty()) {
+		lastGrid = grid;
+		lastTiles = frameTiles;
+	}
+}
+
+TileCache::Grid TileCache::makeGrid(const AxisMap &keyMap,
+				    const AxisMap &valueMap) const
+{
+	Grid grid;
+	double lower;
+
+	grid.keyLevel = zoomLevel(keyMap.pixelsPerCoord());
+	grid.valueLevel = zoomLevel(valueMap.pixelsPerCoord());
+	grid.keyScale = levelScale(grid.keyLevel, keyMap.pixelsPerCoord());
+	grid.valueScale = levelScale(grid.valueLevel,
+				     valueMap.pixelsPerCoord());
+
+	/*
+	 * The scale of the grid is slightly different from the scale of the
+	 * axes, so we align them at the lower end of the range.
+	 */
+	lower = keyMap.range().lower;
+	grid.sx = keyMap.coordToPixel(lower) - lower * grid.keyScale;
+	lower = valueMap.range().lower;
+	grid.sy = valueMap.coordToPixel(lower) - lower * grid.valueScale;
+	return grid;
+}
+
+/*
+ * The scale is quantized, so that the tiles can be reused after zooming back
+ * and forth, and so that a tiny change of the range doesn't change the scale.
+ */
+qint64 TileCache::zoomLevel(double pixelsPerCoord)
+{
+	return qRound64(std::log2(qAbs(pixelsPerCoord)) *
+			TILECACHE_LEVEL_STEPS);
+}
+
+double TileCache::levelScale(qint64 level, double pixelsPerCoord)
+{
+	double scale = std::exp2((double) level / TILECACHE_LEVEL_STEPS);
+
+	return pixelsPerCoord < 0 ? -scale : scale;
+}
+
+/*
+ * Returns the coordinates that are drawn on the tile at pos in the grid,
+ * including the margin.
+ */
+QCPRange TileCache::tileRange(qint64 pos, double scale)
+{
+	const double base = pos * TILECACHE_SIZE / scale;
+	const double m = TILECACHE_MARGIN;
+	QCPRange range(base - m / scale,
+		       base + (TILECACHE_SIZE + m) / scale);
+
+	range.normalize();
+	return range;
+}
+
+QRect TileCache::tileRect(const Grid &grid, qint64 x, qint64 y) const
+{
+	return QRect(qRound(grid.sx + x * TILECACHE_SIZE),
+		     qRound(grid.sy + y * TILECACHE_SIZE),
+		     TILECACHE_SIZE, TILECACHE_SIZE);
+}
+
+/*
+ * The queued jobs that are not in keys are dropped, since they are about
+ * tiles that have been scrolled out of view or that belong to another zoom
+ * level.
+ */
+void TileCache::request(const QList<TileKey> &keys, const Grid &grid,
+			qreal ratio)
+{
+	QSet<TileKey> keySet;
+	QList<TileJob*>::iterator iter;
+
+	for (const TileKey &key : keys)
+		keySet.insert(key);
+
+	mutex.lock();
+	iter = queue.begin();
+	while (iter != queue.end()) {
+		TileJob *job = *iter;
+		if (!keySet.contains(job->key)) {
+			pending.remove(job->key);
+			delete job;
+			iter = queue.erase(iter);
+		} else
+			iter++;
+	}
+	for (const TileKey &key : keys) {
+		if (pending.contains(key))
+			continue;
+		TileJob *job = new TileJob;
+		job->key = key;
+		job->generation = generation;
+		job->stale = false;
+		job->keyScale = grid.keyScale;
+		job->valueScale = grid.valueScale;
+		job->keyReversed = keyAxis->rangeReversed();
+		job->valueReversed = valueAxis->rangeReversed();
+		job->ratio = ratio;
+		job->sources = snapshots;
+		queue.append(job);
+		pending.insert(key);
+	}
+	workCond.wakeAll();
+	mutex.unlock();
+}
+
+void TileCache::waitFor(const QList<TileKey> &keys)
+{
+	mutex.lock();
+	for (const TileKey &key : keys) {
+		while (pending.contains(key))
+			doneCond.wait(&mutex);
+	}
+	mutex.unlock();
+}
+
+/*
+ * The tiles of the last complete frame are scaled and translated to where
+ * they would be now and drawn over the missing tiles.
+ */
+void TileCache::drawFallback(QCPPainter *painter, const Grid &grid,
+			     const QRegion &missing)
+{
+	double fx, fy;
+
+	fx = grid.keyScale / lastGrid.keyScale;
+	fy = grid.valueScale / lastGrid.valueScale;
+	if (!(fx > 0) || !(fy > 0) || !std::isfinite(fx) ||
+	    !std::isfinite(fy))
+		return;
+
+	painter->save();
+	painter->setClipRegion(missing, Qt::IntersectClip);
+	painter->setRenderHint(QPainter::SmoothPixmapTransform);
+	painter->translate(grid.sx - lastGrid.sx * fx,
+			   grid.sy - lastGrid.sy * fy);
+	painter->scale(fx, fy);
+	for (const QPair<TileKey, QImage> &tile : lastTiles) {
+		painter->drawImage(tileRect(lastGrid, tile.first.x,
+					    tile.first.y).topLeft(),
+				   tile.second);
+	}
+	painter->restore();
+}
+
+/* This is used for exports, which should not be pixelated */
+void TileCache::drawDirect(QCPPainter *painter)
+{
+	AxisMap keyMap(keyAxis);
+	AxisMap valueMap(valueAxis);
+
+	updateSnapshots();
+	for (const QSharedPointer<TileSource> &source : snapshots) {
+		painter->save();
+		source->drawTile(painter, keyMap, valueMap);
+		painter->restore();
+	}
+}
+
+void TileCache::updateSnapshots()
+{
+	if (snapshotsValid)
+		return;
+	snapshots.clear();
+	for (const TilePlottable *plottable : plottables) {
+		QSharedPointer<TileSource> source = plottable->tileSource();
+		if (!source.isNull())
+			snapshots.append(source);
+	}
+	snapshotsValid = true;
+}
+
+/*
+ * Moves the finished tiles into the cache. Returns true if one of them was
+ * missing in the last frame.
+ */
+bool TileCache::collect()
+{
+	QList<TileJob*> jobs;
+	bool visible = false;
+
+	mutex.lock();
+	jobs.swap(finished);
+	mutex.unlock();
+
+	for (TileJob *job : jobs) {
+		if (job->generation == generation && !job->stale &&
+		    !job->image.isNull()) {
+			int cost = job->image.bytesPerLine() *
+				job->image.height() / 1024;
+			cache.insert(job->key, new QImage(job->image),
+				     TSMAX(cost, 1));
+			visible |= wanted.remove(job->key);
+		}
+		delete job;
+	}
+	return visible;
+}
+
+void TileCache::deliver()
+{
+	if (collect())
+		mParentPlot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+/* The mutex must be held when calling this */
+void TileCache::cancel_()
+{
+	generation++;
+	qDeleteAll(queue);
+	queue.clear();
+	pending.clear();
+}
+
+void TileCache::threadLoop()
+{
+	TileJob *job;
+	bool current;
+
+	mutex.lock();
+	while (true) {
+		while (queue.isEmpty() && !exiting)
+			workCond.wait(&mutex);
+		if (exiting)
+			break;
+		job = queue.takeFirst();
+		rendering.append(job);
+		running++;
+		mutex.unlock();
+
+		renderTile(job);
+
+		mutex.lock();
+		running--;
+		rendering.removeOne(job);
+		current = job->generation == generation && !job->stale;
+		if (current)
+			pending.remove(job->key);
+		finished.append(job);
+		doneCond.wakeAll();
+		if (current)
+			QMetaObject::invokeMethod(this, "deliver",
+						  Qt::QueuedConnection);
+	}
+	mutex.unlock();
+}
+
+void TileCache::renderTile(TileJob *job)
+{
+	const int size = qCeil(TILECACHE_SIZE * job->ratio);
+	double kbase, vbase;
+	QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+
+#ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
+	image.setDevicePixelRatio(job->ratio);
+#endif
+	image.fill(Qt::transparent);
+
+	/*
+	 * The tile pixel 0 is at the grid pixel x * TILECACHE_SIZE, which is at
+	 * the coordinate kbase.
+	 */
+	kbase = job->key.x * TILECACHE_SIZE / job->keyScale;
+	vbase = job->key.y * TILECACHE_SIZE / job->valueScale;
+	QCPRange krange = tileRange(job->key.x, job->keyScale);
+	QCPRange vrange = tileRange(job->key.y, job->valueScale);
+	AxisMap keyMap(krange, kbase, 0, job->keyScale, job->keyReversed);
+	AxisMap valueMap(vrange, vbase, 0, job->valueScale,
+			 job->valueReversed);
+
+	QCPPainter painter(&image);
+	for (const QSharedPointer<TileSource> &source : job->sources) {
+		painter.save();
+		source->drawTile(&painter, keyMap, valueMap);
+		painter.restore();
+	}
+	painter.end();
+	job->image = image;
+}
@@ -0,0 +1,224 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <QCache>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QSet>
+#include <QSharedPointer>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "ui/axismap.h"
+#include "ui/qcustomplot.h"
+#include "threads/workthread.h"
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+#define TILECACHE_HASH_T uint
+#else
+#define TILECACHE_HASH_T size_t
+#endif
+
+class TileCache;
+
+/*
+ * An immutable snapshot of what a plottable draws. It may only refer to data
+ * that doesn't change as long as the snapshot exists, because drawTile() is
+ * called from the worker threads of the TileCache.
+ */
+class TileSource {
+public:
+	virtual ~TileSource();
+	virtual void drawTile(QCPPainter *painter, const AxisMap &keyMap,
+			      const AxisMap &valueMap) const = 0;
+};
+
+/*
+ * A plottable that lets a TileCache draw it. While it's tiled, its draw()
+ * function should only draw what is not in the snapshot, such as the
+ * selection.
+ */
+class TilePlottable {
+	friend class TileCache;
+public:
+	TilePlottable();
+	virtual ~TilePlottable();
+	virtual QSharedPointer<TileSource> tileSource() const = 0;
+	virtual bool tileBand(QCPRange *band) const;
+	bool isTiled() const;
+protected:
+	void tileContentChanged();
+	static bool useAntialiasing(const QCustomPlot *plot, bool local,
+				    QCP::AntialiasedElement element);
+private:
+	TileCache *tileCache;
+};
+
+/*
+ * A layerable that draws the TilePlottables from square QImage tiles, which
+ * are rendered by worker threads. A tile is identified by the zoom level of
+ * both axes and by its position in a grid of TILECACHE_SIZE pixels, so when
+ * the plot is scrolled, most of the tiles can be reused, and only the tiles
+ * that come into view need to be rendered.
+ *
+ * Missing tiles are requested from the worker threads and in the meantime the
+ * tiles of the last complete frame are stretched over them. A tile that is
+ * delivered triggers a queued replot. The tiles next to the visible area are
+ * prefetched.
+ *
+ * The TileCache should be created before the plottables on the same layer, so
+ * that it's drawn where they would have been drawn.
+ */
+class TileCache : public QCPLayerable
+{
+	Q_OBJECT
+public:
+	TileCache(QCustomPlot *plot, QCPAxis *keyAxis, QCPAxis *valueAxis);
+	~TileCache();
+	void addSource(TilePlottable *source);
+	void removeSource(TilePlottable *source);
+	void clear();
+	void invalidate();
+protected:
+	void applyDefaultAntialiasingHint(QCPPainter *painter) const
+		Q_DECL_OVERRIDE;
+	void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
+	QRect clipRect() const Q_DECL_OVERRIDE;
+private slots:
+	void deliver();
+private:
+	class TileKey {
+	public:
+		bool operator==(const TileKey &other) const;
+		/* The zoom levels, see zoomLevel() */
+		qint64 keyLevel;
+		qint64 valueLevel;
+		/* The position in the grid of tiles */
+		qint64 x;
+		qint64 y;
+	};
+	friend TILECACHE_HASH_T qHash(const TileKey &key,
+				      TILECACHE_HASH_T seed);
+	class TileJob {
+	public:
+		TileKey key;
+		unsigned int generation;
+		/* Set if the tile was invalidated by invalidateBand() */
+		bool stale;
+		double keyScale;
+		double valueScale;
+		bool keyReversed;
+		bool valueReversed;
+		qreal ratio;
+		QList<QSharedPointer<TileSource>> sources;
+		QImage image;
+	};
+	/* How the grid of tiles of a zoom level is placed on the screen */
+	class Grid {
+	public:
+		qint64 keyLevel;
+		qint64 valueLevel;
+		double keyScale;
+		double valueScale;
+		/* The screen position of the grid pixel 0 */
+		double sx;
+		double sy;
+	};
+	Grid makeGrid(const AxisMap &keyMap, const AxisMap &valueMap) const;
+	static qint64 zoomLevel(double pixelsPerCoord);
+	static double levelScale(qint64 level, double pixelsPerCoord);
+	static QCPRange tileRange(qint64 pos, double scale);
+	QRect tileRect(const Grid &grid, qint64 x, qint64 y) const;
+	void request(const QList<TileKey> &keys, const Grid &grid,
+		     qreal ratio);
+	void waitFor(const QList<TileKey> &keys);
+	void drawFallback(QCPPainter *painter, const Grid &grid,
+			  const QRegion &missing);
+	void drawDirect(QCPPainter *painter);
+	void invalidateBand(const QCPRange &band);
+	void updateSnapshots();
+	bool collect();
+	void cancel_();
+	void threadLoop();
+	static void renderTile(TileJob *job);
+	QCPAxis *keyAxis;
+	QCPAxis *valueAxis;
+	QList<TilePlottable*> plottables;
+	QList<QSharedPointer<TileSource>> snapshots;
+	bool snapshotsValid;
+	QCache<TileKey, QImage> cache;
+	/* The tiles of the last frame that had no missing tiles */
+	Grid lastGrid;
+	QList<QPair<TileKey, QImage>> lastTiles;
+	/* The visible tiles that were missing in the last frame */
+	QSet<TileKey> wanted;
+	/* These are protected by the mutex */
+	QMutex mutex;
+	QWaitCondition workCond;
+	QWaitCondition doneCond;
+	QList<TileJob*> queue;
+	QList<TileJob*> rendering;
+	QList<TileJob*> finished;
+	QSet<TileKey> pending;
+	unsigned int generation;
+	int running;
+	bool exiting;
+	WorkThread<TileCache> *threads;
+	int nrThreads;
+};
+
+#endif /* TILECACHE_H */
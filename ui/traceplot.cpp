@@ -50,11 +50,136 @@
  *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <QTimer>
+
+#include "misc/qtcompat.h"
+#include "misc/traceshark.h"
 #include "ui/traceplot.h"
 
+/* The interval is clamped to this range, in ms */
+#define TRACEPLOT_MIN_FRAME_INTERVAL (4)
+#define TRACEPLOT_MAX_FRAME_INTERVAL (50)
+
 TracePlot::TracePlot(QWidget *parent):
-	QCustomPlot(parent)
-{}
+	QCustomPlot(parent), replotsHeld(false), replotWanted(false)
+{
+	qreal rate = QtCompat::refreshRate();
+
+	frameInterval = rate > 0 ? qRound(1000 / rate) : 16;
+	frameInterval = TSMAX(frameInterval, TRACEPLOT_MIN_FRAME_INTERVAL);
+	frameInterval = TSMIN(frameInterval, TRACEPLOT_MAX_FRAME_INTERVAL);
+
+	frameTimer = new QTimer(this);
+	frameTimer->setSingleShot(true);
+	tsconnect(frameTimer, timeout(), this, frameTimeout());
+	tsconnect(this, beforeReplot(), this, startFrame());
+	tsconnect(this, afterReplot(), this, endFrame());
+}
+
+/*
+ * Requests a replot that is done when the next frame is due. Multiple calls
+ * before that only cause one replot.
+ */
+void TracePlot::queueReplot()
+{
+	qint64 delay;
+
+	if (replotsHeld) {
+		replotWanted = true;
+		return;
+	}
+	if (mReplotQueued)
+		return;
+	mReplotQueued = true;
+	delay = frameClock.isValid() ?
+		frameInterval - frameClock.elapsed() : 0;
+	frameTimer->start((int) TSMAX(delay, (qint64) 0));
+}
+
+void TracePlot::frameTimeout()
+{
+	replot(rpRefreshHint);
+}
+
+/* Any replot makes a queued one unnecessary */
+void TracePlot::startFrame()
+{
+	frameTimer->stop();
+}
+
+void TracePlot::endFrame()
+{
+	frameClock.start();
+}
+
+/* The ranges of all axes, so that we can tell if an event changed them */
+void TracePlot::axisRanges(QVector<QCPRange> *ranges) const
+{
+	const QList<QCPAxisRect*> rects = axisRects();
+	int i, j;
+
+	ranges->resize(0);
+	for (i = 0; i < rects.size(); i++) {
+		const QList<QCPAxis*> axes = rects[i]->axes();
+		for (j = 0; j < axes.size(); j++)
+			ranges->append(axes[j]->range());
+	}
+}
+
+/*
+ * QCustomPlot queues a replot with a zero timer for every event that changes
+ * the ranges, so that a fast gesture gets more replots than there are frames.
+ * By pretending that a replot is already queued while the event is handled,
+ * we can queue a paced replot instead. Since those requests are then lost, we
+ * only queue the replot if the event changed a range, or if queueReplot() was
+ * called while the replots were held.
+ */
+void TracePlot::holdReplots(bool *queued, QVector<QCPRange> *ranges)
+{
+	*queued = mReplotQueued;
+	mReplotQueued = true;
+	replotsHeld = true;
+	replotWanted = false;
+	axisRanges(ranges);
+}
+
+void TracePlot::releaseReplots(bool queued, const QVector<QCPRange> &ranges)
+{
+	QVector<QCPRange> now;
+
+	mReplotQueued = queued;
+	replotsHeld = false;
+	if (queued)
+		return;
+	axisRanges(&now);
+	if (replotWanted || now != ranges)
+		queueReplot();
+}
+
+void TracePlot::mouseMoveEvent(QMouseEvent *event)
+{
+	QVector<QCPRange> ranges;
+	bool queued;
+
+	/* Without a button pressed, there is no dragging to replot */
+	if (event->buttons() == Qt::NoButton) {
+		QCustomPlot::mouseMoveEvent(event);
+		return;
+	}
+	holdReplots(&queued, &ranges);
+	QCustomPlot::mouseMoveEvent(event);
+	releaseReplots(queued, ranges);
+}
+
+void TracePlot::wheelEvent(QWheelEvent *event)
+{
+	QVector<QCPRange> ranges;
+	bool queued;
+
+	holdReplots(&queued, &ranges);
+	QCustomPlot::wheelEvent(event);
+	releaseReplots(queued, ranges);
+}
 
 QCPLayerable *TracePlot::getLayerableAt(const QPointF &pos, bool onlySelectable,
 					QVariant *selectionDetails)
@@ -53,8 +53,19 @@
 #ifndef TRACEPLOT_H
 #define TRACEPLOT_H
 
+#include <QElapsedTimer>
+#include <QVector>
 #include "ui/qcustomplot.h"
 
+class QTimer;
+
+/*
+ * The replots that are caused by the mouse and by queueReplot() are paced to
+ * the refresh rate of the screen. However many wheel or drag events arrive
+ * during a frame, they only cause one replot, which then shows the latest
+ * state. The expensive parts of the plot are drawn by the worker threads of
+ * the TileCache, so the GUI thread only needs to put together the frame.
+ */
 class TracePlot : public QCustomPlot
 {
 	Q_OBJECT
@@ -62,6 +73,24 @@ public:
 	TracePlot(QWidget *parent = 0);
 	QCPLayerable *getLayerableAt(const QPointF &pos, bool onlySelectable,
 				     QVariant *selectionDetails = 0);
+	void queueReplot();
+protected:
+	void mouseMoveEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
+	void wheelEvent(QWheelEvent *event) Q_DECL_OVERRIDE;
+private slots:
+	void frameTimeout();
+	void startFrame();
+	void endFrame();
+private:
+	void axisRanges(QVector<QCPRange> *ranges) const;
+	void holdReplots(bool *queued, QVector<QCPRange> *ranges);
+	void releaseReplots(bool queued, const QVector<QCPRange> &ranges);
+	QTimer *frameTimer;
+	QElapsedTimer frameClock;
+	int frameInterval;
+	/* Set while the replots are held, see holdReplots() */
+	bool replotsHeld;
+	bool replotWanted;
 };
 
 #endif /* TRACEPLOT_H */
@@ -68,6 +68,20 @@ void BitVector::clear()
 	nrElements = 0;
 }
 
+/* Make room for a total of nr elements without reallocating */
+void BitVector::reserve(unsigned int nr)
+{
+	unsigned int words = (nr + BITVECTOR_BITS_PER_WORD - 1) /
+		BITVECTOR_BITS_PER_WORD;
+
+	/* QVector::resize() would allocate more than we ask for */
+	if (words > nrWords) {
+		nrWords = words;
+		array.reserve(nrWords);
+		array.resize(nrWords);
+	}
+}
+
 void BitVector::softclear()
 {
 	array.clear();
@@ -69,6 +69,7 @@ public:
 	vtl_always_inline unsigned int size() const;
 	void clear();
 	void softclear();
+	void reserve(unsigned int nr);
 private:
 	static const unsigned int INCREASE_NR = 1024;
 	typedef unsigned int word_t;
@@ -117,6 +117,10 @@ extern "C" {
 #define attr_warn_unused_result \
 	__attribute__ ((warn_unused_result))
 
+/* The number of trailing zeros of x, x must not be zero */
+#define vtl_ctz64(x) __builtin_ctzll(x)
+#define vtl_popcount64(x) __builtin_popcountll(x)
+
 #else /* __GNUC__ not defined */
 
 #define likely(x)   (x)
@@ -127,6 +131,28 @@ extern "C" {
 
 #define attr_warn_unused_result
 
+static vtl_always_inline int vtl_ctz64(unsigned long long x)
+{
+	int n = 0;
+
+	while (!(x & 1)) {
+		x >>= 1;
+		n++;
+	}
+	return n;
+}
+
+static vtl_always_inline int vtl_popcount64(unsigned long long x)
+{
+	int n = 0;
+
+	while (x != 0) {
+		x &= x - 1;
+		n++;
+	}
+	return n;
+}
+
 #endif /* __GNUC__ */
 
 #define vtl_str(a) __vtl_str(a)
@@ -0,0 +1,270 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <QtGlobal>
+
+#include "vtl/minmaxpyramid.h"
+
+#define FANOUT MINMAXPYRAMID_FANOUT
+
+namespace vtl {
+
+/* These give build_() and query_() the same interface to both kinds of data */
+class DoubleSource {
+public:
+	DoubleSource(const QVector<double> &v): d(v.constData()) {}
+	vtl_always_inline double operator[](int i) const { return d[i]; }
+private:
+	const double *d;
+};
+
+class BitSource {
+public:
+	BitSource(const BitVector &v): b(v) {}
+	vtl_always_inline double operator[](int i) const { return b.read(i); }
+private:
+	const BitVector &b;
+};
+
+MinMaxPyramid::MinMaxPyramid():
+	values(nullptr), bits(nullptr), nrValues(0)
+{}
+
+MinMaxPyramid::MinMaxPyramid(const MinMaxPyramid &/*other*/):
+	values(nullptr), bits(nullptr), nrValues(0)
+{}
+
+MinMaxPyramid &MinMaxPyramid::operator=(const MinMaxPyramid &/*other*/)
+{
+	clear();
+	return *this;
+}
+
+void MinMaxPyramid::clear()
+{
+	levels.clear();
+	values = nullptr;
+	bits = nullptr;
+	nrValues = 0;
+}
+
+void MinMaxPyramid::build(const QVector<double> &v)
+{
+	levels.clear();
+	values = &v;
+	bits = nullptr;
+	nrValues = v.size();
+	build_(DoubleSource(v));
+}
+
+void MinMaxPyramid::build(const BitVector &v)
+{
+	levels.clear();
+	values = nullptr;
+	bits = &v;
+	nrValues = (int) v.size();
+	build_(BitSource(v));
+}
+
+/*
+ * Makes this a copy of other that refers to v, which must be a copy of the
+ * vector of other. The nodes are implicitly shared with other. If other is
+ * not valid for v, then this is left empty.
+ */
+void MinMaxPyramid::share(const MinMaxPyramid &other, const QVector<double> &v)
+{
+	clear();
+	if (other.values == nullptr || !other.isValid() ||
+	    v.size() != other.nrValues)
+		return;
+	levels = other.levels;
+	values = &v;
+	nrValues = other.nrValues;
+}
+
+void MinMaxPyramid::share(const MinMaxPyramid &other, const BitVector &v)
+{
+	clear();
+	if (other.bits == nullptr || !other.isValid() ||
+	    (int) v.size() != other.nrValues)
+		return;
+	levels = other.levels;
+	bits = &v;
+	nrValues = other.nrValues;
+}
+
+template<typename Source>
+void MinMaxPyramid::build_(const Source &d)
+{
+	int i, j, s, e;
+
+	/* Short vectors are always scanned by query() */
+	if (nrValues < MINMAXPYRAMID_MIN_SIZE)
+		return;
+
+	QVector<Node> level((nrValues + FANOUT - 1) / FANOUT);
+	for (j = 0; j < level.size(); j++) {
+		Node &node = level[j];
+		s = j * FANOUT;
+		e = qMin(s + FANOUT, nrValues);
+		node.min = d[s];
+		node.max = d[s];
+		node.changes = (s > 0 && d[s] != d[s - 1]) ? 1 : 0;
+		for (i = s + 1; i < e; i++) {
+			node.min = qMin(node.min, d[i]);
+			node.max = qMax(node.max, d[i]);
+			node.changes += d[i] != d[i - 1];
+		}
+	}
+	levels.append(level);
+
+	while (level.size() > FANOUT) {
+		const QVector<Node> below = level;
+		level.resize((below.size() + FANOUT - 1) / FANOUT);
+		for (j = 0; j < level.size(); j++) {
+			Node &node = level[j];
+			s = j * FANOUT;
+			e = qMin(s + FANOUT, below.size());
+			node = below[s];
+			for (i = s + 1; i < e; i++) {
+				node.min = qMin(node.min, below[i].min);
+				node.max = qMax(node.max, below[i].max);
+				node.changes += below[i].changes;
+			}
+		}
+		levels.append(level);
+	}
+}
+
+template<typename Source>
+void MinMaxPyramid::scanValues(const Source &d, int from, int to,
+			       double &min, double &max, int &changes)
+{
+	int i;
+
+	for (i = from; i < to; i++) {
+		if (d[i] < min)
+			min = d[i];
+		else if (d[i] > max)
+			max = d[i];
+		if (i > 0 && d[i] != d[i - 1])
+			changes++;
+	}
+}
+
+/*
+ * Finds the minimum and the maximum of the values in the range [from, to) and
+ * the number of values in the range that differ from their predecessor, not
+ * counting the first value of the range. The range must not be empty.
+ */
+void MinMaxPyramid::query(int from, int to, double &min, double &max,
+			  int &changes) const
+{
+	if (values != nullptr)
+		query_(DoubleSource(*values), from, to, min, max, changes);
+	else
+		query_(BitSource(*bits), from, to, min, max, changes);
+}
+
+template<typename Source>
+void MinMaxPyramid::query_(const Source &d, int from, int to, double &min,
+			   double &max, int &changes) const
+{
+	int lo, hi, a, b, l, i;
+
+	min = d[from];
+	max = d[from];
+	changes = 0;
+
+	lo = from;
+	hi = to;
+	a = (lo + FANOUT - 1) / FANOUT * FANOUT;
+	b = hi / FANOUT * FANOUT;
+	if (levels.isEmpty() || a >= b) {
+		scanValues(d, lo, hi, min, max, changes);
+		goto out;
+	}
+	scanValues(d, lo, a, min, max, changes);
+	scanValues(d, b, hi, min, max, changes);
+	lo = a / FANOUT;
+	hi = b / FANOUT;
+
+	for (l = 0; l < levels.size(); l++) {
+		const Node *nodes = levels[l].constData();
+		a = (lo + FANOUT - 1) / FANOUT * FANOUT;
+		b = hi / FANOUT * FANOUT;
+		if (l == levels.size() - 1 || a >= b) {
+			a = hi;
+			b = hi;
+		}
+		for (i = lo; i < a; i++) {
+			min = qMin(min, nodes[i].min);
+			max = qMax(max, nodes[i].max);
+			changes += nodes[i].changes;
+		}
+		for (i = b; i < hi; i++) {
+			min = qMin(min, nodes[i].min);
+			max = qMax(max, nodes[i].max);
+			changes += nodes[i].changes;
+		}
+		if (a >= b)
+			break;
+		lo = a / FANOUT;
+		hi = b / FANOUT;
+	}
+out:
+	/* The change into the first value is outside of the range */
+	if (from > 0 && d[from] != d[from - 1])
+		changes--;
+}
+
+}
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _VTL_MINMAXPYRAMID_H
+#define _VTL_MINMAXPYRAMID_H
+
+#include <QVector>
+
+#include "vtl/bitvector.h"
+#include "vtl/compiler.h"
+
+namespace vtl {
+
+/* The number of nodes or values that are aggregated by a node */
+#define MINMAXPYRAMID_FANOUT (8)
+/* Vectors shorter than this are not worth a pyramid */
+#define MINMAXPYRAMID_MIN_SIZE (4 * MINMAXPYRAMID_FANOUT)
+
+/*
+ * A level of detail pyramid over a vector of values. Each node of the lowest
+ * level holds the minimum, the maximum and the number of value changes of
+ * MINMAXPYRAMID_FANOUT consecutive values, and each node of the higher levels
+ * aggregates MINMAXPYRAMID_FANOUT nodes of the level below. This makes it
+ * possible to find the minimum and maximum of any index range in
+ * O(log(n)) time.
+ *
+ * The pyramid keeps a pointer to the vector, so the vector must not be moved
+ * or destroyed while the pyramid is used. If the vector has changed size since
+ * the pyramid was built, then isValid() returns false. A copy of a pyramid is
+ * empty, since it would otherwise refer to the vector of the original, but
+ * share() can be used to copy it together with its vector.
+ *
+ * The pyramid can also be built from a BitVector. Since the minimum and the
+ * maximum are preserved by any increasing linear transformation, a pyramid of
+ * unscaled data stays valid when the data is drawn with a different scale and
+ * offset.
+ */
+class MinMaxPyramid {
+public:
+	MinMaxPyramid();
+	MinMaxPyramid(const MinMaxPyramid &other);
+	MinMaxPyramid &operator=(const MinMaxPyramid &other);
+	void build(const QVector<double> &v);
+	void build(const BitVector &v);
+	void share(const MinMaxPyramid &other, const QVector<double> &v);
+	void share(const MinMaxPyramid &other, const BitVector &v);
+	void clear();
+	vtl_always_inline bool isValid() const;
+	vtl_always_inline int size() const;
+	void query(int from, int to, double &min, double &max,
+		   int &changes) const;
+private:
+	class Node {
+	public:
+		double min;
+		double max;
+		/* Nr of values that differ from their predecessor */
+		int changes;
+	};
+	template<typename Source>
+	void build_(const Source &src);
+	template<typename Source>
+	void query_(const Source &src, int from, int to, double &min,
+		    double &max, int &changes) const;
+	template<typename Source>
+	static void scanValues(const Source &src, int from, int to,
+			       double &min, double &max, int &changes);
+	const QVector<double> *values;
+	const BitVector *bits;
+	QVector<QVector<Node>> levels;
+	int nrValues;
+};
+
+vtl_always_inline bool MinMaxPyramid::isValid() const
+{
+	if (values != nullptr)
+		return values->size() == nrValues;
+	return bits != nullptr && (int) bits->size() == nrValues;
+}
+
+vtl_always_inline int MinMaxPyramid::size() const
+{
+	return nrValues;
+}
+
+}
+
+#endif /* _VTL_MINMAXPYRAMID_H */
@@ -0,0 +1,575 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VTL_PIDMAP_H
+#define VTL_PIDMAP_H
+
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "vtl/compiler.h"
+
+namespace vtl {
+
+/*
+ * PidMap is a map from pid to a value, intended for the task maps that are
+ * accessed for every scheduling event. Pids in the range
+ * [0, VTL_PIDMAP_DIRECT_MAX) are looked up in a two level direct mapped table,
+ * which covers the whole default pid range of Linux (PID_MAX_LIMIT). The
+ * values are stored in the leaf tables, which are allocated when the first pid
+ * in their range is inserted. Only the pages of a leaf that hold values are
+ * ever touched. All other keys, e.g. the negative pids that some kernels use
+ * for ghost processes, are kept in an array that is indexed by a small open
+ * addressing hash table.
+ *
+ * The values never move, so references to them stay valid until clear() is
+ * called. Iteration is in ascending pid order for the direct range, followed
+ * by the other keys in the order that they were inserted. It is allowed to
+ * insert while iterating.
+ */
+
+#define VTL_PIDMAP_LEAF_SHIFT (10)
+#define VTL_PIDMAP_LEAF_SIZE (1 << VTL_PIDMAP_LEAF_SHIFT)
+#define VTL_PIDMAP_LEAF_MASK (VTL_PIDMAP_LEAF_SIZE - 1)
+#define VTL_PIDMAP_NR_LEAVES (4096)
+#define VTL_PIDMAP_DIRECT_MAX (VTL_PIDMAP_NR_LEAVES * VTL_PIDMAP_LEAF_SIZE)
+#define VTL_PIDMAP_HASH_MINBITS (4)
+
+template <class U>
+class PidMapNode {
+public:
+	int key;
+	U value;
+};
+
+/*
+ * The nodes of a leaf are constructed when they are inserted, the used bitmap
+ * tells which ones that are.
+ */
+template <class U>
+class PidMapLeaf {
+public:
+	PidMapLeaf();
+	vtl_always_inline bool isUsed(int i) const;
+	vtl_always_inline void setUsed(int i);
+	vtl_always_inline PidMapNode<U> *node(int i);
+	uint64_t used[VTL_PIDMAP_LEAF_SIZE / 64];
+private:
+	alignas(PidMapNode<U>)
+	unsigned char storage[VTL_PIDMAP_LEAF_SIZE * sizeof(PidMapNode<U>)];
+};
+
+template <class U>
+class PidMap
+{
+public:
+	class iterator {
+		friend class PidMap<U>;
+	public:
+		iterator();
+		vtl_always_inline int key() const;
+		vtl_always_inline U &value() const;
+		vtl_always_inline bool atEnd() const;
+		vtl_always_inline void next();
+		vtl_always_inline iterator &operator++();
+		vtl_always_inline iterator operator++(int);
+		vtl_always_inline bool operator!=(const iterator &other) const;
+		vtl_always_inline bool operator==(const iterator &other) const;
+	private:
+		vtl_always_inline iterator(const PidMap<U> *m, int64_t i,
+					   PidMapNode<U> *p);
+		const PidMap<U> *map;
+		/*
+		 * The key in the direct range, or VTL_PIDMAP_DIRECT_MAX plus
+		 * the index in the array of other keys.
+		 */
+		int64_t idx;
+		PidMapNode<U> *pos;
+	};
+
+	PidMap();
+	~PidMap();
+	vtl_always_inline void insert(int key, const U &value);
+	vtl_always_inline U &findValue(int key, bool &newEntry);
+	vtl_always_inline U value(int key, const U &defaultValue = U()) const;
+	vtl_always_inline bool contains(int key) const;
+	vtl_always_inline bool isEmpty() const;
+	vtl_always_inline int size() const;
+	vtl_always_inline U &operator[](int key);
+	vtl_always_inline iterator find(int key) const;
+	void clear();
+	vtl_always_inline iterator begin() const;
+	vtl_always_inline iterator end() const;
+private:
+	PidMap(const PidMap<U> &) = delete;
+	PidMap<U> &operator=(const PidMap<U> &) = delete;
+	vtl_always_inline static bool isDirect(int key);
+	vtl_always_inline unsigned int hashKey(int key) const;
+	vtl_always_inline PidMapNode<U> *findDirect(int key) const;
+	vtl_always_inline int findOther(int key) const;
+	int &hashSlot(int key);
+	void growHash();
+	int addOther(int key);
+	PidMapNode<U> *nodeFrom(int64_t &idx) const;
+	PidMapLeaf<U> **leaves;
+	/* The largest key in the direct table, or -1 if it is empty */
+	int maxDirect;
+	/* The keys that are not direct, the hash table has indices to these */
+	PidMapNode<U> **others;
+	int nrOthers;
+	int othersSize;
+	/* The slots are -1 when empty */
+	int *hash;
+	unsigned int hashBits;
+	int size_;
+};
+
+template <class U>
+PidMapLeaf<U>::PidMapLeaf()
+{
+	memset(used, 0, sizeof(used));
+}
+
+template <class U>
+vtl_always_inline bool PidMapLeaf<U>::isUsed(int i) const
+{
+	return (used[i >> 6] & (UINT64_C(1) << (i & 63))) != 0;
+}
+
+template <class U>
+vtl_always_inline void PidMapLeaf<U>::setUsed(int i)
+{
+	used[i >> 6] |= UINT64_C(1) << (i & 63);
+}
+
+template <class U>
+vtl_always_inline PidMapNode<U> *PidMapLeaf<U>::node(int i)
+{
+	return reinterpret_cast<PidMapNode<U> *>(storage) + i;
+}
+
+template <class U>
+PidMap<U>::iterator::iterator():
+	map(nullptr), idx(0), pos(nullptr)
+{}
+
+template <class U>
+vtl_always_inline PidMap<U>::iterator::iterator(const PidMap<U> *m,
+						 int64_t i,
+						 PidMapNode<U> *p):
+	map(m), idx(i), pos(p)
+{}
+
+template <class U>
+vtl_always_inline int PidMap<U>::iterator::key() const
+{
+	return pos->key;
+}
+
+template <class U>
+vtl_always_inline U &PidMap<U>::iterator::value() const
+{
+	return pos->value;
+}
+
+template <class U>
+vtl_always_inline bool PidMap<U>::iterator::atEnd() const
+{
+	return pos == nullptr;
+}
+
+template <class U>
+vtl_always_inline void PidMap<U>::iterator::next()
+{
+	idx++;
+	pos = map->nodeFrom(idx);
+}
+
+template <class U>
+vtl_always_inline typename PidMap<U>::iterator
+	&PidMap<U>::iterator::operator++()
+{
+	next();
+	return *this;
+}
+
+template <class U>
+vtl_always_inline typename PidMap<U>::iterator
+	PidMap<U>::iterator::operator++(int)
+{
+	iterator prev = *this;
+	next();
+	return prev;
+}
+
+template <class U>
+vtl_always_inline bool
+	PidMap<U>::iterator::operator!=(const iterator &other) const
+{
+	return pos != other.pos;
+}
+
+template <class U>
+vtl_always_inline bool
+	PidMap<U>::iterator::operator==(const iterator &other) const
+{
+	return pos == other.pos;
+}
+
+template <class U>
+PidMap<U>::PidMap():
+	leaves(nullptr), maxDirect(-1), others(nullptr), nrOthers(0),
+	othersSize(0), hash(nullptr), hashBits(0), size_(0)
+{}
+
+template <class U>
+PidMap<U>::~PidMap()
+{
+	clear();
+}
+
+template <class U>
+vtl_always_inline bool PidMap<U>::isDirect(int key)
+{
+	return key >= 0 && key < VTL_PIDMAP_DIRECT_MAX;
+}
+
+/* Fibonacci hashing, the high bits of the product are the best mixed */
+template <class U>
+vtl_always_inline unsigned int PidMap<U>::hashKey(int key) const
+{
+	return (((uint32_t) key) * UINT32_C(2654435769)) >> (32 - hashBits);
+}
+
+template <class U>
+vtl_always_inline PidMapNode<U> *PidMap<U>::findDirect(int key) const
+{
+	PidMapLeaf<U> *leaf;
+	int i;
+
+	if (leaves == nullptr)
+		return nullptr;
+	leaf = leaves[key >> VTL_PIDMAP_LEAF_SHIFT];
+	i = key & VTL_PIDMAP_LEAF_MASK;
+	if (leaf == nullptr || !leaf->isUsed(i))
+		return nullptr;
+	return leaf->node(i);
+}
+
+/* Returns the index of the key in others, or -1 */
+template <class U>
+vtl_always_inline int PidMap<U>::findOther(int key) const
+{
+	unsigned int mask;
+	unsigned int i;
+
+	if (hash == nullptr)
+		return -1;
+	mask = (1U << hashBits) - 1;
+	i = hashKey(key);
+	while (hash[i] >= 0) {
+		if (others[hash[i]]->key == key)
+			return hash[i];
+		i = (i + 1) & mask;
+	}
+	return -1;
+}
+
+template <class U>
+int &PidMap<U>::hashSlot(int key)
+{
+	unsigned int mask;
+	unsigned int i;
+
+	/* Keep the load factor at or below 1/2 */
+	if (hash == nullptr || ((uint64_t) nrOthers + 1) * 2 >
+	    (UINT64_C(1) << hashBits))
+		growHash();
+
+	mask = (1U << hashBits) - 1;
+	i = hashKey(key);
+	while (hash[i] >= 0) {
+		if (others[hash[i]]->key == key)
+			break;
+		i = (i + 1) & mask;
+	}
+	return hash[i];
+}
+
+template <class U>
+void PidMap<U>::growHash()
+{
+	unsigned int size, mask;
+	unsigned int i;
+	int j;
+
+	free(hash);
+	hashBits = hashBits == 0 ? VTL_PIDMAP_HASH_MINBITS : hashBits + 1;
+	size = 1U << hashBits;
+	mask = size - 1;
+	hash = (int *) malloc(size * sizeof(int));
+	if (hash == nullptr)
+		throw std::bad_alloc();
+	for (i = 0; i < size; i++)
+		hash[i] = -1;
+
+	for (j = 0; j < nrOthers; j++) {
+		i = hashKey(others[j]->key);
+		while (hash[i] >= 0)
+			i = (i + 1) & mask;
+		hash[i] = j;
+	}
+}
+
+/* Returns the index of the new node in others */
+template <class U>
+int PidMap<U>::addOther(int key)
+{
+	PidMapNode<U> **newOthers;
+	int newSize;
+
+	if (nrOthers == othersSize) {
+		newSize = othersSize == 0 ? 16 : othersSize * 2;
+		newOthers = (PidMapNode<U> **)
+			realloc(others, newSize * sizeof(PidMapNode<U> *));
+		if (newOthers == nullptr)
+			throw std::bad_alloc();
+		others = newOthers;
+		othersSize = newSize;
+	}
+	others[nrOthers] = new PidMapNode<U>();
+	others[nrOthers]->key = key;
+	return nrOthers++;
+}
+
+template <class U>
+vtl_always_inline U &PidMap<U>::findValue(int key, bool &newEntry)
+{
+	PidMapLeaf<U> *leaf;
+	PidMapNode<U> *node;
+	int i;
+
+	if (!isDirect(key)) {
+		int &slot = hashSlot(key);
+		newEntry = slot < 0;
+		if (newEntry) {
+			slot = addOther(key);
+			size_++;
+		}
+		return others[slot]->value;
+	}
+
+	if (leaves == nullptr) {
+		leaves = (PidMapLeaf<U> **)
+			calloc(VTL_PIDMAP_NR_LEAVES, sizeof(PidMapLeaf<U> *));
+		if (leaves == nullptr)
+			throw std::bad_alloc();
+	}
+	PidMapLeaf<U> *&slot = leaves[key >> VTL_PIDMAP_LEAF_SHIFT];
+	if (slot == nullptr)
+		slot = new PidMapLeaf<U>;
+	leaf = slot;
+	i = key & VTL_PIDMAP_LEAF_MASK;
+	node = leaf->node(i);
+	newEntry = !leaf->isUsed(i);
+	if (newEntry) {
+		new (node) PidMapNode<U>();
+		node->key = key;
+		leaf->setUsed(i);
+		size_++;
+		if (key > maxDirect)
+			maxDirect = key;
+	}
+	return node->value;
+}
+
+template <class U>
+vtl_always_inline U &PidMap<U>::operator[](int key)
+{
+	bool newEntry;
+
+	return findValue(key, newEntry);
+}
+
+template <class U>
+vtl_always_inline void PidMap<U>::insert(int key, const U &value)
+{
+	(*this)[key] = value;
+}
+
+template <class U>
+vtl_always_inline U PidMap<U>::value(int key, const U &defaultValue) const
+{
+	iterator iter = find(key);
+
+	if (iter.atEnd())
+		return defaultValue;
+	return iter.value();
+}
+
+template <class U>
+vtl_always_inline bool PidMap<U>::contains(int key) const
+{
+	return !find(key).atEnd();
+}
+
+template <class U>
+vtl_always_inline bool PidMap<U>::isEmpty() const
+{
+	return size_ == 0;
+}
+
+template <class U>
+vtl_always_inline int PidMap<U>::size() const
+{
+	return size_;
+}
+
+template <class U>
+vtl_always_inline typename PidMap<U>::iterator PidMap<U>::find(int key) const
+{
+	int i;
+
+	if (isDirect(key))
+		return iterator(this, key, findDirect(key));
+	i = findOther(key);
+	if (i < 0)
+		return end();
+	return iterator(this, (int64_t) VTL_PIDMAP_DIRECT_MAX + i, others[i]);
+}
+
+template <class U>
+vtl_always_inline typename PidMap<U>::iterator PidMap<U>::begin() const
+{
+	int64_t idx = 0;
+	PidMapNode<U> *node = nodeFrom(idx);
+
+	return iterator(this, idx, node);
+}
+
+template <class U>
+vtl_always_inline typename PidMap<U>::iterator PidMap<U>::end() const
+{
+	return iterator(this, INT64_MAX, nullptr);
+}
+
+/*
+ * Returns the first node at or after the position idx, see iterator::idx,
+ * and updates idx to its position. The used bitmaps of the leaves let us skip
+ * 64 empty slots at a time.
+ */
+template <class U>
+PidMapNode<U> *PidMap<U>::nodeFrom(int64_t &idx) const
+{
+	PidMapLeaf<U> *leaf;
+	uint64_t word;
+	int i;
+
+	while (idx <= maxDirect) {
+		leaf = leaves[idx >> VTL_PIDMAP_LEAF_SHIFT];
+		if (leaf == nullptr) {
+			idx = (idx | VTL_PIDMAP_LEAF_MASK) + 1;
+			continue;
+		}
+		i = idx & VTL_PIDMAP_LEAF_MASK;
+		word = leaf->used[i >> 6] >> (i & 63);
+		if (word != 0) {
+			idx += vtl_ctz64(word);
+			return leaf->node(idx & VTL_PIDMAP_LEAF_MASK);
+		}
+		idx = (idx | 63) + 1;
+	}
+	if (idx < VTL_PIDMAP_DIRECT_MAX)
+		idx = VTL_PIDMAP_DIRECT_MAX;
+	if (idx - VTL_PIDMAP_DIRECT_MAX < nrOthers)
+		return others[idx - VTL_PIDMAP_DIRECT_MAX];
+	return nullptr;
+}
+
+template <class U>
+void PidMap<U>::clear()
+{
+	int i, j;
+
+	if (leaves != nullptr) {
+		for (i = 0; i < VTL_PIDMAP_NR_LEAVES; i++) {
+			PidMapLeaf<U> *leaf = leaves[i];
+			if (leaf == nullptr)
+				continue;
+			for (j = 0; j < VTL_PIDMAP_LEAF_SIZE; j++) {
+				if (leaf->isUsed(j))
+					leaf->node(j)->~PidMapNode<U>();
+			}
+			delete leaf;
+		}
+		free(leaves);
+		leaves = nullptr;
+	}
+	for (i = 0; i < nrOthers; i++)
+		delete others[i];
+	free(others);
+	others = nullptr;
+	nrOthers = 0;
+	othersSize = 0;
+	free(hash);
+	hash = nullptr;
+	hashBits = 0;
+	maxDirect = -1;
+	size_ = 0;
+}
+
+}
+
+#endif /* VTL_PIDMAP_H */
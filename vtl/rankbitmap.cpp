@@ -0,0 +1,337 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <utility>
+
+#include "vtl/rankbitmap.h"
+
+namespace vtl {
+
+RankBitmapChunk::RankBitmapChunk():
+	type(CHUNK_EMPTY), count(0)
+{}
+
+/*
+ * Sets the chunk from RANKBITMAP_CHUNK_WORDS words and chooses the
+ * representation that fits the number of set bits.
+ */
+void RankBitmapChunk::set(const uint64_t *w)
+{
+	uint64_t m;
+	int i, n;
+
+	count = 0;
+	for (i = 0; i < RANKBITMAP_CHUNK_WORDS; i++)
+		count += vtl_popcount64(w[i]);
+
+	QVector<uint16_t>().swap(array);
+	QVector<uint64_t>().swap(words);
+	QVector<uint16_t>().swap(groupRanks);
+
+	if (count == 0) {
+		type = CHUNK_EMPTY;
+		return;
+	}
+	if (count == RANKBITMAP_CHUNK_SIZE) {
+		type = CHUNK_FULL;
+		return;
+	}
+	if (count <= RANKBITMAP_ARRAY_MAX) {
+		type = CHUNK_ARRAY;
+		array.resize(count);
+		n = 0;
+		for (i = 0; i < RANKBITMAP_CHUNK_WORDS; i++) {
+			for (m = w[i]; m != 0; m &= m - 1)
+				array[n++] = (uint16_t) (i * 64 + vtl_ctz64(m));
+		}
+		return;
+	}
+
+	type = CHUNK_BITS;
+	words.resize(RANKBITMAP_CHUNK_WORDS);
+	groupRanks.resize(RANKBITMAP_NR_GROUPS);
+	n = 0;
+	for (i = 0; i < RANKBITMAP_CHUNK_WORDS; i++) {
+		if (i % RANKBITMAP_GROUP_WORDS == 0)
+			groupRanks[i / RANKBITMAP_GROUP_WORDS] = (uint16_t) n;
+		words[i] = w[i];
+		n += vtl_popcount64(w[i]);
+	}
+}
+
+void RankBitmapChunk::get(uint64_t *w) const
+{
+	int i;
+
+	for (i = 0; i < RANKBITMAP_CHUNK_WORDS; i++) {
+		switch (type) {
+		case CHUNK_FULL:
+			w[i] = ~UINT64_C(0);
+			break;
+		case CHUNK_BITS:
+			w[i] = words[i];
+			break;
+		default:
+			w[i] = 0;
+			break;
+		}
+	}
+
+	if (type != CHUNK_ARRAY)
+		return;
+	for (i = 0; i < array.size(); i++)
+		w[array[i] / 64] |= UINT64_C(1) << (array[i] % 64);
+}
+
+/* Returns the number of set bits before pos */
+int RankBitmapChunk::rank(int pos) const
+{
+	int low, high, mid;
+	int i, g, r;
+
+	switch (type) {
+	case CHUNK_EMPTY:
+		return 0;
+	case CHUNK_FULL:
+		return pos;
+	case CHUNK_ARRAY:
+		low = 0;
+		high = array.size();
+		while (low < high) {
+			mid = low + (high - low) / 2;
+			if (array[mid] < pos)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		return low;
+	case CHUNK_BITS:
+	default:
+		break;
+	}
+
+	g = pos / 64 / RANKBITMAP_GROUP_WORDS;
+	r = groupRanks[g];
+	for (i = g * RANKBITMAP_GROUP_WORDS; i < pos / 64; i++)
+		r += vtl_popcount64(words[i]);
+	if (pos % 64 != 0)
+		r += vtl_popcount64(words[pos / 64] &
+				    ((UINT64_C(1) << (pos % 64)) - 1));
+	return r;
+}
+
+/* Returns the position of set bit n, n must be less than count */
+int RankBitmapChunk::select(int n) const
+{
+	int low, high, mid;
+	int i, c;
+	uint64_t m;
+
+	switch (type) {
+	case CHUNK_FULL:
+		return n;
+	case CHUNK_ARRAY:
+		return array[n];
+	case CHUNK_EMPTY:
+		return -1;
+	case CHUNK_BITS:
+	default:
+		break;
+	}
+
+	/* Find the last group that doesn't start after bit n */
+	low = 0;
+	high = RANKBITMAP_NR_GROUPS;
+	while (high - low > 1) {
+		mid = low + (high - low) / 2;
+		if (groupRanks[mid] <= n)
+			low = mid;
+		else
+			high = mid;
+	}
+
+	n -= groupRanks[low];
+	for (i = low * RANKBITMAP_GROUP_WORDS; i < RANKBITMAP_CHUNK_WORDS; i++) {
+		c = vtl_popcount64(words[i]);
+		if (n < c)
+			break;
+		n -= c;
+	}
+
+	for (m = words[i]; n > 0; n--)
+		m &= m - 1;
+	return i * 64 + vtl_ctz64(m);
+}
+
+RankBitmap::RankBitmap():
+	chunkData(nullptr), nrBits(0), nrSet(0)
+{}
+
+/*
+ * The copy gets its own array of chunks because setChunk() writes through
+ * chunkData, which doesn't detach the chunks from the other bitmap. The chunks
+ * themselves can be shared because RankBitmapChunk::set() replaces the
+ * vectors instead of writing into them.
+ */
+RankBitmap::RankBitmap(const RankBitmap &other):
+	chunks(other.chunks), chunkRanks(other.chunkRanks),
+	chunkData(chunks.isEmpty() ? nullptr : chunks.data()),
+	nrBits(other.nrBits), nrSet(other.nrSet)
+{}
+
+RankBitmap &RankBitmap::operator=(const RankBitmap &other)
+{
+	if (this == &other)
+		return *this;
+	chunks = other.chunks;
+	chunkRanks = other.chunkRanks;
+	chunkData = chunks.isEmpty() ? nullptr : chunks.data();
+	nrBits = other.nrBits;
+	nrSet = other.nrSet;
+	return *this;
+}
+
+void RankBitmap::clear()
+{
+	QVector<RankBitmapChunk>().swap(chunks);
+	QVector<int64_t>().swap(chunkRanks);
+	chunkData = nullptr;
+	nrBits = 0;
+	nrSet = 0;
+}
+
+void RankBitmap::swap(RankBitmap &other)
+{
+	chunks.swap(other.chunks);
+	chunkRanks.swap(other.chunkRanks);
+	std::swap(chunkData, other.chunkData);
+	std::swap(nrBits, other.nrBits);
+	std::swap(nrSet, other.nrSet);
+}
+
+/* Makes the bitmap nr bits long with all bits cleared */
+void RankBitmap::resize(int64_t nr)
+{
+	int n = (int) ((nr + RANKBITMAP_CHUNK_SIZE - 1) >>
+		       RANKBITMAP_CHUNK_SHIFT);
+
+	clear();
+	chunks.resize(n);
+	chunkRanks.fill(0, n + 1);
+	chunkData = chunks.data();
+	nrBits = nr;
+}
+
+/*
+ * The words must have RANKBITMAP_CHUNK_WORDS elements. For the last chunk, the
+ * bits that are beyond the size of the bitmap must be cleared.
+ */
+void RankBitmap::setChunk(int c, const uint64_t *words)
+{
+	chunkData[c].set(words);
+}
+
+void RankBitmap::getChunk(int c, uint64_t *words) const
+{
+	chunks[c].get(words);
+}
+
+void RankBitmap::updateRanks()
+{
+	int c;
+	int s = chunks.size();
+
+	nrSet = 0;
+	for (c = 0; c < s; c++) {
+		chunkRanks[c] = nrSet;
+		nrSet += chunks[c].count;
+	}
+	chunkRanks[s] = nrSet;
+}
+
+/* Returns the number of set bits before idx */
+int64_t RankBitmap::rank(int64_t idx) const
+{
+	int c;
+
+	if (idx <= 0)
+		return 0;
+	if (idx >= nrBits)
+		return nrSet;
+	c = (int) (idx >> RANKBITMAP_CHUNK_SHIFT);
+	return chunkRanks[c] +
+		chunks[c].rank((int) (idx & (RANKBITMAP_CHUNK_SIZE - 1)));
+}
+
+/* Returns the index of set bit n, or -1 if there are not that many bits set */
+int64_t RankBitmap::select(int64_t n) const
+{
+	int low, high, mid;
+
+	if (n < 0 || n >= nrSet)
+		return -1;
+
+	/* Find the first chunk that ends after bit n */
+	low = 0;
+	high = chunks.size() - 1;
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (chunkRanks[mid + 1] <= n)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return ((int64_t) low << RANKBITMAP_CHUNK_SHIFT) +
+		chunks[low].select((int) (n - chunkRanks[low]));
+}
+
+}
@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _VTL_RANKBITMAP_H
+#define _VTL_RANKBITMAP_H
+
+#include <QVector>
+#include <cstdint>
+
+#include "vtl/compiler.h"
+
+namespace vtl {
+
+#define RANKBITMAP_CHUNK_SHIFT (16)
+#define RANKBITMAP_CHUNK_SIZE (1 << RANKBITMAP_CHUNK_SHIFT)
+#define RANKBITMAP_CHUNK_WORDS (RANKBITMAP_CHUNK_SIZE / 64)
+/* Chunks with at most this many bits set are stored as arrays */
+#define RANKBITMAP_ARRAY_MAX (4096)
+/* The number of words that share an entry in groupRanks */
+#define RANKBITMAP_GROUP_WORDS (8)
+#define RANKBITMAP_NR_GROUPS (RANKBITMAP_CHUNK_WORDS / RANKBITMAP_GROUP_WORDS)
+
+/*
+ * One chunk of RANKBITMAP_CHUNK_SIZE bits of a RankBitmap. Empty and full
+ * chunks take no memory, sparse chunks are stored as a sorted array of the set
+ * bits and dense chunks as a plain bitmap, with the number of set bits before
+ * every group of RANKBITMAP_GROUP_WORDS words, so that select() doesn't need
+ * to count the bits of the whole chunk.
+ */
+class RankBitmapChunk {
+public:
+	typedef enum : int {
+		CHUNK_EMPTY = 0,
+		CHUNK_ARRAY,
+		CHUNK_BITS,
+		CHUNK_FULL
+	} type_t;
+	RankBitmapChunk();
+	void set(const uint64_t *w);
+	void get(uint64_t *w) const;
+	vtl_always_inline bool test(int pos) const;
+	int rank(int pos) const;
+	int select(int n) const;
+	type_t type;
+	int count;
+private:
+	QVector<uint16_t> array;
+	QVector<uint64_t> words;
+	QVector<uint16_t> groupRanks;
+};
+
+vtl_always_inline bool RankBitmapChunk::test(int pos) const
+{
+	int low, high, mid;
+
+	switch (type) {
+	case CHUNK_EMPTY:
+		return false;
+	case CHUNK_FULL:
+		return true;
+	case CHUNK_BITS:
+		return (words[pos / 64] >> (pos % 64)) & 1;
+	case CHUNK_ARRAY:
+	default:
+		break;
+	}
+
+	low = 0;
+	high = array.size();
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (array[mid] < pos)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low < array.size() && array[low] == pos;
+}
+
+/*
+ * A compressed bitmap with rank and select. The bitmap is first resized and
+ * then the chunks are set one at a time with setChunk(), which may be called
+ * concurrently for different chunks. updateRanks() must be called after the
+ * chunks have been set and before rank(), select() or count() are used.
+ */
+class RankBitmap {
+public:
+	RankBitmap();
+	RankBitmap(const RankBitmap &other);
+	RankBitmap &operator=(const RankBitmap &other);
+	void clear();
+	void swap(RankBitmap &other);
+	void resize(int64_t nr);
+	vtl_always_inline int64_t size() const;
+	vtl_always_inline int nrChunks() const;
+	void setChunk(int c, const uint64_t *words);
+	void getChunk(int c, uint64_t *words) const;
+	void updateRanks();
+	vtl_always_inline int64_t count() const;
+	vtl_always_inline bool test(int64_t idx) const;
+	int64_t rank(int64_t idx) const;
+	int64_t select(int64_t n) const;
+private:
+	QVector<RankBitmapChunk> chunks;
+	/* The number of set bits before each chunk */
+	QVector<int64_t> chunkRanks;
+	RankBitmapChunk *chunkData;
+	int64_t nrBits;
+	int64_t nrSet;
+};
+
+vtl_always_inline int64_t RankBitmap::size() const
+{
+	return nrBits;
+}
+
+vtl_always_inline int RankBitmap::nrChunks() const
+{
+	return chunks.size();
+}
+
+/* The number of set bits */
+vtl_always_inline int64_t RankBitmap::count() const
+{
+	return nrSet;
+}
+
+vtl_always_inline bool RankBitmap::test(int64_t idx) const
+{
+	if (idx < 0 || idx >= nrBits)
+		return false;
+	return chunks[(int) (idx >> RANKBITMAP_CHUNK_SHIFT)].test(
+		(int) (idx & (RANKBITMAP_CHUNK_SIZE - 1)));
+}
+
+}
+
+#endif /* _VTL_RANKBITMAP_H */
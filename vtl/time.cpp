@@ -1,7 +1,7 @@
 // SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
 /*
  * Traceshark - a visualizer for visualizing ftrace and perf traces
- * Copyright (C) 2015, 2016, 2020  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
  *
  * This file is dual licensed: you can use it either under the terms of
  * the GPL, or the BSD license, at your option.
@@ -50,18 +50,22 @@
  *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include "ui/migrationarrow.h"
+#include "vtl/time.h"
 
-MigrationArrow::MigrationArrow(double start, double end, double time,
-			       const QColor &color, QCustomPlot *parent,
-			       int width):
-	QCPItemLine(parent)
+std::atomic<unsigned int> vtl::CompactTime::precision(6);
+
+void vtl::CompactTime::setPrecision(unsigned int p)
+{
+	if (p < 10)
+		precision.store(p, std::memory_order_relaxed);
+}
+
+/*
+ * Like setPrecision() but never lowers the precision. This is used when the
+ * precision is updated while the UI may already be printing timestamps.
+ */
+void vtl::CompactTime::raisePrecision(unsigned int p)
 {
-	QPen pen;
-	QCPItemLine::start->setCoords(time, start);
-	QCPItemLine::end->setCoords(time, end);
-	pen.setColor(color);
-	pen.setWidth(width);
-	setPen(pen);
-	setHead(QCPLineEnding::esFlatArrow);
+	if (p < 10 && p > getPrecision())
+		precision.store(p, std::memory_order_relaxed);
 }
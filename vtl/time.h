@@ -54,6 +54,7 @@
 #define VTL_TIME_H
 
 #include <QString>
+#include <atomic>
 #include <climits>
 #include <cstdint>
 #include <cstdio>
@@ -148,6 +149,7 @@ namespace vtl {
 		vtl_always_inline unsigned int getPrecision() const;
 		vtl_always_inline void setPrecision(unsigned int p);
 	private:
+		friend class CompactTime;
 		vtl_always_inline static Time fromString_(const char *str,
 							  bool &ok,
 							  bool spaced,
@@ -462,6 +464,167 @@ namespace vtl {
 		if (p < 10)
 			precision = p;
 	}
+
+	/*
+	 * CompactTime is a Time without the precision field, so that it only
+	 * needs 8 bytes instead of 16. It is meant for the places where there
+	 * are very many timestamps, such as the events. All the timestamps of
+	 * a trace have the same precision, so it is stored only once, see
+	 * setPrecision(). Converting to a Time gives a Time with this
+	 * precision.
+	 */
+	class CompactTime final {
+	public:
+		typedef Time::timeint_t timeint_t;
+
+		CompactTime(timeint_t ns = 0):
+			time(ns)
+			{}
+		CompactTime(const Time &t):
+			time(t.time)
+			{}
+		vtl_always_inline operator Time() const;
+		vtl_always_inline CompactTime operator+(
+			const CompactTime &other) const;
+		vtl_always_inline void operator+=(const CompactTime &other);
+		vtl_always_inline CompactTime operator-(
+			const CompactTime &other) const;
+		vtl_always_inline void operator-=(const CompactTime &other);
+		vtl_always_inline bool operator<(const CompactTime &other) const;
+		vtl_always_inline bool operator>(const CompactTime &other) const;
+		vtl_always_inline bool operator<=(const CompactTime &other) const;
+		vtl_always_inline bool operator>=(const CompactTime &other) const;
+		vtl_always_inline bool operator==(const CompactTime &other) const;
+		vtl_always_inline CompactTime operator*(int other) const;
+		vtl_always_inline int compare(const CompactTime &other) const;
+		vtl_always_inline int rcompare(const CompactTime &other) const;
+		vtl_always_inline bool isZero() const;
+		vtl_always_inline QString toQString() const;
+		vtl_always_inline bool sprint(char *buf) const;
+		vtl_always_inline double toDouble() const;
+		vtl_always_inline CompactTime fabs() const;
+		vtl_always_inline Time toTime() const;
+		vtl_always_inline static unsigned int getPrecision();
+		static void setPrecision(unsigned int p);
+		static void raisePrecision(unsigned int p);
+	private:
+		timeint_t time;
+		static std::atomic<unsigned int> precision;
+	};
+
+	vtl_always_inline CompactTime::operator Time() const
+	{
+		return Time(time, getPrecision());
+	}
+
+	vtl_always_inline CompactTime CompactTime::operator+(
+		const CompactTime &other) const
+	{
+		return CompactTime(time + other.time);
+	}
+
+	vtl_always_inline void CompactTime::operator+=(const CompactTime &other)
+	{
+		time += other.time;
+	}
+
+	vtl_always_inline CompactTime CompactTime::operator-(
+		const CompactTime &other) const
+	{
+		return CompactTime(time - other.time);
+	}
+
+	vtl_always_inline void CompactTime::operator-=(const CompactTime &other)
+	{
+		time -= other.time;
+	}
+
+	vtl_always_inline bool CompactTime::operator<(
+		const CompactTime &other) const
+	{
+		return time < other.time;
+	}
+
+	vtl_always_inline bool CompactTime::operator>(
+		const CompactTime &other) const
+	{
+		return time > other.time;
+	}
+
+	vtl_always_inline bool CompactTime::operator<=(
+		const CompactTime &other) const
+	{
+		return time <= other.time;
+	}
+
+	vtl_always_inline bool CompactTime::operator>=(
+		const CompactTime &other) const
+	{
+		return time >= other.time;
+	}
+
+	vtl_always_inline bool CompactTime::operator==(
+		const CompactTime &other) const
+	{
+		return time == other.time;
+	}
+
+	vtl_always_inline CompactTime CompactTime::operator*(int other) const
+	{
+		return CompactTime(time * other);
+	}
+
+	vtl_always_inline int CompactTime::compare(
+		const CompactTime &other) const
+	{
+		if (time < other.time)
+			return -1;
+		if (time > other.time)
+			return 1;
+		return 0;
+	}
+
+	vtl_always_inline int CompactTime::rcompare(
+		const CompactTime &other) const
+	{
+		return other.compare(*this);
+	}
+
+	vtl_always_inline bool CompactTime::isZero() const
+	{
+		return time == 0;
+	}
+
+	vtl_always_inline QString CompactTime::toQString() const
+	{
+		return toTime().toQString();
+	}
+
+	vtl_always_inline bool CompactTime::sprint(char *buf) const
+	{
+		return toTime().sprint(buf);
+	}
+
+	vtl_always_inline double CompactTime::toDouble() const
+	{
+		double r = ((double) time) / NSECS_PER_SEC;
+		return r;
+	}
+
+	vtl_always_inline CompactTime CompactTime::fabs() const
+	{
+		return CompactTime(time < 0 ? -time : time);
+	}
+
+	vtl_always_inline Time CompactTime::toTime() const
+	{
+		return Time(time, getPrecision());
+	}
+
+	vtl_always_inline unsigned int CompactTime::getPrecision()
+	{
+		return precision.load(std::memory_order_relaxed);
+	}
 }
 
 #endif /* VTL_TIME_H */
@@ -55,6 +55,7 @@
 #define TLIST_H
 
 #include <climits>
+#include <cstdint>
 #include <cstdlib>
 
 extern "C" {
@@ -70,29 +71,16 @@ namespace vtl {
 #define TLIST_MIN(A, B) ((A) < (B) ? A:B)
 
 /*
- * Here we assume that INT_MAX can be expressed as 2^N - 1
- * This is a bit theoretical, if we have for example 64-bit unsigned ints, then
- * the idea is that we want to keep the array of pointers at a size of no more
- * than one million elements, in order to avoid execessive use of address space
- * and overcommit of memory, or rather address space
+ * Indices are 64-bit, so that a list can hold more than 2^31 elements. The
+ * maximum index is 2^40 - 1, which together with 2^20 elements per map means
+ * that the array of pointers to the maps has 2^20 elements. That array is
+ * only reserved as address space, and pages of it get backed by memory only
+ * as the list grows, so this doesn't cost anything for small lists.
  */
-#define TLIST_INDEX_MAX (TLIST_MIN(0x7fffffff, INT_MAX))
+#define TLIST_INDEX_MAX (INT64_C(0xffffffffff))
 
-/*
- * This code is needed in order to take into account platforms with small
- * unsigned ints, since it's not guaranteed to be more than 2^16 -1, although
- * I have to say that I don't think traceshark would run well on a platform with
- * 16-bit ints.
- */
-#if INT_MAX > 0x100000
-/* This is the normal case */
 #define TLIST_MAP_NR_ELEMENTS (0x100000)
 #define TLIST_MAP_SHIFT (20) /* Number of zero bits above */
-#else
-/* Ouch, we are probably on a 16-bit platform! */
-#define TLIST_MAP_NR_ELEMENTS (0x1000)
-#define TLIST_MAP_SHIFT (12) /* Number of zero bits above */
-#endif
 
 #define TLIST_MAP_ELEMENT_MASK (TLIST_MAP_NR_ELEMENTS - 1)
 #define TLIST_MAP_MASK (TLIST_INDEX_MAX - TLIST_MAP_ELEMENT_MASK)
@@ -107,27 +95,27 @@ public:
 	vtl_always_inline T& increase();
 	vtl_always_inline T& preAlloc();
 	vtl_always_inline void commit();
-	vtl_always_inline T value(int index) const;
-	vtl_always_inline const T& at(int index) const;
+	vtl_always_inline T value(int64_t index) const;
+	vtl_always_inline const T& at(int64_t index) const;
 	vtl_always_inline T& last();
-	vtl_always_inline int size() const;
+	vtl_always_inline int64_t size() const;
 	void clear();
 	void softclear();
-	vtl_always_inline T& operator[](int index);
-	vtl_always_inline const T& operator[](int index) const;
+	vtl_always_inline T& operator[](int64_t index);
+	vtl_always_inline const T& operator[](int64_t index) const;
 	vtl_always_inline void swap(TList<T> &other);
-	vtl_always_inline void swapItemsAt(int a, int b);
+	vtl_always_inline void swapItemsAt(int64_t a, int64_t b);
 private:
-	vtl_always_inline T& subscript(int index) const;
-	vtl_always_inline int mapFromIndex(int index) const;
-	vtl_always_inline int mapIndexFromIndex(int index)
+	vtl_always_inline T& subscript(int64_t index) const;
+	vtl_always_inline int mapFromIndex(int64_t index) const;
+	vtl_always_inline int mapIndexFromIndex(int64_t index)
 		const;
 	void clearAll();
 	void setupMem();
 	void addMem();
 	void decMem();
 	int nrMaps;
-	int nrElements;
+	int64_t nrElements;
 	T **mapArray;
 };
 
@@ -145,13 +133,13 @@ TList<T>::~TList()
 }
 
 template<class T>
-vtl_always_inline int TList<T>::mapFromIndex(int index) const
+vtl_always_inline int TList<T>::mapFromIndex(int64_t index) const
 {
 	return (index >> TLIST_MAP_SHIFT);
 }
 
 template<class T>
-vtl_always_inline int TList<T>::mapIndexFromIndex(int index)
+vtl_always_inline int TList<T>::mapIndexFromIndex(int64_t index)
 const
 {
 	return (index & TLIST_MAP_ELEMENT_MASK);
@@ -249,7 +237,7 @@ vtl_always_inline void TList<T>::append(const T &element)
 }
 
 template<class T>
-vtl_always_inline const T& TList<T>::at(int index) const
+vtl_always_inline const T& TList<T>::at(int64_t index) const
 {
 	int map = mapFromIndex(index);
 	int mapIndex = mapIndexFromIndex(index);
@@ -257,7 +245,7 @@ vtl_always_inline const T& TList<T>::at(int index) const
 }
 
 template<class T>
-vtl_always_inline T TList<T>::value(int index) const
+vtl_always_inline T TList<T>::value(int64_t index) const
 {
 	if (index >= nrElements) {
 		T dvalue;
@@ -269,7 +257,7 @@ vtl_always_inline T TList<T>::value(int index) const
 template<class T>
 vtl_always_inline T& TList<T>::last()
 {
-	int index = nrElements - 1;
+	int64_t index = nrElements - 1;
 	int map = mapFromIndex(index);
 	int mapIndex = mapIndexFromIndex(index);
 	return mapArray[map][mapIndex];
@@ -277,7 +265,7 @@ vtl_always_inline T& TList<T>::last()
 }
 
 template<class T>
-vtl_always_inline int TList<T>::size() const
+vtl_always_inline int64_t TList<T>::size() const
 {
 	return nrElements;
 }
@@ -299,7 +287,7 @@ template<class T>
 vtl_always_inline void TList<T>::swap(TList<T> &other)
 {
 	int tmp_nrMaps = other.nrMaps;
-	int tmp_nrElements = other.nrElements;
+	int64_t tmp_nrElements = other.nrElements;
 	T **tmp_mapArray = other.mapArray;
 
 	other.nrMaps = nrMaps;
@@ -312,7 +300,7 @@ vtl_always_inline void TList<T>::swap(TList<T> &other)
 }
 
 template<class T>
-vtl_always_inline void TList<T>::swapItemsAt(int a, int b)
+vtl_always_inline void TList<T>::swapItemsAt(int64_t a, int64_t b)
 {
 	T foo;
 	T &ta = subscript(a);
@@ -323,7 +311,7 @@ vtl_always_inline void TList<T>::swapItemsAt(int a, int b)
 }
 
 template<class T>
-vtl_always_inline T& TList<T>::subscript(int index) const
+vtl_always_inline T& TList<T>::subscript(int64_t index) const
 {
 	int map = mapFromIndex(index);
 	int mapIndex = mapIndexFromIndex(index);
@@ -331,13 +319,13 @@ vtl_always_inline T& TList<T>::subscript(int index) const
 }
 
 template<class T>
-vtl_always_inline T& TList<T>::operator[](int index)
+vtl_always_inline T& TList<T>::operator[](int64_t index)
 {
 	return subscript(index);
 }
 
 template<class T>
-vtl_always_inline const T& TList<T>::operator[](int index) const
+vtl_always_inline const T& TList<T>::operator[](int64_t index) const
 {
 	return subscript(index);
 }